@@ -7,12 +7,23 @@
 #include <audio/river/debug.hpp>
 #include <audio/river/Interface.hpp>
 #include <audio/river/io/Node.hpp>
+#include <audio/drain/EndPoint.hpp>
 #include <audio/drain/EndPointCallback.hpp>
 #include <audio/drain/EndPointWrite.hpp>
 #include <audio/drain/EndPointRead.hpp>
 #include <audio/drain/Volume.hpp>
-
-audio::river::Interface::Interface(void) {
+#include <audio/Duration.hpp>
+
+audio::river::Interface::Interface(void) :
+  m_mute(false),
+  m_silent(false),
+  m_hasWriteCallback(false),
+  m_needResetHistory(false),
+  m_muteRest(0),
+  m_latency(0),
+  m_coalesceSize(0),
+  m_coalescePosition(0),
+  m_xrunPending(0) {
 	static uint32_t uid = 0;
 	m_uid = uid++;
 	
@@ -37,6 +48,8 @@ bool audio::river::Interface::init(float _freq,
 	} else if (type == "feedback") {
 		m_mode = audio::river::modeInterface_feedback;
 	}
+	// latency tolerated by the user (ms)
+	m_latency = uint32_t(etk::max(0.0, m_config["latency"].toNumber().get(0))*1000.0);
 	// register interface to be notify from the volume change.
 	m_node->registerAsRemote(sharedFromThis());
 	
@@ -167,12 +180,14 @@ void audio::river::Interface::setWriteCallback(audio::drain::playbackFunctionWri
 		return;
 	}
 	algo->setCallback(_function);
+	m_hasWriteCallback = true;
 }
 
 void audio::river::Interface::start(const audio::Time& _time) {
 	ethread::RecursiveLock lock(m_mutex);
 	RIVER_DEBUG("start [BEGIN]");
 	m_process.updateInterAlgo();
+	prepareCoalesce();
 	m_node->interfaceAdd(sharedFromThis());
 	RIVER_DEBUG("start [ END ]");
 }
@@ -235,6 +250,11 @@ etk::String audio::river::Interface::getParameterProperty(const etk::String& _fi
 
 void audio::river::Interface::write(const void* _value, size_t _nbChunk) {
 	ethread::RecursiveLock lock(m_mutex);
+	if (m_needResetHistory == true) {
+		// The flow restart after a drain of the buffer or a xrun: restart the algo with a clean history
+		m_process.removeAlgoDynamic();
+		m_needResetHistory = false;
+	}
 	m_process.updateInterAlgo();
 	ememory::SharedPtr<audio::drain::EndPointWrite> algo = m_process.get<audio::drain::EndPointWrite>(0);
 	if (algo == null) {
@@ -437,16 +457,218 @@ void audio::river::Interface::addVolumeGroup(const etk::String& _name) {
 	}
 }
 
+size_t audio::river::Interface::getCoalesce(size_t _nbChunk) {
+	if (    m_latency == 0
+	     || _nbChunk == 0) {
+		return 1;
+	}
+	uint64_t latency = uint64_t(m_latency)*uint64_t(m_node->getInterfaceFormat().getFrequency())/1000000LL;
+	return etk::max(size_t(latency/_nbChunk), size_t(1));
+}
+
+void audio::river::Interface::prepareCoalesce() {
+	if (    m_latency == 0
+	     || m_node == null) {
+		return;
+	}
+	size_t nbChunk = m_node->getNbChunk();
+	size_t coalesce = getCoalesce(nbChunk);
+	if (coalesce <= 1) {
+		return;
+	}
+	audio::drain::IOFormatInterface format = m_process.getInputConfig();
+	if (m_mode == audio::river::modeInterface_output) {
+		format = m_process.getOutputConfig();
+	}
+	// twice the negotiated size: margin for the backends that give a bigger period than the configured one
+	size_t size = 2*coalesce*nbChunk*audio::getFormatBytes(format.getFormat())*format.getMap().size();
+	if (m_coalesceBuffer.size() < size) {
+		m_coalesceBuffer.resize(size, 0);
+	}
+}
+
 void audio::river::Interface::systemNewInputData(audio::Time _time, const void* _data, size_t _nbChunk) {
 	ethread::RecursiveLock lockProcess(m_mutex);
-	void * tmpData = const_cast<void*>(_data);
-	m_process.push(_time, tmpData, _nbChunk);
+	size_t coalesce = getCoalesce(_nbChunk);
+	if (    coalesce <= 1
+	     && m_coalesceSize == 0) {
+		void * tmpData = const_cast<void*>(_data);
+		m_process.push(_time, tmpData, _nbChunk);
+		return;
+	}
+	// accumulate the periods of the node, the drain chain and the user callback are called one time
+	size_t chunkSize = audio::getFormatBytes(m_process.getInputConfig().getFormat())*m_process.getInputConfig().getMap().size();
+	if (    m_coalesceSize != 0
+	     && (m_coalesceSize+_nbChunk)*chunkSize > m_coalesceBuffer.size()) {
+		// the period is bigger than the negotiated one: flush (the buffer is never resized in the audio thread)
+		m_process.push(m_coalesceTime, &m_coalesceBuffer[0], m_coalesceSize);
+		m_coalesceSize = 0;
+	}
+	if (_nbChunk*chunkSize > m_coalesceBuffer.size()) {
+		void * tmpData = const_cast<void*>(_data);
+		m_process.push(_time, tmpData, _nbChunk);
+		return;
+	}
+	if (m_coalesceSize == 0) {
+		m_coalesceTime = _time;
+	}
+	memcpy(&m_coalesceBuffer[m_coalesceSize*chunkSize], _data, _nbChunk*chunkSize);
+	m_coalesceSize += _nbChunk;
+	if (    m_coalesceSize >= coalesce*_nbChunk
+	     || (m_coalesceSize+_nbChunk)*chunkSize > m_coalesceBuffer.size()) {
+		m_process.push(m_coalesceTime, &m_coalesceBuffer[0], m_coalesceSize);
+		m_coalesceSize = 0;
+	}
 }
 
-void audio::river::Interface::systemNeedOutputData(audio::Time _time, void* _data, size_t _nbChunk, size_t _chunkSize) {
+/**
+ * @brief Check if a buffer contain only zero (the check is done by 64 bytes block to permit the compiler to vectorize it).
+ * @param[in] _data Pointer on the data.
+ * @param[in] _size Size of the buffer in byte.
+ * @return true All the data are at zero.
+ */
+static bool isFullZero(const void* _data, size_t _size) {
+	const uint8_t* data = static_cast<const uint8_t*>(_data);
+	size_t iii = 0;
+	for (; iii+64<=_size; iii+=64) {
+		uint64_t tmp[8];
+		memcpy(tmp, &data[iii], 64);
+		if ((tmp[0]|tmp[1]|tmp[2]|tmp[3]|tmp[4]|tmp[5]|tmp[6]|tmp[7]) != 0) {
+			return false;
+		}
+	}
+	for (; iii<_size; ++iii) {
+		if (data[iii] != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool audio::river::Interface::checkBypass() {
+	bool bypass = m_mute;
+	if (    bypass == false
+	     && m_hasWriteCallback == false) {
+		// Write mode: nothing to play when the user buffer is drained
+		ememory::SharedPtr<audio::drain::EndPointWrite> algo = m_process.get<audio::drain::EndPointWrite>(0);
+		if (    algo != null
+		     && algo->getBufferFillSize() == 0) {
+			bypass = true;
+		}
+	}
+	if (    bypass == true
+	     && m_mute == false
+	     && m_coalescePosition < m_coalesceSize) {
+		// the data already generated are played
+		bypass = false;
+	}
+	if (bypass == true) {
+		m_coalesceSize = 0;
+		m_coalescePosition = 0;
+		if (m_silent == false) {
+			RIVER_VERBOSE("Interface '" << m_name << "' is silent ==> bypass the drain chain");
+		}
+		m_silent = true;
+		m_needResetHistory = true;
+	}
+	return bypass;
+}
+
+void audio::river::Interface::discardOutputData(audio::Time _time, size_t _nbChunk) {
+	ememory::SharedPtr<audio::drain::EndPoint> algo = m_process.get<audio::drain::EndPoint>(0);
+	if (algo == null) {
+		return;
+	}
+	uint64_t frequencyUser = m_process.getInputConfig().getFrequency();
+	uint64_t frequencyNode = m_process.getOutputConfig().getFrequency();
+	if (    frequencyUser == 0
+	     || frequencyNode == 0) {
+		return;
+	}
+	// number of user chunk in the node period (the rest is kept for the next period)
+	m_muteRest += uint64_t(_nbChunk)*frequencyUser;
+	size_t nbChunk = m_muteRest/frequencyNode;
+	m_muteRest -= uint64_t(nbChunk)*frequencyNode;
+	if (nbChunk == 0) {
+		return;
+	}
+	// Only the end point is called: callback or read of the write buffer, no conversion
+	void* output = null;
+	size_t nbChunkOut = 0;
+	algo->process(_time, null, nbChunk, output, nbChunkOut);
+}
+
+bool audio::river::Interface::systemNeedOutputData(audio::Time _time, void* _data, size_t _nbChunk, size_t _chunkSize) {
 	ethread::RecursiveLock lockProcess(m_mutex);
+	if (checkBypass() == true) {
+		if (m_mute == true) {
+			discardOutputData(_time, _nbChunk);
+		}
+		return false;
+	}
 	//RIVER_INFO("time :                           " << _time);
-	m_process.pull(_time, _data, _nbChunk, _chunkSize);
+	size_t coalesce = getCoalesce(_nbChunk);
+	if (    coalesce <= 1
+	     && m_coalescePosition >= m_coalesceSize) {
+		memset(_data, 0, _nbChunk*_chunkSize);
+		m_process.pull(_time, _data, _nbChunk, _chunkSize);
+	} else {
+		// generate several periods of the node in one call of the drain chain (and of the user callback)
+		uint8_t* data = static_cast<uint8_t*>(_data);
+		size_t nbChunk = 0;
+		while (nbChunk < _nbChunk) {
+			if (m_coalescePosition >= m_coalesceSize) {
+				audio::Time time = _time + audio::Duration(0, int64_t(nbChunk)*1000000000LL/int64_t(m_node->getInterfaceFormat().getFrequency()));
+				size_t nbGenerate = etk::max(coalesce, size_t(1))*_nbChunk;
+				if (nbGenerate*_chunkSize > m_coalesceBuffer.size()) {
+					// the period is bigger than the negotiated one: the rest is generated directly (no allocation in the audio thread)
+					m_coalesceSize = 0;
+					m_coalescePosition = 0;
+					memset(&data[nbChunk*_chunkSize], 0, (_nbChunk-nbChunk)*_chunkSize);
+					m_process.pull(time, &data[nbChunk*_chunkSize], _nbChunk-nbChunk, _chunkSize);
+					break;
+				}
+				m_coalesceSize = nbGenerate;
+				m_coalescePosition = 0;
+				// same as the direct path: an underflow of the user give silence, not the previous data
+				memset(&m_coalesceBuffer[0], 0, m_coalesceSize*_chunkSize);
+				m_process.pull(time, &m_coalesceBuffer[0], m_coalesceSize, _chunkSize);
+			}
+			size_t nbCopy = etk::min(_nbChunk-nbChunk, m_coalesceSize-m_coalescePosition);
+			memcpy(&data[nbChunk*_chunkSize], &m_coalesceBuffer[m_coalescePosition*_chunkSize], nbCopy*_chunkSize);
+			m_coalescePosition += nbCopy;
+			nbChunk += nbCopy;
+		}
+	}
+	m_silent = isFullZero(_data, _nbChunk*_chunkSize);
+	return m_silent == false;
+}
+
+void audio::river::Interface::setMute(bool _mute) {
+	ethread::RecursiveLock lock(m_mutex);
+	if (m_mode != audio::river::modeInterface_output) {
+		RIVER_ERROR("Can not mute an other IO than an output");
+		return;
+	}
+	if (    m_mute == true
+	     && _mute == false
+	     && m_needResetHistory == true) {
+		// The drain chain has been bypassed: restart the algo with a clean history
+		m_process.removeAlgoDynamic();
+		m_process.updateInterAlgo();
+		m_needResetHistory = false;
+	}
+	m_mute = _mute;
+}
+
+bool audio::river::Interface::getMute() const {
+	ethread::RecursiveLock lock(m_mutex);
+	return m_mute;
+}
+
+bool audio::river::Interface::isSilent() const {
+	ethread::RecursiveLock lock(m_mutex);
+	return m_silent;
 }
 
 void audio::river::Interface::systemVolumeChange() {
@@ -458,6 +680,62 @@ void audio::river::Interface::systemVolumeChange() {
 	algo->volumeChange();
 }
 
+void audio::river::Interface::systemXrun(bool _underflow) {
+	ethread::RecursiveLock lockProcess(m_mutex);
+	// the flow is not continuous: the algo history is cleaned at the next call out of the audio thread (no allocation here)
+	m_needResetHistory = true;
+	m_coalesceSize = 0;
+	m_coalescePosition = 0;
+	// the status is delivered by the period thread of the manager (the callback of the user is not called in the audio thread)
+	m_xrunPending.fetch_or(_underflow == true ? 1 : 2);
+}
+
+void audio::river::Interface::setStatusFunction(audio::drain::statusFunction _newFunction) {
+	m_process.setStatusFunction(_newFunction);
+	// the status raised in the audio thread are delivered by the period thread
+	audio::river::io::Manager::getInstance()->startPeriodThread();
+}
+
+void audio::river::Interface::systemDeliverStatus() {
+	uint32_t xrun = m_xrunPending.exchange(0);
+	if ((xrun & 1) != 0) {
+		generateStatus("xrun", "underflow");
+	}
+	if ((xrun & 2) != 0) {
+		generateStatus("xrun", "overflow");
+	}
+}
+
+bool audio::river::Interface::systemChangeNode(const ememory::SharedPtr<audio::river::io::Node>& _node) {
+	ethread::RecursiveLock lockProcess(m_mutex);
+	if (_node == null) {
+		return false;
+	}
+	if (    _node->isInput() == true
+	     && m_mode == audio::river::modeInterface_input) {
+		m_process.setInputConfig(_node->getInterfaceFormat());
+	} else if (    _node->isOutput() == true
+	            && m_mode == audio::river::modeInterface_output) {
+		m_process.setOutputConfig(_node->getInterfaceFormat());
+	} else if (    _node->isOutput() == true
+	            && m_mode == audio::river::modeInterface_feedback) {
+		m_process.setInputConfig(_node->getHarwareFormat());
+	} else {
+		RIVER_ERROR("Can not link virtual interface with type : " << m_mode << " to a hardware interface " << (_node->isInput()==true?"input":"output"));
+		return false;
+	}
+	m_node = _node;
+	m_node->registerAsRemote(sharedFromThis());
+	// the period of the node can change
+	m_coalesceSize = 0;
+	m_coalescePosition = 0;
+	// the node format can change ==> regenerate the conversion algo
+	m_process.removeAlgoDynamic();
+	m_process.updateInterAlgo();
+	prepareCoalesce();
+	return true;
+}
+
 static void link(ememory::SharedPtr<etk::io::Interface>& _io, const etk::String& _first, const etk::String& _op, const etk::String& _second, bool _isLink=true) {
 	if (_op == "->") {
 		if (_isLink) {
@@ -19,6 +19,7 @@
 #include <audio/drain/EndPointWrite.hpp>
 #include <ejson/ejson.hpp>
 #include <audio/Time.hpp>
+#include <atomic>
 
 namespace audio {
 	namespace river {
@@ -169,6 +170,68 @@ namespace audio {
 				 *                      - NOISE for small noise volume control.
 				 */
 				virtual void addVolumeGroup(const etk::String& _name);
+			protected:
+				bool m_mute; //!< The user request to not generate sound on this output.
+				bool m_silent; //!< The last period did not generate any sound (mute, empty write buffer or full-zero callback).
+				bool m_hasWriteCallback; //!< A write callback is set: an empty write buffer does not mean silence.
+				bool m_needResetHistory; //!< The drain chain has been bypassed or the node had a xrun: the algo history must be cleaned out of the audio thread.
+				uint64_t m_muteRest; //!< Mute: rest of the conversion of the node period in user chunk (unit: chunk*node frequency).
+				/**
+				 * @brief Check if the output interface can be bypassed for the current period.
+				 * @return true The interface is silent (muted or write buffer drained), no need to convert and mix data.
+				 */
+				bool checkBypass();
+				/**
+				 * @brief Request and drop the data of the user for one period of the node (keep the user timeline while muted).
+				 * @param[in] _time Time where the data might be played.
+				 * @param[in] _nbChunk Number of chunk of the node period.
+				 */
+				void discardOutputData(audio::Time _time, size_t _nbChunk);
+			protected:
+				uint32_t m_latency; //!< Latency requested by the user in the option "latency" (us, 0: no request).
+				etk::Vector<uint8_t> m_coalesceBuffer; //!< Periods of the node processed in one call of the drain chain (latency upper than the period of the node), never resized in the audio thread.
+				size_t m_coalesceSize; //!< Number of chunk in the coalesce buffer.
+				size_t m_coalescePosition; //!< Output: position of the next chunk to give to the node.
+				audio::Time m_coalesceTime; //!< Input: time of the first chunk of the coalesce buffer.
+				/**
+				 * @brief Get the number of node period processed in one call of the drain chain.
+				 * @param[in] _nbChunk Number of chunk of the node period.
+				 * @return Number of period (1: no coalescing).
+				 */
+				size_t getCoalesce(size_t _nbChunk);
+				/**
+				 * @brief Allocate the coalesce buffer for the period of the node (out of the audio thread: at the start and when the node change).
+				 */
+				void prepareCoalesce();
+			protected:
+				std::atomic<uint32_t> m_xrunPending; //!< Xrun not yet delivered to the status callback (bit 0: underflow, bit 1: overflow).
+			public:
+				/**
+				 * @brief Get the latency requested at the creation of the interface (option "latency" in ms).
+				 * The node use the smallest latency of its running interfaces to select its period, the interfaces with a bigger
+				 * latency process several periods of the node in one call.
+				 * @return Latency requested in us (0: no request).
+				 */
+				uint32_t getLatency() const {
+					return m_latency;
+				}
+			public:
+				/**
+				 * @brief Mute the output interface: the node does not convert and does not mix this interface any more.
+				 * @note The flow stay started: the callback is still called (or the write buffer consumed) at the rate of the node and the data are dropped.
+				 * @param[in] _mute Mute enable or disable.
+				 */
+				virtual void setMute(bool _mute);
+				/**
+				 * @brief Get the mute status of the interface.
+				 * @return true The interface is muted.
+				 */
+				virtual bool getMute() const;
+				/**
+				 * @brief Get the silent status of the last period processed by the node.
+				 * @return true The interface did not generate any sound in the last period.
+				 */
+				virtual bool isSilent() const;
 			public:
 				/**
 				 * @brief Start the Audio interface flow.
@@ -288,12 +351,33 @@ namespace audio {
 				 * @param[in] _data Pointer on the data.
 				 * @param[in] _nbChunk Number of chunk that might be write
 				 * @param[in] _chunkSize Chunk size.
+				 * @return true Some sound has been generated.
+				 * @return false Nothing to mix: the interface is muted (the data are requested and dropped), drained or all the samples generated are zero.
 				 */
-				virtual void systemNeedOutputData(audio::Time _time, void* _data, size_t _nbChunk, size_t _chunkSize);
+				virtual bool systemNeedOutputData(audio::Time _time, void* _data, size_t _nbChunk, size_t _chunkSize);
 				/**
 				 * @brief Node Call interface: A volume has change.
 				 */
 				virtual void systemVolumeChange();
+				/**
+				 * @brief Node Call interface: The backend of the node has reported a xrun (the flow has a discontinuity).
+				 * Called in the audio thread: the history of the algo is only marked to be reset, the drain chain is rebuilt at the next write()
+				 * or unmute, and the status is only marked to be delivered by @ref systemDeliverStatus (all out of the audio thread).
+				 * @param[in] _underflow true: underflow, false: overflow.
+				 */
+				virtual void systemXrun(bool _underflow);
+				/**
+				 * @brief Node Call interface: Deliver the status raised in the audio thread (called by the period thread of the manager).
+				 * The status "xrun" is generated (origin "xrun", status "underflow" or "overflow").
+				 */
+				virtual void systemDeliverStatus();
+				/**
+				 * @brief Node Call interface: The node is replaced by a new one (configuration reload).
+				 * @param[in] _node New node to connect the flow.
+				 * @return true The interface is connected on the new node.
+				 * @return false The new node is not compatible with this interface.
+				 */
+				virtual bool systemChangeNode(const ememory::SharedPtr<audio::river::io::Node>& _node);
 			public:
 				/**
 				 * @brief Create the dot in the FileNode stream.
@@ -319,11 +403,10 @@ namespace audio {
 			public:
 				/**
 				 * @brief Set status callback
+				 * @note The status of the audio thread (xrun) are delivered by the period thread of the manager (up to 100 ms later).
 				 * @param[in] _newFunction Function to call
 				 */
-				void setStatusFunction(audio::drain::statusFunction _newFunction) {
-					m_process.setStatusFunction(_newFunction);
-				}
+				void setStatusFunction(audio::drain::statusFunction _newFunction);
 		};
 	}
 }
@@ -103,6 +103,7 @@ namespace audio {
 				 * @param[in] _format Sample Format to open the stream [int8_t, int16_t, ...]
 				 * @param[in] _streamName Stream name to open: "" or "default" open current selected output
 				 * @param[in] _options Json option to configure default resampling and many other things.
+				 * @note Option "latency": latency tolerated by the stream in ms ("{latency:10}"): the node select its period with the smallest latency of its streams (see "nb-chunk-latency").
 				 * @return a pointer on the interface
 				 */
 				virtual ememory::SharedPtr<Interface> createOutput(float _freq = 48000,
@@ -117,6 +118,7 @@ namespace audio {
 				 * @param[in] _format Sample Format to open the stream [int8_t, int16_t, ...]
 				 * @param[in] _streamName Stream name to open: "" or "default" open current selected input
 				 * @param[in] _options Json option to configure default resampling and many other things.
+				 * @note Option "latency": latency tolerated by the stream in ms ("{latency:10}"): the node select its period with the smallest latency of its streams (see "nb-chunk-latency").
 				 * @return a pointer on the interface
 				 */
 				virtual ememory::SharedPtr<Interface> createInput(float _freq = 48000,
@@ -0,0 +1,201 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/DelayEstimator.hpp>
+#include <audio/river/debug.hpp>
+#include <ethread/tools.hpp>
+#include <cmath>
+
+// Frequency of the decimated signals
+static const uint32_t estimationFrequency = 8000;
+// Minimum mean energy of the decimated feedback to estimate (-60 dBFS)
+static const float minimumEnergy = 1.0e-6f;
+// Ratio between the peak and the mean of the correlation to accept an estimation
+static const float minimumConfidence = 8.0f;
+
+audio::river::io::DelayEstimator::DelayEstimator() :
+  m_decimation(1),
+  m_windowSize(0),
+  m_maxLag(0),
+  m_period(0),
+  m_writePosition(0),
+  m_nbSample(0),
+  m_nbNewSample(0),
+  m_accumulatorMicrophone(0.0f),
+  m_accumulatorFeedback(0.0f),
+  m_accumulatorCount(0),
+  m_generation(0),
+  m_hasResult(false),
+  m_result(0),
+  m_alive(false) {
+
+}
+
+audio::river::io::DelayEstimator::~DelayEstimator() {
+	unInit();
+}
+
+bool audio::river::io::DelayEstimator::init(uint32_t _frequency, uint32_t _maxDelayMs, uint32_t _periodMs) {
+	unInit();
+	m_decimation = etk::max(uint32_t(1), _frequency/estimationFrequency);
+	uint32_t frequency = _frequency/m_decimation;
+	m_maxLag = etk::max(int32_t(1), int32_t(uint64_t(frequency)*_maxDelayMs/1000));
+	// the window must contain the signal and his delayed version
+	m_windowSize = 1024;
+	while (m_windowSize < uint32_t(m_maxLag)*2) {
+		m_windowSize *= 2;
+	}
+	m_period = etk::max(uint32_t(1), uint32_t(uint64_t(frequency)*_periodMs/1000));
+	if (m_fft.init(m_windowSize*2) == false) {
+		return false;
+	}
+	m_microphone.resize(m_windowSize, 0);
+	m_feedback.resize(m_windowSize, 0);
+	m_workMicrophone.resize(m_windowSize*2, 0);
+	m_workFeedback.resize(m_windowSize*2, 0);
+	m_microphoneReal.resize(m_windowSize+1, 0);
+	m_microphoneImag.resize(m_windowSize+1, 0);
+	m_feedbackReal.resize(m_windowSize+1, 0);
+	m_feedbackImag.resize(m_windowSize+1, 0);
+	m_correlation.resize(m_windowSize*2, 0);
+	reset();
+	RIVER_INFO("Delay estimator: decimation=" << m_decimation << " window=" << m_windowSize << " max-lag=" << m_maxLag << " period=" << m_period);
+	m_alive = true;
+	m_thread = ememory::makeShared<ethread::Thread>([=](){this->threadCallback();}, "RIVER AEC delay");
+	return true;
+}
+
+void audio::river::io::DelayEstimator::unInit() {
+	m_alive = false;
+	if (m_thread != null) {
+		m_thread->join();
+		m_thread.reset();
+	}
+}
+
+void audio::river::io::DelayEstimator::push(const int16_t* _microphone, size_t _nbChannel, const int16_t* _feedback, size_t _nbChunk) {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_windowSize == 0) {
+		return;
+	}
+	for (size_t iii=0; iii<_nbChunk; ++iii) {
+		m_accumulatorMicrophone += float(_microphone[iii*_nbChannel]);
+		m_accumulatorFeedback += float(_feedback[iii]);
+		m_accumulatorCount++;
+		if (m_accumulatorCount < m_decimation) {
+			continue;
+		}
+		const float scale = 1.0f/(32768.0f*float(m_decimation));
+		m_microphone[m_writePosition] = m_accumulatorMicrophone*scale;
+		m_feedback[m_writePosition] = m_accumulatorFeedback*scale;
+		m_writePosition = (m_writePosition+1) % m_windowSize;
+		m_nbSample = etk::min(m_nbSample+1, m_windowSize);
+		m_nbNewSample++;
+		m_accumulatorMicrophone = 0.0f;
+		m_accumulatorFeedback = 0.0f;
+		m_accumulatorCount = 0;
+	}
+}
+
+bool audio::river::io::DelayEstimator::getDelay(int32_t& _delay) {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_hasResult == false) {
+		return false;
+	}
+	m_hasResult = false;
+	_delay = m_result;
+	return true;
+}
+
+void audio::river::io::DelayEstimator::reset() {
+	ethread::UniqueLock lock(m_mutex);
+	m_generation++;
+	m_writePosition = 0;
+	m_nbSample = 0;
+	m_nbNewSample = 0;
+	m_accumulatorMicrophone = 0.0f;
+	m_accumulatorFeedback = 0.0f;
+	m_accumulatorCount = 0;
+	m_hasResult = false;
+}
+
+void audio::river::io::DelayEstimator::threadCallback() {
+	while (m_alive == true) {
+		ethread::sleepMilliSeconds(50);
+		uint32_t generation = 0;
+		{
+			ethread::UniqueLock lock(m_mutex);
+			if (    m_nbSample < m_windowSize
+			     || m_nbNewSample < m_period) {
+				continue;
+			}
+			m_nbNewSample = 0;
+			generation = m_generation;
+			// linearize the rings (oldest sample first) and pad with 0
+			for (uint32_t iii=0; iii<m_windowSize; ++iii) {
+				uint32_t id = (m_writePosition+iii) % m_windowSize;
+				m_workMicrophone[iii] = m_microphone[id];
+				m_workFeedback[iii] = m_feedback[id];
+				m_workMicrophone[m_windowSize+iii] = 0.0f;
+				m_workFeedback[m_windowSize+iii] = 0.0f;
+			}
+		}
+		int32_t lag = 0;
+		if (estimate(lag) == false) {
+			continue;
+		}
+		ethread::UniqueLock lock(m_mutex);
+		if (generation != m_generation) {
+			// the alignment has changed during the estimation
+			continue;
+		}
+		m_result = lag*int32_t(m_decimation);
+		m_hasResult = true;
+	}
+}
+
+bool audio::river::io::DelayEstimator::estimate(int32_t& _lag) {
+	float energy = 0.0f;
+	for (uint32_t iii=0; iii<m_windowSize; ++iii) {
+		energy += m_workFeedback[iii]*m_workFeedback[iii];
+	}
+	if (energy < minimumEnergy*float(m_windowSize)) {
+		// nothing played ==> no echo to find
+		return false;
+	}
+	m_fft.forward(&m_workMicrophone[0], &m_microphoneReal[0], &m_microphoneImag[0]);
+	m_fft.forward(&m_workFeedback[0], &m_feedbackReal[0], &m_feedbackImag[0]);
+	// cross spectrum M * conj(F) with the phase transform (PHAT) weighting
+	for (uint32_t iii=0; iii<=m_windowSize; ++iii) {
+		float real = m_microphoneReal[iii]*m_feedbackReal[iii] + m_microphoneImag[iii]*m_feedbackImag[iii];
+		float imag = m_microphoneImag[iii]*m_feedbackReal[iii] - m_microphoneReal[iii]*m_feedbackImag[iii];
+		float norm = sqrtf(real*real + imag*imag) + 1.0e-12f;
+		m_microphoneReal[iii] = real/norm;
+		m_microphoneImag[iii] = imag/norm;
+	}
+	m_fft.inverse(&m_microphoneReal[0], &m_microphoneImag[0], &m_correlation[0]);
+	// search the maximum in [-maxLag..maxLag] (the negative lag are at the end of the correlation)
+	const int32_t size = m_windowSize*2;
+	float peak = 0.0f;
+	float sum = 0.0f;
+	int32_t peakLag = 0;
+	for (int32_t lag=-m_maxLag; lag<=m_maxLag; ++lag) {
+		float value = fabsf(m_correlation[(lag+size)%size]);
+		sum += value;
+		if (value > peak) {
+			peak = value;
+			peakLag = lag;
+		}
+	}
+	float mean = sum/float(2*m_maxLag+1);
+	if (peak < mean*minimumConfidence) {
+		RIVER_VERBOSE("Delay estimation not significant: peak=" << peak << " mean=" << mean);
+		return false;
+	}
+	RIVER_DEBUG("Delay estimation: lag=" << peakLag << " confidence=" << peak/mean);
+	_lag = peakLag;
+	return true;
+}
@@ -0,0 +1,114 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <ethread/Mutex.hpp>
+#include <ethread/Thread.hpp>
+#include <ememory/memory.hpp>
+#include <atomic>
+#include <audio/river/io/Fft.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Estimation of the delay between the feedback and the microphone (GCC-PHAT cross-correlation on decimated signals).
+			 * The audio thread only decimate the signals in a ring buffer (push()), the correlation is computed in a low priority thread.
+			 */
+			class DelayEstimator {
+				private:
+					mutable ethread::Mutex m_mutex; //!< Protect the data shared with the estimation thread
+					uint32_t m_decimation; //!< Decimation factor of the signals
+					uint32_t m_windowSize; //!< Number of decimated sample used by an estimation (power of 2)
+					int32_t m_maxLag; //!< Maximum lag searched (decimated sample)
+					uint32_t m_period; //!< Number of new decimated sample between 2 estimations
+					etk::Vector<float> m_microphone; //!< Ring of the decimated microphone
+					etk::Vector<float> m_feedback; //!< Ring of the decimated feedback
+					uint32_t m_writePosition; //!< Write position in the rings
+					uint32_t m_nbSample; //!< Number of valid sample in the rings
+					uint32_t m_nbNewSample; //!< Number of sample since the last estimation
+					float m_accumulatorMicrophone; //!< Decimation accumulator
+					float m_accumulatorFeedback; //!< Decimation accumulator
+					uint32_t m_accumulatorCount; //!< Number of sample in the accumulators
+					uint32_t m_generation; //!< Incremented at each reset (drop the estimation in progress)
+					bool m_hasResult; //!< A new estimation is availlable
+					int32_t m_result; //!< Last estimation (sample at the full rate)
+					ememory::SharedPtr<ethread::Thread> m_thread; //!< Estimation thread
+					std::atomic<bool> m_alive; //!< Thread is active
+				private:
+					// Data of the estimation thread:
+					audio::river::io::Fft m_fft; //!< Transform of 2 windows
+					etk::Vector<float> m_workMicrophone; //!< Linearized microphone (zero padded)
+					etk::Vector<float> m_workFeedback; //!< Linearized feedback (zero padded)
+					etk::Vector<float> m_microphoneReal; //!< Spectrum of the microphone
+					etk::Vector<float> m_microphoneImag; //!< Spectrum of the microphone
+					etk::Vector<float> m_feedbackReal; //!< Spectrum of the feedback
+					etk::Vector<float> m_feedbackImag; //!< Spectrum of the feedback
+					etk::Vector<float> m_correlation; //!< Generalized cross-correlation
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					DelayEstimator();
+					/**
+					 * @brief Destructor (stop the estimation thread)
+					 */
+					~DelayEstimator();
+					/**
+					 * @brief Initialize the estimator and start the estimation thread.
+					 * @param[in] _frequency Frequency of the signals.
+					 * @param[in] _maxDelayMs Maximum delay searched (in ms).
+					 * @param[in] _periodMs Time between 2 estimations (in ms).
+					 * @return true The estimator is started.
+					 */
+					bool init(uint32_t _frequency, uint32_t _maxDelayMs, uint32_t _periodMs);
+					/**
+					 * @brief Stop the estimation thread.
+					 */
+					void unInit();
+					/**
+					 * @brief Add the synchronized samples (called in the audio thread: only a decimation).
+					 * @param[in] _microphone Microphone samples (interleaved, the first channel is used).
+					 * @param[in] _nbChannel Number of channel of the microphone.
+					 * @param[in] _feedback Feedback samples (mono).
+					 * @param[in] _nbChunk Number of sample.
+					 */
+					void push(const int16_t* _microphone, size_t _nbChannel, const int16_t* _feedback, size_t _nbChunk);
+					/**
+					 * @brief Get the last estimation.
+					 * @param[out] _delay Delay of the microphone after the feedback (sample at the full rate, can be negative).
+					 * @return true A new estimation is availlable.
+					 */
+					bool getDelay(int32_t& _delay);
+					/**
+					 * @brief Get the decimation factor (resolution of the estimation in sample at the full rate).
+					 * @return Decimation factor of the signals.
+					 */
+					uint32_t getDecimation() const {
+						return m_decimation;
+					}
+					/**
+					 * @brief Drop the history (the alignment of the 2 signals has changed).
+					 */
+					void reset();
+				private:
+					/**
+					 * @brief Estimation thread.
+					 */
+					void threadCallback();
+					/**
+					 * @brief Compute the GCC-PHAT on the working buffers.
+					 * @param[out] _lag Lag of the maximum of the correlation (decimated sample).
+					 * @return true The maximum is significant.
+					 */
+					bool estimate(int32_t& _lag);
+			};
+		}
+	}
+}
+
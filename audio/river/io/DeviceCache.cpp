@@ -0,0 +1,91 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/DeviceCache.hpp>
+#include <audio/river/debug.hpp>
+
+audio::river::io::DeviceCache::DeviceCache(const etk::Uri& _uri) :
+  m_uri(_uri),
+  m_loaded(false) {
+
+}
+
+void audio::river::io::DeviceCache::load() {
+	if (m_loaded == true) {
+		return;
+	}
+	m_loaded = true;
+	if (m_cache.load(m_uri) == false) {
+		RIVER_INFO("No device cache availlable: " << m_uri);
+		m_cache.clear();
+		return;
+	}
+	RIVER_INFO("Load device cache: " << m_uri);
+}
+
+bool audio::river::io::DeviceCache::get(const etk::String& _key,
+                                        const etk::String& _fingerprint,
+                                        audio::river::io::DeviceCapability& _capability) {
+	ethread::UniqueLock lock(m_mutex);
+	load();
+	const ejson::Object tmpObject = m_cache[_key].toObject();
+	if (tmpObject.exist() == false) {
+		return false;
+	}
+	if (tmpObject["fingerprint"].toString().get() != _fingerprint) {
+		RIVER_INFO("Device cache '" << _key << "' out of date ==> need probe");
+		return false;
+	}
+	_capability = audio::river::io::DeviceCapability();
+	_capability.deviceId = tmpObject["id"].toNumber().get(-1);
+	_capability.name = tmpObject["name"].toString().get();
+	for (auto it : tmpObject["channel-map"].toArray()) {
+		_capability.channels.pushBack(audio::getChannelFromString(it.toString().get()));
+	}
+	for (auto it : tmpObject["frequency"].toArray()) {
+		_capability.sampleRates.pushBack(it.toNumber().get(0));
+	}
+	for (auto it : tmpObject["type"].toArray()) {
+		_capability.nativeFormats.pushBack(audio::getFormatFromString(it.toString().get()));
+	}
+	if (    _capability.sampleRates.size() == 0
+	     || _capability.nativeFormats.size() == 0) {
+		return false;
+	}
+	RIVER_INFO("Device cache '" << _key << "' ==> no probe");
+	return true;
+}
+
+void audio::river::io::DeviceCache::set(const etk::String& _key,
+                                        const etk::String& _fingerprint,
+                                        const audio::river::io::DeviceCapability& _capability) {
+	ethread::UniqueLock lock(m_mutex);
+	load();
+	ejson::Object tmpObject;
+	tmpObject.add("fingerprint", ejson::String(_fingerprint));
+	tmpObject.add("id", ejson::Number(_capability.deviceId));
+	tmpObject.add("name", ejson::String(_capability.name));
+	ejson::Array listChannel;
+	for (auto &it : _capability.channels) {
+		listChannel.add(ejson::String(etk::toString(it)));
+	}
+	tmpObject.add("channel-map", listChannel);
+	ejson::Array listFrequency;
+	for (auto &it : _capability.sampleRates) {
+		listFrequency.add(ejson::Number(it));
+	}
+	tmpObject.add("frequency", listFrequency);
+	ejson::Array listFormat;
+	for (auto &it : _capability.nativeFormats) {
+		listFormat.add(ejson::String(etk::toString(it)));
+	}
+	tmpObject.add("type", listFormat);
+	m_cache.remove(_key);
+	m_cache.add(_key, tmpObject);
+	if (m_cache.store(m_uri) == false) {
+		RIVER_WARNING("Can not store the device cache: " << m_uri);
+	}
+}
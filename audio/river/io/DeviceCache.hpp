@@ -0,0 +1,80 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <etk/uri/uri.hpp>
+#include <ethread/Mutex.hpp>
+#include <audio/format.hpp>
+#include <audio/channel.hpp>
+#include <ejson/ejson.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Capability of an hardware device (result of the probe of the backend).
+			 */
+			class DeviceCapability {
+				public:
+					int32_t deviceId; //!< Id of the device in the backend (-1 if search by name)
+					etk::String name; //!< Name of the device
+					etk::Vector<audio::channel> channels; //!< Channels availlable on the device
+					etk::Vector<uint32_t> sampleRates; //!< Sample rates supported by the device
+					etk::Vector<enum audio::format> nativeFormats; //!< Sample format supported by the device
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					DeviceCapability() :
+					  deviceId(-1) {
+
+					}
+			};
+			/**
+			 * @brief Disk cache of the device capability. It permit to not probe all the devices of the backend at every start.
+			 * Each element is stored with a fingerprint of the backend (an element with a different fingerprint is probed again).
+			 * @note The cache is stored in the user folder: ~/.local/share/audio-river/device-cache.json
+			 */
+			class DeviceCache {
+				private:
+					mutable ethread::Mutex m_mutex; //!< prevent multiple access
+					etk::Uri m_uri; //!< File where the cache is stored
+					ejson::Document m_cache; //!< Cache data
+					bool m_loaded; //!< The file has been read
+				public:
+					/**
+					 * @brief Contructor
+					 * @param[in] _uri File to store the data
+					 */
+					DeviceCache(const etk::Uri& _uri);
+					/**
+					 * @brief Get a device capability from the cache
+					 * @param[in] _key Unique key of the device (backend:name:mode)
+					 * @param[in] _fingerprint Fingerprint of the current backend status
+					 * @param[out] _capability Capability of the device
+					 * @return true The capability is availlable and valid
+					 * @return false The device need to be probed
+					 */
+					bool get(const etk::String& _key, const etk::String& _fingerprint, audio::river::io::DeviceCapability& _capability);
+					/**
+					 * @brief Set a device capability in the cache (and store it on the disk)
+					 * @param[in] _key Unique key of the device (backend:name:mode)
+					 * @param[in] _fingerprint Fingerprint of the current backend status
+					 * @param[in] _capability Capability of the device
+					 */
+					void set(const etk::String& _key, const etk::String& _fingerprint, const audio::river::io::DeviceCapability& _capability);
+				private:
+					/**
+					 * @brief Load the data if needed.
+					 */
+					void load();
+			};
+		}
+	}
+}
+
@@ -0,0 +1,150 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/DriftCompensator.hpp>
+#include <audio/river/debug.hpp>
+#include <cmath>
+
+// Maximum difference between the 2 clocks (the crystals are in the order of 100 ppm)
+static const double maximumDrift = 0.005;
+// Bandwidth of the loop (Hz): slow enough to filter the jitter of the callback timestamps
+static const double loopBandwidth = 0.05;
+// Low pass filter of the measured error (jitter of the timestamps)
+static const double errorFilter = 0.1;
+
+audio::river::io::DriftCompensator::DriftCompensator() :
+  m_format(audio::format_int16),
+  m_frequency(48000),
+  m_nbChannel(1),
+  m_frameSize(2),
+  m_nbChunk(0),
+  m_nbFrame(0),
+  m_position(0.0),
+  m_ratio(1.0),
+  m_error(0.0),
+  m_integral(0.0),
+  m_firstError(true),
+  m_proportionalGain(0.0),
+  m_integralGain(0.0) {
+	
+}
+
+bool audio::river::io::DriftCompensator::init(audio::format _format, uint32_t _nbChannel, uint32_t _frequency, uint32_t _nbChunk) {
+	switch (_format) {
+		case audio::format_int8:
+		case audio::format_int16:
+		case audio::format_int16_on_int32:
+		case audio::format_int24:
+		case audio::format_int32:
+		case audio::format_float:
+		case audio::format_double:
+			break;
+		default:
+			RIVER_ERROR("Drift compensation not availlable for the format " << _format);
+			return false;
+	}
+	m_format = _format;
+	m_nbChannel = _nbChannel;
+	m_frequency = _frequency;
+	m_frameSize = audio::getFormatBytes(_format)*_nbChannel;
+	m_nbChunk = _nbChunk;
+	// one chunk at the maximum ratio + the frame of the interpolation + the fractional part
+	m_input.resize((uint32_t(double(m_nbChunk)*(1.0+maximumDrift)) + 4)*m_frameSize, 0);
+	// second order loop updated at each chunk
+	double omega = 2.0*M_PI*loopBandwidth*double(m_nbChunk)/double(m_frequency);
+	m_proportionalGain = sqrt(2.0)*omega;
+	m_integralGain = omega*omega;
+	m_ratio = 1.0;
+	m_integral = 0.0;
+	reset();
+	return true;
+}
+
+void audio::river::io::DriftCompensator::reset() {
+	m_nbFrame = 0;
+	m_position = 0.0;
+	m_error = 0.0;
+	m_firstError = true;
+	// the integral (drift of the crystals) is kept
+	m_ratio = 1.0 + m_integral;
+}
+
+uint32_t audio::river::io::DriftCompensator::getInputSize() const {
+	// the last output need the frame after its position
+	uint32_t nbFrame = uint32_t(m_position + double(m_nbChunk-1)*m_ratio) + 2;
+	if (nbFrame <= m_nbFrame) {
+		return 0;
+	}
+	return nbFrame - m_nbFrame;
+}
+
+audio::Time audio::river::io::DriftCompensator::getReadTimeStamp(const audio::Time& _inputTime) const {
+	int64_t delay = int64_t((double(m_nbFrame) - m_position)*1000000000.0/double(m_frequency));
+	return _inputTime - audio::Duration(delay/1000000000LL, delay%1000000000LL);
+}
+
+void audio::river::io::DriftCompensator::update(double _error) {
+	if (m_firstError == true) {
+		m_firstError = false;
+		m_error = _error;
+	} else {
+		m_error += errorFilter*(_error - m_error);
+	}
+	// a positive error: the secondary flow is in advance ==> consume less frame
+	m_integral -= m_integralGain*m_error/double(m_nbChunk);
+	m_integral = etk::avg(-maximumDrift, m_integral, maximumDrift);
+	m_ratio = 1.0 + m_integral - m_proportionalGain*m_error/double(m_nbChunk);
+	m_ratio = etk::avg(1.0-maximumDrift, m_ratio, 1.0+maximumDrift);
+	RIVER_VERBOSE("drift: error=" << m_error << " ratio=" << m_ratio);
+}
+
+template<typename TYPE, typename COMPUTE>
+void audio::river::io::DriftCompensator::interpolate(TYPE* _output) {
+	const TYPE* input = reinterpret_cast<const TYPE*>(&m_input[0]);
+	double position = m_position;
+	for (uint32_t iii=0; iii<m_nbChunk; ++iii) {
+		uint32_t id = uint32_t(position);
+		COMPUTE fraction = COMPUTE(position - double(id));
+		const TYPE* current = input + id*m_nbChannel;
+		const TYPE* next = current + m_nbChannel;
+		for (uint32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+			COMPUTE value = COMPUTE(current[ccc]) + fraction*(COMPUTE(next[ccc]) - COMPUTE(current[ccc]));
+			_output[iii*m_nbChannel+ccc] = TYPE(value);
+		}
+		position += m_ratio;
+	}
+}
+
+void audio::river::io::DriftCompensator::resample(void* _output) {
+	switch (m_format) {
+		case audio::format_int8:
+			interpolate<int8_t, float>(static_cast<int8_t*>(_output));
+			break;
+		default:
+		case audio::format_int16:
+			interpolate<int16_t, float>(static_cast<int16_t*>(_output));
+			break;
+		case audio::format_int16_on_int32:
+		case audio::format_int24:
+		case audio::format_int32:
+			interpolate<int32_t, double>(static_cast<int32_t*>(_output));
+			break;
+		case audio::format_float:
+			interpolate<float, float>(static_cast<float*>(_output));
+			break;
+		case audio::format_double:
+			interpolate<double, double>(static_cast<double*>(_output));
+			break;
+	}
+	// drop the frames consumed (the next output start before the end of the chunk)
+	double position = m_position + double(m_nbChunk)*m_ratio;
+	uint32_t nbConsumed = etk::min(uint32_t(position), m_nbFrame);
+	m_position = position - double(nbConsumed);
+	m_nbFrame -= nbConsumed;
+	if (m_nbFrame != 0) {
+		memmove(&m_input[0], &m_input[nbConsumed*m_frameSize], m_nbFrame*m_frameSize);
+	}
+}
@@ -0,0 +1,115 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/Time.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Compensation of the clock drift of a secondary flow against a reference flow.
+			 * A delay locked loop on the read timestamps estimate the ratio between the 2 clocks and drive a linear
+			 * fractional resampler on the secondary flow: the flows stay aligned without drop or repeat of data.
+			 * @note All the buffers are allocated in init(), read() do not allocate.
+			 */
+			class DriftCompensator {
+				private:
+					audio::format m_format; //!< Format of the samples
+					uint32_t m_frequency; //!< Nominal frequency of the 2 flows
+					uint32_t m_nbChannel; //!< Number of channel of the secondary flow
+					uint32_t m_frameSize; //!< Size of a frame in byte
+					uint32_t m_nbChunk; //!< Number of frame generated at each read
+					etk::Vector<uint8_t> m_input; //!< Frames of the secondary flow not consumed
+					uint32_t m_nbFrame; //!< Number of frame in m_input
+					double m_position; //!< Fractional position of the next output in m_input
+					double m_ratio; //!< Number of input frame consumed for one output frame
+					double m_error; //!< Filtered alignment error (sample)
+					double m_integral; //!< Integral term of the loop (ratio offset)
+					bool m_firstError; //!< No error measured since the last reset
+					double m_proportionalGain; //!< Proportional gain of the loop
+					double m_integralGain; //!< Integral gain of the loop
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					DriftCompensator();
+					/**
+					 * @brief Initialize the compensator.
+					 * @param[in] _format Format of the samples.
+					 * @param[in] _nbChannel Number of channel of the secondary flow.
+					 * @param[in] _frequency Nominal frequency of the flows.
+					 * @param[in] _nbChunk Number of frame generated at each read.
+					 * @return true The format is supported.
+					 */
+					bool init(audio::format _format, uint32_t _nbChannel, uint32_t _frequency, uint32_t _nbChunk);
+					/**
+					 * @brief Drop the frames not consumed (after a jump of the read position), the estimation of the drift is kept.
+					 */
+					void reset();
+					/**
+					 * @brief Get the ratio between the secondary clock and the reference clock.
+					 * @return Number of secondary frame for one reference frame.
+					 */
+					double getRatio() const {
+						return m_ratio;
+					}
+					/**
+					 * @brief Get the maximum offset between the flows corrected by the compensation (a bigger one need a jump of the read position).
+					 * @return Maximum offset.
+					 */
+					audio::Duration getMaximumOffset() const {
+						return audio::Duration(0, 10000000);
+					}
+					/**
+					 * @brief Get the number of frame the next read() will get in the secondary buffer.
+					 * @return Number of frame.
+					 */
+					uint32_t getInputSize() const;
+					/**
+					 * @brief Get the time of the next frame of the secondary flow (the frames stored in the compensator are taken into account).
+					 * @param[in] _inputTime Time of the next frame not yet added in the compensator.
+					 * @return Time of the next frame.
+					 */
+					audio::Time getReadTimeStamp(const audio::Time& _inputTime) const;
+					/**
+					 * @brief Update the loop with a new alignment error.
+					 * @param[in] _error Time of the secondary flow minus time of the reference (sample).
+					 */
+					void update(double _error);
+					/**
+					 * @brief Generate one chunk from the frames stored (getInputSize() frames must have been added).
+					 * @param[out] _output Output buffer (nbChunk frames).
+					 */
+					void resample(void* _output);
+					/**
+					 * @brief Get the buffer where the next frames of the secondary flow must be written.
+					 * @return Pointer on the end of the stored frames (getInputSize() frames availlable).
+					 */
+					void* getInputBuffer() {
+						return &m_input[m_nbFrame*m_frameSize];
+					}
+					/**
+					 * @brief Validate the frames written in getInputBuffer().
+					 * @param[in] _nbFrame Number of frame added.
+					 */
+					void addInput(uint32_t _nbFrame) {
+						m_nbFrame += _nbFrame;
+					}
+				private:
+					/**
+					 * @brief Interpolate one chunk on a specific sample type.
+					 * @param[out] _output Output buffer.
+					 */
+					template<typename TYPE, typename COMPUTE> void interpolate(TYPE* _output);
+			};
+		}
+	}
+}
+
@@ -0,0 +1,203 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/EchoCanceller.hpp>
+#include <audio/river/debug.hpp>
+
+// Smoothing of the power of the reference
+static const float powerSmoothing = 0.9f;
+// Regularisation of the normalisation (prevent division by 0 on silence)
+static const float powerRegularisation = 1.0e-6f;
+// Minimum energy of a reference sample to adapt the filter (-70 dBFS)
+static const float minimumReferenceEnergy = 1.0e-7f;
+
+audio::river::io::EchoCanceller::EchoCanceller() :
+  m_blockSize(0),
+  m_nbPartition(0),
+  m_nbChannel(0),
+  m_nbBin(0),
+  m_step(0.5f),
+  m_referencePosition(0),
+  m_constraintPartition(0),
+  m_nbDivergence(0) {
+
+}
+
+bool audio::river::io::EchoCanceller::init(uint32_t _blockSize, uint32_t _nbPartition, uint32_t _nbChannel, float _step) {
+	if (    _nbPartition == 0
+	     || _nbChannel == 0) {
+		RIVER_ERROR("Echo canceller need at least one partition and one channel");
+		return false;
+	}
+	if (m_fft.init(_blockSize*2) == false) {
+		RIVER_ERROR("Echo canceller block size must be a power of 2: " << _blockSize);
+		return false;
+	}
+	m_blockSize = _blockSize;
+	m_nbPartition = _nbPartition;
+	m_nbChannel = _nbChannel;
+	m_nbBin = _blockSize+1;
+	m_step = etk::avg(0.0f, _step, 1.0f);
+	m_referenceHistory.resize(m_blockSize*2, 0);
+	m_referenceReal.resize(m_nbPartition*m_nbBin, 0);
+	m_referenceImag.resize(m_nbPartition*m_nbBin, 0);
+	m_referencePower.resize(m_nbBin, 0);
+	m_weightReal.resize(m_nbChannel*m_nbPartition*m_nbBin, 0);
+	m_weightImag.resize(m_nbChannel*m_nbPartition*m_nbBin, 0);
+	m_echoReal.resize(m_nbBin, 0);
+	m_echoImag.resize(m_nbBin, 0);
+	m_errorReal.resize(m_nbBin, 0);
+	m_errorImag.resize(m_nbBin, 0);
+	m_stepBin.resize(m_nbBin, 0);
+	m_time.resize(m_blockSize*2, 0);
+	m_error.resize(m_blockSize, 0);
+	reset();
+	RIVER_INFO("Echo canceller: block=" << m_blockSize << " partition=" << m_nbPartition << " channel=" << m_nbChannel << " step=" << m_step);
+	return true;
+}
+
+void audio::river::io::EchoCanceller::reset() {
+	for (auto &it : m_referenceHistory) {
+		it = 0.0f;
+	}
+	for (size_t iii=0; iii<m_referenceReal.size(); ++iii) {
+		m_referenceReal[iii] = 0.0f;
+		m_referenceImag[iii] = 0.0f;
+	}
+	for (auto &it : m_referencePower) {
+		it = 0.0f;
+	}
+	for (uint32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+		resetChannel(ccc);
+	}
+	m_referencePosition = 0;
+	m_constraintPartition = 0;
+}
+
+void audio::river::io::EchoCanceller::resetChannel(uint32_t _channel) {
+	size_t offset = size_t(_channel)*m_nbPartition*m_nbBin;
+	for (size_t iii=0; iii<size_t(m_nbPartition)*m_nbBin; ++iii) {
+		m_weightReal[offset+iii] = 0.0f;
+		m_weightImag[offset+iii] = 0.0f;
+	}
+}
+
+void audio::river::io::EchoCanceller::process(int16_t* _microphone, const int16_t* _reference) {
+	if (m_blockSize == 0) {
+		return;
+	}
+	const uint32_t nbBin = m_nbBin;
+	const uint32_t blockSize = m_blockSize;
+	// -1- Spectrum of the reference (overlap-save on 2 blocks), shared by all the channels
+	float referenceEnergy = 0.0f;
+	for (uint32_t iii=0; iii<blockSize; ++iii) {
+		m_referenceHistory[iii] = m_referenceHistory[blockSize+iii];
+		float value = float(_reference[iii]) * (1.0f/32768.0f);
+		m_referenceHistory[blockSize+iii] = value;
+		referenceEnergy += value*value;
+	}
+	m_referencePosition = (m_referencePosition + m_nbPartition - 1) % m_nbPartition;
+	float* newReal = &m_referenceReal[m_referencePosition*nbBin];
+	float* newImag = &m_referenceImag[m_referencePosition*nbBin];
+	m_fft.forward(&m_referenceHistory[0], newReal, newImag);
+	// -2- Normalized step per bin
+	const float stepNorm = m_step / float(m_nbPartition);
+	for (uint32_t bbb=0; bbb<nbBin; ++bbb) {
+		float power = newReal[bbb]*newReal[bbb] + newImag[bbb]*newImag[bbb];
+		// fast attack, slow release: the step is never too large when the reference start
+		m_referencePower[bbb] = etk::max(power, powerSmoothing*m_referencePower[bbb] + (1.0f-powerSmoothing)*power);
+		m_stepBin[bbb] = stepNorm / (m_referencePower[bbb] + powerRegularisation);
+	}
+	const bool adapt = referenceEnergy > minimumReferenceEnergy*float(blockSize);
+	// -3- Process each microphone channel against the shared reference
+	for (uint32_t ccc=0; ccc<m_nbChannel; ++ccc) {
+		float* weightReal = &m_weightReal[size_t(ccc)*m_nbPartition*nbBin];
+		float* weightImag = &m_weightImag[size_t(ccc)*m_nbPartition*nbBin];
+		// echo estimation: sum of the complex product of the filter and the reference on all the partitions
+		for (uint32_t bbb=0; bbb<nbBin; ++bbb) {
+			m_echoReal[bbb] = 0.0f;
+			m_echoImag[bbb] = 0.0f;
+		}
+		for (uint32_t ppp=0; ppp<m_nbPartition; ++ppp) {
+			const uint32_t ringId = (m_referencePosition + ppp) % m_nbPartition;
+			const float* xr = &m_referenceReal[ringId*nbBin];
+			const float* xi = &m_referenceImag[ringId*nbBin];
+			const float* wr = &weightReal[ppp*nbBin];
+			const float* wi = &weightImag[ppp*nbBin];
+			float* yr = &m_echoReal[0];
+			float* yi = &m_echoImag[0];
+			for (uint32_t bbb=0; bbb<nbBin; ++bbb) {
+				yr[bbb] += wr[bbb]*xr[bbb] - wi[bbb]*xi[bbb];
+				yi[bbb] += wr[bbb]*xi[bbb] + wi[bbb]*xr[bbb];
+			}
+		}
+		m_fft.inverse(&m_echoReal[0], &m_echoImag[0], &m_time[0]);
+		// error = microphone - echo (the last block of the overlap-save is valid)
+		float microphoneEnergy = 0.0f;
+		float errorEnergy = 0.0f;
+		for (uint32_t iii=0; iii<blockSize; ++iii) {
+			float microphone = float(_microphone[iii*m_nbChannel+ccc]) * (1.0f/32768.0f);
+			float error = microphone - m_time[blockSize+iii];
+			m_error[iii] = error;
+			microphoneEnergy += microphone*microphone;
+			errorEnergy += error*error;
+		}
+		if (errorEnergy > 4.0f*microphoneEnergy + minimumReferenceEnergy*float(blockSize)) {
+			// The filter diverge ==> restart the convergence and keep the microphone signal
+			m_nbDivergence.fetch_add(1);
+			resetChannel(ccc);
+			continue;
+		}
+		for (uint32_t iii=0; iii<blockSize; ++iii) {
+			float value = m_error[iii] * 32768.0f;
+			_microphone[iii*m_nbChannel+ccc] = static_cast<int16_t>(etk::avg(-32768.0f, value, 32767.0f));
+		}
+		if (adapt == false) {
+			continue;
+		}
+		// Simple double talk protection: slow down the adaptation when the residual is louder than the reference
+		float stepScale = 1.0f;
+		if (errorEnergy > referenceEnergy) {
+			stepScale = referenceEnergy/errorEnergy;
+		}
+		// -4- Spectrum of the error (first block set to 0)
+		for (uint32_t iii=0; iii<blockSize; ++iii) {
+			m_time[iii] = 0.0f;
+			m_time[blockSize+iii] = m_error[iii];
+		}
+		m_fft.forward(&m_time[0], &m_errorReal[0], &m_errorImag[0]);
+		for (uint32_t bbb=0; bbb<nbBin; ++bbb) {
+			const float step = m_stepBin[bbb]*stepScale;
+			m_errorReal[bbb] *= step;
+			m_errorImag[bbb] *= step;
+		}
+		// -5- Update of all the partitions: W += conj(X) * E * step
+		for (uint32_t ppp=0; ppp<m_nbPartition; ++ppp) {
+			const uint32_t ringId = (m_referencePosition + ppp) % m_nbPartition;
+			const float* xr = &m_referenceReal[ringId*nbBin];
+			const float* xi = &m_referenceImag[ringId*nbBin];
+			const float* er = &m_errorReal[0];
+			const float* ei = &m_errorImag[0];
+			float* wr = &weightReal[ppp*nbBin];
+			float* wi = &weightImag[ppp*nbBin];
+			for (uint32_t bbb=0; bbb<nbBin; ++bbb) {
+				wr[bbb] += xr[bbb]*er[bbb] + xi[bbb]*ei[bbb];
+				wi[bbb] += xr[bbb]*ei[bbb] - xi[bbb]*er[bbb];
+			}
+		}
+		// -6- Gradient constraint of one partition per block (round robin, as MDF): the second half of the impulse response must be 0
+		{
+			float* wr = &weightReal[m_constraintPartition*nbBin];
+			float* wi = &weightImag[m_constraintPartition*nbBin];
+			m_fft.inverse(wr, wi, &m_time[0]);
+			for (uint32_t iii=blockSize; iii<blockSize*2; ++iii) {
+				m_time[iii] = 0.0f;
+			}
+			m_fft.forward(&m_time[0], wr, wi);
+		}
+	}
+	m_constraintPartition = (m_constraintPartition + 1) % m_nbPartition;
+}
@@ -0,0 +1,95 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <audio/river/io/Fft.hpp>
+#include <atomic>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Acoustic echo canceller: partitioned-block frequency-domain adaptive filter (MDF).
+			 * The filter of each microphone channel is split in partitions of one block (overlap-save with a FFT of 2 blocks).
+			 * The spectrum of the reference (feedback) is computed once and shared by all the microphone channels.
+			 * @note All the buffers are allocated in init(), process() do not allocate.
+			 */
+			class EchoCanceller {
+				private:
+					uint32_t m_blockSize; //!< Number of sample in a block (size of a partition)
+					uint32_t m_nbPartition; //!< Number of partition of the filter
+					uint32_t m_nbChannel; //!< Number of microphone channel
+					uint32_t m_nbBin; //!< Number of frequency bin (blockSize+1)
+					float m_step; //!< Adaptation step [0..1]
+					audio::river::io::Fft m_fft; //!< Transform of 2 blocks
+					uint32_t m_referencePosition; //!< Position of the newest spectrum in the reference ring
+					uint32_t m_constraintPartition; //!< Partition constrained at the next block (round robin)
+					etk::Vector<float> m_referenceHistory; //!< Last 2 blocks of the reference
+					etk::Vector<float> m_referenceReal; //!< Ring of the spectrum of the reference (one per partition)
+					etk::Vector<float> m_referenceImag; //!< Ring of the spectrum of the reference (one per partition)
+					etk::Vector<float> m_referencePower; //!< Smoothed power of the reference per bin
+					etk::Vector<float> m_weightReal; //!< Filter of each channel and partition
+					etk::Vector<float> m_weightImag; //!< Filter of each channel and partition
+					etk::Vector<float> m_echoReal; //!< Spectrum of the echo estimation
+					etk::Vector<float> m_echoImag; //!< Spectrum of the echo estimation
+					etk::Vector<float> m_errorReal; //!< Spectrum of the error
+					etk::Vector<float> m_errorImag; //!< Spectrum of the error
+					etk::Vector<float> m_stepBin; //!< Normalized step per bin
+					etk::Vector<float> m_time; //!< Temporal working buffer (2 blocks)
+					etk::Vector<float> m_error; //!< Error of the current block (1 block)
+					std::atomic<uint32_t> m_nbDivergence; //!< Number of channel reset since the last report (written in the audio thread)
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					EchoCanceller();
+					/**
+					 * @brief Initialize the filter.
+					 * @param[in] _blockSize Number of sample processed at each call (power of 2).
+					 * @param[in] _nbPartition Number of partition (length of the filter = _nbPartition * _blockSize).
+					 * @param[in] _nbChannel Number of microphone channel.
+					 * @param[in] _step Adaptation step [0..1].
+					 * @return true The canceller is ready.
+					 */
+					bool init(uint32_t _blockSize, uint32_t _nbPartition, uint32_t _nbChannel, float _step);
+					/**
+					 * @brief Reset all the filters (restart the convergence).
+					 */
+					void reset();
+					/**
+					 * @brief Get the number of sample processed at each call.
+					 * @return Size of a block.
+					 */
+					uint32_t getBlockSize() const {
+						return m_blockSize;
+					}
+					/**
+					 * @brief Remove the echo of the reference in the microphone.
+					 * @param[in,out] _microphone Microphone samples (interleaved channels, one block) replaced by the signal without echo.
+					 * @param[in] _reference Reference samples (mono, one block).
+					 */
+					void process(int16_t* _microphone, const int16_t* _reference);
+					/**
+					 * @brief Get and clear the number of divergence of the filter (a channel is reset at each divergence).
+					 * @note process() does not log: the divergences are reported by the caller out of the audio thread.
+					 * @return Number of divergence since the last call.
+					 */
+					uint32_t takeDivergence() {
+						return m_nbDivergence.exchange(0);
+					}
+				private:
+					/**
+					 * @brief Reset the filter of one channel.
+					 * @param[in] _channel Id of the channel.
+					 */
+					void resetChannel(uint32_t _channel);
+			};
+		}
+	}
+}
+
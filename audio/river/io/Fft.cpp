@@ -0,0 +1,111 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/Fft.hpp>
+#include <audio/river/debug.hpp>
+#include <cmath>
+
+audio::river::io::Fft::Fft() :
+  m_size(0) {
+
+}
+
+bool audio::river::io::Fft::init(size_t _size) {
+	if (    _size < 2
+	     || (_size & (_size-1)) != 0) {
+		RIVER_ERROR("FFT size must be a power of 2: " << _size);
+		return false;
+	}
+	m_size = _size;
+	m_cos.resize(m_size/2, 0);
+	m_sin.resize(m_size/2, 0);
+	for (size_t iii=0; iii<m_size/2; ++iii) {
+		double angle = 2.0*M_PI*double(iii)/double(m_size);
+		m_cos[iii] = cos(angle);
+		m_sin[iii] = sin(angle);
+	}
+	size_t nbBit = 0;
+	while ((size_t(1) << nbBit) < m_size) {
+		nbBit++;
+	}
+	m_bitReverse.resize(m_size, 0);
+	for (size_t iii=0; iii<m_size; ++iii) {
+		uint32_t value = 0;
+		for (size_t bbb=0; bbb<nbBit; ++bbb) {
+			if ((iii >> bbb) & 1) {
+				value |= 1 << (nbBit-1-bbb);
+			}
+		}
+		m_bitReverse[iii] = value;
+	}
+	m_real.resize(m_size, 0);
+	m_imag.resize(m_size, 0);
+	return true;
+}
+
+void audio::river::io::Fft::transform(bool _inverse) {
+	float* real = &m_real[0];
+	float* imag = &m_imag[0];
+	for (size_t iii=0; iii<m_size; ++iii) {
+		size_t jjj = m_bitReverse[iii];
+		if (jjj > iii) {
+			float tmp = real[iii];
+			real[iii] = real[jjj];
+			real[jjj] = tmp;
+			tmp = imag[iii];
+			imag[iii] = imag[jjj];
+			imag[jjj] = tmp;
+		}
+	}
+	const float sign = _inverse == true ? 1.0f : -1.0f;
+	for (size_t len=2; len<=m_size; len <<= 1) {
+		size_t half = len/2;
+		size_t step = m_size/len;
+		for (size_t iii=0; iii<m_size; iii+=len) {
+			for (size_t jjj=0; jjj<half; ++jjj) {
+				const float wr = m_cos[jjj*step];
+				const float wi = sign*m_sin[jjj*step];
+				const size_t aaa = iii+jjj;
+				const size_t bbb = aaa+half;
+				const float tr = wr*real[bbb] - wi*imag[bbb];
+				const float ti = wr*imag[bbb] + wi*real[bbb];
+				real[bbb] = real[aaa] - tr;
+				imag[bbb] = imag[aaa] - ti;
+				real[aaa] += tr;
+				imag[aaa] += ti;
+			}
+		}
+	}
+}
+
+void audio::river::io::Fft::forward(const float* _input, float* _real, float* _imag) {
+	for (size_t iii=0; iii<m_size; ++iii) {
+		m_real[iii] = _input[iii];
+		m_imag[iii] = 0.0f;
+	}
+	transform(false);
+	for (size_t iii=0; iii<=m_size/2; ++iii) {
+		_real[iii] = m_real[iii];
+		_imag[iii] = m_imag[iii];
+	}
+}
+
+void audio::river::io::Fft::inverse(const float* _real, const float* _imag, float* _output) {
+	// rebuild the hermitian spectrum
+	for (size_t iii=0; iii<=m_size/2; ++iii) {
+		m_real[iii] = _real[iii];
+		m_imag[iii] = _imag[iii];
+	}
+	for (size_t iii=m_size/2+1; iii<m_size; ++iii) {
+		m_real[iii] = _real[m_size-iii];
+		m_imag[iii] = -_imag[m_size-iii];
+	}
+	transform(true);
+	const float scale = 1.0f/float(m_size);
+	for (size_t iii=0; iii<m_size; ++iii) {
+		_output[iii] = m_real[iii]*scale;
+	}
+}
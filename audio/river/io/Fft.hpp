@@ -0,0 +1,69 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Simple radix-2 FFT of real signal (used by the echo canceller).
+			 * The spectrum is stored in 2 separate arrays (real and imaginary) of size/2+1 bins to permit the compiler to vectorize the complex operations.
+			 * @note All the buffers are allocated in init(), the transforms do not allocate.
+			 */
+			class Fft {
+				private:
+					size_t m_size; //!< Size of the transform (power of 2)
+					etk::Vector<float> m_cos; //!< Twiddle factor (real part)
+					etk::Vector<float> m_sin; //!< Twiddle factor (imaginary part)
+					etk::Vector<uint32_t> m_bitReverse; //!< Bit reverse permutation
+					etk::Vector<float> m_real; //!< Working buffer (real part)
+					etk::Vector<float> m_imag; //!< Working buffer (imaginary part)
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					Fft();
+					/**
+					 * @brief Initialize the transform.
+					 * @param[in] _size Size of the transform (power of 2).
+					 * @return true The size is supported.
+					 */
+					bool init(size_t _size);
+					/**
+					 * @brief Get the size of the transform.
+					 * @return Number of real sample.
+					 */
+					size_t getSize() const {
+						return m_size;
+					}
+					/**
+					 * @brief Forward transform of a real signal.
+					 * @param[in] _input Real signal (size element).
+					 * @param[out] _real Real part of the spectrum (size/2+1 bins).
+					 * @param[out] _imag Imaginary part of the spectrum (size/2+1 bins).
+					 */
+					void forward(const float* _input, float* _real, float* _imag);
+					/**
+					 * @brief Inverse transform of an hermitian spectrum (scaled by 1/size).
+					 * @param[in] _real Real part of the spectrum (size/2+1 bins).
+					 * @param[in] _imag Imaginary part of the spectrum (size/2+1 bins).
+					 * @param[out] _output Real signal (size element).
+					 */
+					void inverse(const float* _real, const float* _imag, float* _output);
+				private:
+					/**
+					 * @brief Complex transform in place on the working buffers.
+					 * @param[in] _inverse Direction of the transform.
+					 */
+					void transform(bool _inverse);
+			};
+		}
+	}
+}
+
@@ -11,9 +11,48 @@
 #include <audio/river/io/NodeOrchestra.hpp>
 #include <audio/river/io/NodePortAudio.hpp>
 #include <audio/river/io/Node.hpp>
+#include <ethread/Thread.hpp>
+#include <ethread/Mutex.hpp>
+
+/**
+ * @brief Create a hardware node of a group.
+ * @param[in] _name Name of the node.
+ * @param[in] _config Configuration of the node.
+ * @return The new node or null if the type is not availlable.
+ */
+static ememory::SharedPtr<audio::river::io::Node> createGroupNode(const etk::String& _name, const ejson::Object& _config) {
+	// get type : io
+	etk::String ioType = _config["io"].toString().get("error");
+	#ifdef AUDIO_RIVER_BUILD_ORCHESTRA
+		if (    ioType == "input"
+		     || ioType == "output") {
+			return audio::river::io::NodeOrchestra::create(_name, _config);
+		}
+	#endif
+	#ifdef AUDIO_RIVER_BUILD_PORTAUDIO
+		if (    ioType == "PAinput"
+		     || ioType == "PAoutput") {
+			return audio::river::io::NodePortAudio::create(_name, _config);
+		}
+	#endif
+	return ememory::SharedPtr<audio::river::io::Node>();
+}
+
+/**
+ * @brief Check if a hardware node of a group can be created in parallel with the other nodes.
+ * @param[in] _config Configuration of the node.
+ * @return true The backend support a concurrent open (orchestra).
+ */
+static bool isParallelCreationAvaillable(const ejson::Object& _config) {
+	etk::String ioType = _config["io"].toString().get("error");
+	return    ioType == "input"
+	       || ioType == "output";
+}
 
 void audio::river::io::Group::createFrom(const ejson::Document& _obj, const etk::String& _name) {
 	RIVER_INFO("Create Group[" << _name << "] (START)    ___________________________");
+	etk::Vector<etk::String> listName;
+	etk::Vector<ejson::Object> listConfig;
 	for (size_t iii=0; iii<_obj.size(); ++iii) {
 		const ejson::Object tmpObject = _obj[iii].toObject();
 		if (tmpObject.exist() == false) {
@@ -22,38 +61,96 @@ void audio::river::io::Group::createFrom(const ejson::Document& _obj, const etk:
 		etk::String groupName = tmpObject["group"].toString().get();
 		if (groupName == _name) {
 			RIVER_INFO("Add element in Group[" << _name << "]: " << _obj.getKey(iii));
-			// get type : io
-			etk::String ioType = tmpObject["io"].toString().get("error");
-			#ifdef AUDIO_RIVER_BUILD_ORCHESTRA
-				if (    ioType == "input"
-				     || ioType == "output") {
-					ememory::SharedPtr<audio::river::io::Node> tmp = audio::river::io::NodeOrchestra::create(_obj.getKey(iii), tmpObject);
-					tmp->setGroup(sharedFromThis());
-					m_list.pushBack(tmp);
-				}
-			#endif
-			#ifdef AUDIO_RIVER_BUILD_PORTAUDIO
-				if (    ioType == "PAinput"
-				     || ioType == "PAoutput") {
-					ememory::SharedPtr<audio::river::io::Node> tmp = audio::river::io::NodePortAudio::create(_obj.getKey(iii), tmpObject);
-					tmp->setGroup(sharedFromThis());
-					m_list.pushBack(tmp);
+			listName.pushBack(_obj.getKey(iii));
+			listConfig.pushBack(tmpObject);
+		}
+	}
+	// Open the orchestra streams in parallel (each open can take some tens of ms) ==> the creation take the time of the slowest device.
+	// The PortAudio library is not thread-safe (device enumeration and Pa_OpenStream): its nodes are created sequentially.
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node>> listNode;
+	listNode.resize(listName.size());
+	etk::Vector<size_t> listParallel;
+	for (size_t iii=0; iii<listName.size(); ++iii) {
+		if (isParallelCreationAvaillable(listConfig[iii]) == true) {
+			listParallel.pushBack(iii);
+		} else {
+			listNode[iii] = createGroupNode(listName[iii], listConfig[iii]);
+		}
+	}
+	if (listParallel.size() == 1) {
+		listNode[listParallel[0]] = createGroupNode(listName[listParallel[0]], listConfig[listParallel[0]]);
+	} else if (listParallel.size() > 1) {
+		ethread::Mutex mutexPool;
+		size_t nextId = 0;
+		etk::Vector<ememory::SharedPtr<ethread::Thread>> listThread;
+		size_t nbThread = etk::min(listParallel.size(), size_t(4));
+		for (size_t ttt=0; ttt<nbThread; ++ttt) {
+			listThread.pushBack(ememory::makeShared<ethread::Thread>([&]() {
+				while (true) {
+					size_t id = 0;
+					{
+						ethread::UniqueLock lock(mutexPool);
+						if (nextId >= listParallel.size()) {
+							return;
+						}
+						id = listParallel[nextId++];
+					}
+					listNode[id] = createGroupNode(listName[id], listConfig[id]);
 				}
-			#endif
+			}, "RIVER group open"));
+		}
+		for (auto &it : listThread) {
+			it->join();
 		}
 	}
+	for (size_t iii=0; iii<listNode.size(); ++iii) {
+		if (listNode[iii] == null) {
+			continue;
+		}
+		listNode[iii]->setGroup(sharedFromThis());
+		m_list.pushBack(listNode[iii]);
+	}
 	// Link all the IO together : (not needed if one device ...
 	// Note : The interlink work only for alsa (NOW) and with AirTAudio...
 	if(m_list.size() > 1) {
 		#ifdef AUDIO_RIVER_BUILD_ORCHESTRA
-			ememory::SharedPtr<audio::river::io::NodeOrchestra> linkRef = ememory::dynamicPointerCast<audio::river::io::NodeOrchestra>(m_list[0]);
-			for (size_t iii=1; iii<m_list.size(); ++iii) {
-				if (m_list[iii] != null) {
-					ememory::SharedPtr<audio::river::io::NodeOrchestra> link = ememory::dynamicPointerCast<audio::river::io::NodeOrchestra>(m_list[iii]);
+			ememory::SharedPtr<audio::river::io::NodeOrchestra> linkRef;
+			for (size_t iii=0; iii<m_list.size(); ++iii) {
+				ememory::SharedPtr<audio::river::io::NodeOrchestra> link = ememory::dynamicPointerCast<audio::river::io::NodeOrchestra>(m_list[iii]);
+				if (link == null) {
+					continue;
+				}
+				if (linkRef == null) {
+					linkRef = link;
+				} else {
 					linkRef->m_interface.isMasterOf(link->m_interface);
 				}
 			}
 		#endif
+		#ifdef AUDIO_RIVER_BUILD_PORTAUDIO
+			// PortAudio: each output process an input of the group in the same full duplex stream
+			etk::Vector<ememory::SharedPtr<audio::river::io::NodePortAudio>> listInput;
+			etk::Vector<ememory::SharedPtr<audio::river::io::NodePortAudio>> listOutput;
+			for (size_t iii=0; iii<m_list.size(); ++iii) {
+				ememory::SharedPtr<audio::river::io::NodePortAudio> link = ememory::dynamicPointerCast<audio::river::io::NodePortAudio>(m_list[iii]);
+				if (link == null) {
+					continue;
+				}
+				if (link->isInput() == true) {
+					listInput.pushBack(link);
+				} else {
+					listOutput.pushBack(link);
+				}
+			}
+			for (size_t iii=0; iii<listOutput.size(); ++iii) {
+				for (size_t jjj=0; jjj<listInput.size(); ++jjj) {
+					if (listOutput[iii]->linkDuplex(listInput[jjj]) == true) {
+						listInput.erase(listInput.begin()+jjj);
+						break;
+					}
+				}
+			}
+		#endif
 	}
 	/*
 	// manage Link Between Nodes :
@@ -90,6 +187,16 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Group::getNode(cons
 	return ememory::SharedPtr<audio::river::io::Node>();
 }
 
+etk::Vector<etk::String> audio::river::io::Group::getNodeNames() {
+	etk::Vector<etk::String> out;
+	for (size_t iii=0; iii<m_list.size(); ++iii) {
+		if (m_list[iii] != null) {
+			out.pushBack(m_list[iii]->getName());
+		}
+	}
+	return out;
+}
+
 void audio::river::io::Group::start() {
 	RIVER_ERROR("request start ");
 	int32_t count = 0;
@@ -49,6 +49,11 @@ namespace audio {
 					 * @return pointer The node was find in this group.
 					 */
 					ememory::SharedPtr<audio::river::io::Node> getNode(const etk::String& _name);
+					/**
+					 * @brief Get the name of all the node in the group.
+					 * @return List of node names.
+					 */
+					etk::Vector<etk::String> getNodeNames();
 					/**
 					 * @brief Start the group.
 					 * @note all sub-node will be started.
@@ -10,8 +10,13 @@
 #include <audio/river/io/Node.hpp>
 #include <audio/river/io/NodeAEC.hpp>
 #include <audio/river/io/NodeMuxer.hpp>
+#include <audio/river/io/NodeMixer.hpp>
+#include <audio/river/io/NodeSlice.hpp>
 #include <audio/river/io/NodeOrchestra.hpp>
 #include <audio/river/io/NodePortAudio.hpp>
+#include <audio/river/io/NodeFile.hpp>
+#include <audio/river/io/NodeVirtual.hpp>
+#include <audio/river/io/NodeShm.hpp>
 #include <ememory/memory.hpp>
 #include <etk/types.hpp>
 #include <etk/path/fileSystem.hpp>
@@ -58,13 +63,31 @@ static etk::String basicAutoConfig =
 
 
 static etk::Uri pathToTheRiverConfigInHome(etk::path::getHomePath() / ".local" / "share" / "audio-river" / "config.json");
+static etk::Uri pathToTheRiverDeviceCacheInHome(etk::path::getHomePath() / ".local" / "share" / "audio-river" / "device-cache.json");
 
-audio::river::io::Manager::Manager() {
+audio::river::io::Manager::Manager() :
+  m_portAudioInit(false),
+  m_deviceCache(pathToTheRiverDeviceCacheInHome),
+  m_periodThreadAlive(false),
+  m_offline(false) {
+	
+}
+
+bool audio::river::io::Manager::initPortAudio() {
+	ethread::UniqueLock lock(m_mutexNodeCreation);
 	#ifdef AUDIO_RIVER_BUILD_PORTAUDIO
-	PaError err = Pa_Initialize();
-	if(err != paNoError) {
-		RIVER_WARNING("Can not initialize portaudio : " << Pa_GetErrorText(err));
-	}
+		if (m_portAudioInit == true) {
+			return true;
+		}
+		PaError err = Pa_Initialize();
+		if(err != paNoError) {
+			RIVER_WARNING("Can not initialize portaudio : " << Pa_GetErrorText(err));
+			return false;
+		}
+		m_portAudioInit = true;
+		return true;
+	#else
+		return false;
 	#endif
 }
 
@@ -88,16 +111,382 @@ void audio::river::io::Manager::initString(const etk::String& _data) {
 	m_config.parse(_data);
 }
 
+etk::Map<etk::String, etk::String> audio::river::io::Manager::getConfigSnapshot() {
+	etk::Map<etk::String, etk::String> out;
+	etk::Vector<etk::String> keys = m_config.getKeys();
+	for (auto &it : keys) {
+		out.add(it, m_config[it].generateMachineString());
+	}
+	return out;
+}
+
+bool audio::river::io::Manager::reload(const etk::Uri& _uri) {
+	ethread::RecursiveLock lockReload(m_mutexReload);
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listReplaced;
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listNewNode;
+	{
+		ethread::RecursiveLock lock(m_mutex);
+		etk::String previousConfig = m_config.generateMachineString();
+		etk::Map<etk::String, etk::String> previous = getConfigSnapshot();
+		if (m_config.load(_uri) == false) {
+			RIVER_ERROR("Can not reload the configuration file: " << _uri << " ==> keep the previous one");
+			m_config.parse(previousConfig);
+			return false;
+		}
+		if (applyReload(previous, previousConfig, listReplaced, listNewNode) == false) {
+			return false;
+		}
+	}
+	migrateNodes(listReplaced, listNewNode);
+	return true;
+}
+
+bool audio::river::io::Manager::reloadString(const etk::String& _data) {
+	ethread::RecursiveLock lockReload(m_mutexReload);
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listReplaced;
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listNewNode;
+	{
+		ethread::RecursiveLock lock(m_mutex);
+		etk::String previousConfig = m_config.generateMachineString();
+		etk::Map<etk::String, etk::String> previous = getConfigSnapshot();
+		if (m_config.parse(_data) == false) {
+			RIVER_ERROR("Can not reload the configuration string ==> keep the previous one");
+			m_config.parse(previousConfig);
+			return false;
+		}
+		if (applyReload(previous, previousConfig, listReplaced, listNewNode) == false) {
+			return false;
+		}
+	}
+	migrateNodes(listReplaced, listNewNode);
+	return true;
+}
+
+void audio::river::io::Manager::migrateNodes(const etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listOld,
+                                             const etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listNew) {
+	// Without m_mutex: the migration lock the interfaces, that lock the manager when they start (Interface::start)
+	for (size_t iii=0; iii<_listOld.size(); ++iii) {
+		_listOld[iii]->migrateInterface(_listNew[iii]);
+	}
+	RIVER_INFO("Reload configuration ( END )");
+}
+
+bool audio::river::io::Manager::applyReload(const etk::Map<etk::String, etk::String>& _previous,
+                                            const etk::String& _previousConfig,
+                                            etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listReplaced,
+                                            etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listNewNode) {
+	RIVER_INFO("Reload configuration (START)");
+	etk::Map<etk::String, etk::String> current = getConfigSnapshot();
+	// list all the node that change (or are removed):
+	etk::Vector<etk::String> listChange;
+	for (auto it = _previous.begin(); it != _previous.end(); ++it) {
+		auto itCurrent = current.find(it->first);
+		if (itCurrent == current.end()) {
+			RIVER_INFO("    remove node: " << it->first);
+			listChange.pushBack(it->first);
+		} else if (itCurrent->second != it->second) {
+			RIVER_INFO("    change node: " << it->first);
+			listChange.pushBack(it->first);
+		}
+	}
+	for (auto it = current.begin(); it != current.end(); ++it) {
+		if (_previous.find(it->first) == _previous.end()) {
+			RIVER_INFO("    add node: " << it->first);
+			listChange.pushBack(it->first);
+		}
+	}
+	// A group is synchronized at the low level ==> when one element change, all the group is re-created.
+	etk::Vector<etk::String> listGroupChange;
+	for (auto &it : listChange) {
+		etk::String groupName = m_config[it].toObject()["group"].toString().get();
+		if (    groupName != ""
+		     && etk::isIn(groupName, listGroupChange) == false) {
+			listGroupChange.pushBack(groupName);
+		}
+		// the node can have been removed from the group:
+		for (auto itGroup = m_listGroup.begin(); itGroup != m_listGroup.end(); ++itGroup) {
+			if (    itGroup->second != null
+			     && itGroup->second->getNode(it) != null
+			     && etk::isIn(itGroup->first, listGroupChange) == false) {
+				listGroupChange.pushBack(itGroup->first);
+			}
+		}
+	}
+	etk::Map<etk::String, ememory::SharedPtr<audio::river::io::Group> > listOldGroup;
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listOldNode;
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listOldStandalone;
+	for (auto &itGroup : listGroupChange) {
+		auto it = m_listGroup.find(itGroup);
+		if (it == m_listGroup.end()) {
+			continue;
+		}
+		RIVER_INFO("    re-create group: " << itGroup);
+		for (auto &itName : it->second->getNodeNames()) {
+			listOldNode.pushBack(it->second->getNode(itName));
+		}
+		listOldGroup.add(it->first, it->second);
+		m_listGroup.erase(it);
+	}
+	// Remove the changed node from the standalone list (a new one will be created on request)
+	for (auto &itName : listChange) {
+		for (size_t iii=0; iii<m_list.size(); ++iii) {
+			ememory::SharedPtr<audio::river::io::Node> tmppp = m_list[iii].lock();
+			if (    tmppp != null
+			     && tmppp->getName() == itName) {
+				listOldNode.pushBack(tmppp);
+				listOldStandalone.pushBack(tmppp);
+				m_list.erase(m_list.begin()+iii);
+				break;
+			}
+		}
+	}
+	// Stop the old nodes and release their streams before opening the new ones (a device can be opened only one time):
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listReplaced;
+	for (auto &itNode : listOldNode) {
+		if (itNode == null) {
+			continue;
+		}
+		if (m_config[itNode->getName()].toObject().exist() == false) {
+			RIVER_WARNING("    node '" << itNode->getName() << "' removed: it will be destroyed when all interfaces are closed");
+			continue;
+		}
+		itNode->suspend();
+		listReplaced.pushBack(itNode);
+	}
+	// Create the new nodes:
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listNewNode;
+	bool error = false;
+	for (auto &itNode : listReplaced) {
+		ememory::SharedPtr<audio::river::io::Node> newNode = getNode(itNode->getName());
+		if (    newNode == null
+		     || newNode->isStreamOpen() == false) {
+			RIVER_ERROR("    node '" << itNode->getName() << "' can not be re-created ==> restore the previous configuration");
+			error = true;
+			break;
+		}
+		listNewNode.pushBack(newNode);
+	}
+	if (error == true) {
+		// Release the new nodes and restore the old ones with the previous configuration:
+		listNewNode.clear();
+		for (auto &itGroup : listGroupChange) {
+			auto it = m_listGroup.find(itGroup);
+			if (it != m_listGroup.end()) {
+				m_listGroup.erase(it);
+			}
+		}
+		for (auto &itName : listChange) {
+			for (size_t iii=0; iii<m_list.size(); ++iii) {
+				ememory::SharedPtr<audio::river::io::Node> tmppp = m_list[iii].lock();
+				if (    tmppp != null
+				     && tmppp->getName() == itName) {
+					m_list.erase(m_list.begin()+iii);
+					break;
+				}
+			}
+		}
+		m_config.parse(_previousConfig);
+		for (auto it = listOldGroup.begin(); it != listOldGroup.end(); ++it) {
+			m_listGroup.add(it->first, it->second);
+		}
+		for (auto &itNode : listOldStandalone) {
+			m_list.pushBack(itNode);
+		}
+		for (auto &itNode : listReplaced) {
+			itNode->resume();
+		}
+		RIVER_INFO("Reload configuration ( END ) ==> ERROR");
+		return false;
+	}
+	// The interfaces of the old nodes are migrated on the new ones by the caller, without m_mutex
+	_listReplaced = listReplaced;
+	_listNewNode = listNewNode;
+	return true;
+}
+
+void audio::river::io::Manager::startPeriodThread() {
+	ethread::UniqueLock lock(m_mutexPeriod);
+	if (m_periodThread != null) {
+		return;
+	}
+	m_periodThreadAlive = true;
+	m_periodThread = ememory::makeShared<ethread::Thread>([=](){this->periodThreadCallback();}, "RIVER period");
+}
+
+void audio::river::io::Manager::stopPeriodThread() {
+	ememory::SharedPtr<ethread::Thread> thread;
+	{
+		ethread::UniqueLock lock(m_mutexPeriod);
+		thread = m_periodThread;
+		m_periodThread.reset();
+		m_periodThreadAlive = false;
+	}
+	etk::Vector<etk::String> requests;
+	{
+		ethread::UniqueLock lock(m_mutexNodeCreation);
+		for (auto it = m_listPeriodSlot.begin(); it != m_listPeriodSlot.end(); ++it) {
+			if (it->second->exchange(0) != 0) {
+				requests.pushBack(it->first);
+			}
+		}
+	}
+	for (auto &it : requests) {
+		cancelPeriodRequest(it);
+	}
+	if (thread == null) {
+		return;
+	}
+	m_periodSemaphore.post();
+	thread->join();
+}
+
+ememory::SharedPtr<std::atomic<uint32_t> > audio::river::io::Manager::getPeriodSlot(const etk::String& _name) {
+	// called in the node constructor (can be in parallel when a group is created)
+	ethread::UniqueLock lock(m_mutexNodeCreation);
+	auto it = m_listPeriodSlot.find(_name);
+	if (it != m_listPeriodSlot.end()) {
+		return it->second;
+	}
+	ememory::SharedPtr<std::atomic<uint32_t> > slot = ememory::makeShared<std::atomic<uint32_t> >(0);
+	m_listPeriodSlot.add(_name, slot);
+	return slot;
+}
+
+void audio::river::io::Manager::deliverStatus() {
+	etk::Vector<ememory::SharedPtr<audio::river::io::Node> > listNode;
+	{
+		ethread::RecursiveLock lock(m_mutex);
+		for (auto &it : m_list) {
+			ememory::SharedPtr<audio::river::io::Node> node = it.lock();
+			if (node != null) {
+				listNode.pushBack(node);
+			}
+		}
+		for (auto itGroup = m_listGroup.begin(); itGroup != m_listGroup.end(); ++itGroup) {
+			if (itGroup->second == null) {
+				continue;
+			}
+			for (auto &itName : itGroup->second->getNodeNames()) {
+				ememory::SharedPtr<audio::river::io::Node> node = itGroup->second->getNode(itName);
+				if (    node != null
+				     && etk::isIn(node, listNode) == false) {
+					listNode.pushBack(node);
+				}
+			}
+		}
+	}
+	// the status callbacks of the user are called without the lock of the manager
+	for (auto &it : listNode) {
+		it->deliverStatus();
+	}
+}
+
+void audio::river::io::Manager::periodThreadCallback() {
+	while (m_periodThreadAlive == true) {
+		// the slots are written in the audio thread without wake up: they are polled
+		m_periodSemaphore.wait(100000);
+		if (m_periodThreadAlive == false) {
+			return;
+		}
+		deliverStatus();
+		etk::Map<etk::String, uint32_t> requests;
+		etk::Map<etk::String, ememory::SharedPtr<audio::river::io::PeriodAdapter> > listAdapter;
+		{
+			ethread::UniqueLock lock(m_mutexNodeCreation);
+			listAdapter = m_listPeriodAdapter;
+			for (auto it = m_listPeriodSlot.begin(); it != m_listPeriodSlot.end(); ++it) {
+				uint32_t nbChunk = it->second->exchange(0);
+				if (nbChunk != 0) {
+					requests.add(it->first, nbChunk);
+				}
+			}
+		}
+		// the adapters never log in the audio thread
+		for (auto it = listAdapter.begin(); it != listAdapter.end(); ++it) {
+			it->second->report(it->first);
+		}
+		if (requests.size() == 0) {
+			continue;
+		}
+		// no other reload between the copy of the configuration and its apply
+		ethread::RecursiveLock lockReload(m_mutexReload);
+		// Apply all the requests in one reload (a group is re-created only one time)
+		ejson::Document tmpConfig;
+		bool change = false;
+		{
+			ethread::RecursiveLock lock(m_mutex);
+			tmpConfig.parse(m_config.generateMachineString());
+		}
+		for (auto it = requests.begin(); it != requests.end(); ++it) {
+			ejson::Object nodeConfig = tmpConfig[it->first].toObject();
+			if (    nodeConfig.exist() == false
+			     || uint32_t(nodeConfig["nb-chunk"].toNumber().get(1024)) == it->second) {
+				// the node is not re-created
+				cancelPeriodRequest(it->first);
+				continue;
+			}
+			RIVER_INFO("Change the period of '" << it->first << "': nb-chunk=" << nodeConfig["nb-chunk"].toNumber().get(1024) << " ==> " << it->second);
+			nodeConfig.add("nb-chunk", ejson::Number(it->second));
+			change = true;
+		}
+		// reloadString() migrate the interfaces without m_mutex
+		if (    change == true
+		     && reloadString(tmpConfig.generateMachineString()) == false) {
+			// the previous configuration is restored (nb-chunk included) and the old nodes are kept
+			for (auto it = requests.begin(); it != requests.end(); ++it) {
+				cancelPeriodRequest(it->first);
+			}
+		}
+	}
+}
+
+void audio::river::io::Manager::cancelPeriodRequest(const etk::String& _name) {
+	ethread::UniqueLock lock(m_mutexNodeCreation);
+	auto it = m_listPeriodAdapter.find(_name);
+	if (it != m_listPeriodAdapter.end()) {
+		it->second->cancelRequest();
+	}
+}
+
+ememory::SharedPtr<audio::river::io::PeriodAdapter> audio::river::io::Manager::getPeriodAdapter(const etk::String& _name) {
+	// called in the node constructor (can be in parallel when a group is created)
+	ethread::UniqueLock lock(m_mutexNodeCreation);
+	auto it = m_listPeriodAdapter.find(_name);
+	if (it != m_listPeriodAdapter.end()) {
+		return it->second;
+	}
+	ememory::SharedPtr<audio::river::io::PeriodAdapter> adapter = ememory::makeShared<audio::river::io::PeriodAdapter>();
+	m_listPeriodAdapter.add(_name, adapter);
+	return adapter;
+}
+
+bool audio::river::io::Manager::getXrun(const etk::String& _name, uint32_t& _underflow, uint32_t& _overflow) {
+	ememory::SharedPtr<audio::river::io::Node> node = getCreatedNode(_name);
+	if (node == null) {
+		_underflow = 0;
+		_overflow = 0;
+		return false;
+	}
+	node->getXrun(_underflow, _overflow);
+	return true;
+}
+
 void audio::river::io::Manager::unInit() {
+	// the period thread lock the manager
+	stopPeriodThread();
 	ethread::RecursiveLock lock(m_mutex);
 	// TODO : ...
 }
 
 audio::river::io::Manager::~Manager() {
+	stopPeriodThread();
 	#ifdef AUDIO_RIVER_BUILD_PORTAUDIO
-	PaError err = Pa_Terminate();
-	if(err != paNoError) {
-		RIVER_WARNING("Can not initialize portaudio : " << Pa_GetErrorText(err));
+	if (m_portAudioInit == true) {
+		PaError err = Pa_Terminate();
+		if(err != paNoError) {
+			RIVER_WARNING("Can not un-initialize portaudio : " << Pa_GetErrorText(err));
+		}
+		m_portAudioInit = false;
 	}
 	#endif
 };
@@ -120,7 +509,10 @@ etk::Vector<etk::String> audio::river::io::Manager::getListStreamInput() {
 		if (tmppp.exist() == true) {
 			etk::String type = tmppp["io"].toString().get("error");
 			if (    type == "input"
-			     || type == "PAinput") {
+			     || type == "PAinput"
+			     || type == "file-input"
+			     || type == "virtual-input"
+			     || type == "shm-input") {
 				output.pushBack(it);
 			}
 		}
@@ -137,7 +529,10 @@ etk::Vector<etk::String> audio::river::io::Manager::getListStreamOutput() {
 		if (tmppp.exist() == true) {
 			etk::String type = tmppp["io"].toString().get("error");
 			if (    type == "output"
-			     || type == "PAoutput") {
+			     || type == "PAoutput"
+			     || type == "file-output"
+			     || type == "virtual-output"
+			     || type == "shm-output") {
 				output.pushBack(it);
 			}
 		}
@@ -157,6 +552,12 @@ etk::Vector<etk::String> audio::river::io::Manager::getListStreamVirtual() {
 			     && type != "PAinput"
 			     && type != "output"
 			     && type != "PAoutput"
+			     && type != "file-input"
+			     && type != "file-output"
+			     && type != "virtual-input"
+			     && type != "virtual-output"
+			     && type != "shm-input"
+			     && type != "shm-output"
 			     && type != "error") {
 				output.pushBack(it);
 			}
@@ -181,9 +582,8 @@ etk::Vector<etk::String> audio::river::io::Manager::getListStream() {
 	return output;
 }
 
-ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(const etk::String& _name) {
+ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getCreatedNode(const etk::String& _name) {
 	ethread::RecursiveLock lock(m_mutex);
-	RIVER_WARNING("Get node : " << _name);
 	// search in the standalone list :
 	for (size_t iii=0; iii<m_list.size(); ++iii) {
 		ememory::SharedPtr<audio::river::io::Node> tmppp = m_list[iii].lock();
@@ -207,6 +607,16 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(co
 			}
 		}
 	}
+	return ememory::SharedPtr<audio::river::io::Node>();
+}
+
+ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(const etk::String& _name) {
+	ethread::RecursiveLock lock(m_mutex);
+	RIVER_WARNING("Get node : " << _name);
+	ememory::SharedPtr<audio::river::io::Node> node = getCreatedNode(_name);
+	if (node != null) {
+		return node;
+	}
 	RIVER_WARNING("Try create a new one : " << _name);
 	// check if the node can be open :
 	const ejson::Object tmpObject = m_config[_name].toObject();
@@ -216,6 +626,7 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(co
 		// get type : io
 		etk::String ioType = tmpObject["io"].toString().get("error");
 		if (    groupName != ""
+		     && m_offline == false
 		     && (    ioType == "input"
 		          || ioType == "output"
 		          || ioType == "PAinput"
@@ -232,6 +643,19 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(co
 			}
 			// TODO : Create a standalone group for every single element ==> simplify understanding ... but not for virtual interface ...
 			
+			if (    m_offline == true
+			     && (    ioType == "input"
+			          || ioType == "output"
+			          || ioType == "PAinput"
+			          || ioType == "PAoutput") ) {
+				#ifdef AUDIO_RIVER_BUILD_VIRTUAL
+					RIVER_INFO("Offline mode: replace the hardware node '" << _name << "' by a virtual node");
+					ememory::SharedPtr<audio::river::io::NodeVirtual> tmp = audio::river::io::NodeVirtual::create(_name, tmpObject);
+					tmp->setManualClock(true);
+					m_list.pushBack(tmp);
+					return tmp;
+				#endif
+			}
 			if (    ioType == "input"
 			     || ioType == "output") {
 				#ifdef AUDIO_RIVER_BUILD_ORCHESTRA
@@ -252,6 +676,42 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(co
 					RIVER_WARNING("not present interface");
 				#endif
 			}
+			if (    ioType == "file-input"
+			     || ioType == "file-output") {
+				#ifdef AUDIO_RIVER_BUILD_FILE
+					ememory::SharedPtr<audio::river::io::NodeFile> tmp = audio::river::io::NodeFile::create(_name, tmpObject);
+					if (m_offline == true) {
+						tmp->setManualClock(true);
+					}
+					m_list.pushBack(tmp);
+					return tmp;
+				#else
+					RIVER_WARNING("not present interface");
+				#endif
+			}
+			if (    ioType == "virtual-input"
+			     || ioType == "virtual-output") {
+				#ifdef AUDIO_RIVER_BUILD_VIRTUAL
+					ememory::SharedPtr<audio::river::io::NodeVirtual> tmp = audio::river::io::NodeVirtual::create(_name, tmpObject);
+					if (m_offline == true) {
+						tmp->setManualClock(true);
+					}
+					m_list.pushBack(tmp);
+					return tmp;
+				#else
+					RIVER_WARNING("not present interface");
+				#endif
+			}
+			if (    ioType == "shm-input"
+			     || ioType == "shm-output") {
+				#ifdef AUDIO_RIVER_BUILD_SHM
+					ememory::SharedPtr<audio::river::io::NodeShm> tmp = audio::river::io::NodeShm::create(_name, tmpObject);
+					m_list.pushBack(tmp);
+					return tmp;
+				#else
+					RIVER_WARNING("not present interface");
+				#endif
+			}
 			if (ioType == "aec") {
 				ememory::SharedPtr<audio::river::io::Node> tmp = audio::river::io::NodeAEC::create(_name, tmpObject);
 				m_list.pushBack(tmp);
@@ -262,14 +722,119 @@ ememory::SharedPtr<audio::river::io::Node> audio::river::io::Manager::getNode(co
 				m_list.pushBack(tmp);
 				return tmp;
 			}
+			if (ioType == "mixer") {
+				ememory::SharedPtr<audio::river::io::Node> tmp = audio::river::io::NodeMixer::create(_name, tmpObject);
+				m_list.pushBack(tmp);
+				return tmp;
+			}
+			if (ioType == "slice") {
+				ememory::SharedPtr<audio::river::io::Node> tmp = audio::river::io::NodeSlice::create(_name, tmpObject);
+				m_list.pushBack(tmp);
+				return tmp;
+			}
 		}
 	}
 	RIVER_ERROR("Can not create the interface : '" << _name << "' the node is not DEFINED in the configuration file availlable : " << m_config.getKeys());
 	return ememory::SharedPtr<audio::river::io::Node>();
 }
 
-ememory::SharedPtr<audio::drain::VolumeElement> audio::river::io::Manager::getVolumeGroup(const etk::String& _name) {
+bool audio::river::io::Manager::setOfflineMode(bool _offline) {
 	ethread::RecursiveLock lock(m_mutex);
+	if (m_offline == _offline) {
+		return true;
+	}
+	#ifndef AUDIO_RIVER_BUILD_VIRTUAL
+		if (_offline == true) {
+			RIVER_ERROR("Offline mode is not availlable (need the virtual node)");
+			return false;
+		}
+	#endif
+	for (auto &it : m_list) {
+		if (it.expired() == false) {
+			RIVER_ERROR("Can not change the offline mode when a node is open");
+			return false;
+		}
+	}
+	if (m_listGroup.size() != 0) {
+		RIVER_ERROR("Can not change the offline mode when a group is open");
+		return false;
+	}
+	RIVER_INFO("Offline mode: " << _offline);
+	ethread::UniqueLock lockOffline(m_mutexOffline);
+	m_offline = _offline;
+	m_offlineTime = audio::Time::now();
+	return true;
+}
+
+bool audio::river::io::Manager::isOffline() const {
+	// not locked with m_mutex: called by the node when it start (with the node locked)
+	ethread::UniqueLock lock(m_mutexOffline);
+	return m_offline;
+}
+
+audio::Time audio::river::io::Manager::getOfflineTime() const {
+	ethread::UniqueLock lock(m_mutexOffline);
+	return m_offlineTime;
+}
+
+bool audio::river::io::Manager::renderOffline(const audio::Duration& _duration) {
+	#ifdef AUDIO_RIVER_BUILD_VIRTUAL
+		etk::Vector<ememory::SharedPtr<audio::river::io::NodeClock> > listNode;
+		{
+			ethread::RecursiveLock lock(m_mutex);
+			if (m_offline == false) {
+				RIVER_ERROR("Can not render offline: the offline mode is not enable");
+				return false;
+			}
+			// dependency order: the outputs generate the feedback and the loopback needed by the inputs at the same time.
+			for (size_t iii=0; iii<2; ++iii) {
+				for (auto &it : m_list) {
+					ememory::SharedPtr<audio::river::io::NodeClock> node = ememory::dynamicPointerCast<audio::river::io::NodeClock>(it.lock());
+					if (    node != null
+					     && node->isOutput() == (iii == 0)) {
+						listNode.pushBack(node);
+					}
+				}
+			}
+		}
+		// The node are processed without the manager lock (the node lock the manager when it start)
+		audio::Time endTime = getOfflineTime() + _duration;
+		while (true) {
+			// process the node that is the most late
+			ememory::SharedPtr<audio::river::io::NodeClock> next;
+			audio::Time nextTime;
+			for (auto &it : listNode) {
+				if (    it->isRunning() == false
+				     || it->isManualClock() == false) {
+					continue;
+				}
+				audio::Time time = it->getClockTime();
+				if (time >= endTime) {
+					continue;
+				}
+				if (    next == null
+				     || time < nextTime) {
+					next = it;
+					nextTime = time;
+				}
+			}
+			if (next == null) {
+				break;
+			}
+			next->step(1);
+		}
+		ethread::UniqueLock lock(m_mutexOffline);
+		m_offlineTime = endTime;
+		return true;
+	#else
+		RIVER_ERROR("Offline mode is not availlable (need the virtual node)");
+		return false;
+	#endif
+}
+
+ememory::SharedPtr<audio::drain::VolumeElement> audio::river::io::Manager::getVolumeGroup(const etk::String& _name) {
+	// Dedicated lock: the hardware nodes of a group are created in parallel and request their volume.
+	ethread::UniqueLock lock(m_mutexNodeCreation);
 	if (_name == "") {
 		RIVER_ERROR("Try to create an audio group with no name ...");
 		return ememory::SharedPtr<audio::drain::VolumeElement>();
@@ -16,7 +16,13 @@
 #include <ejson/ejson.hpp>
 #include <audio/drain/Volume.hpp>
 #include <audio/river/io/Group.hpp>
+#include <audio/river/io/DeviceCache.hpp>
+#include <audio/river/io/PeriodAdapter.hpp>
 #include <ethread/MutexRecursive.hpp>
+#include <ethread/Thread.hpp>
+#include <ethread/Semaphore.hpp>
+#include <audio/Time.hpp>
+#include <atomic>
 
 namespace audio {
 	namespace river {
@@ -29,6 +35,7 @@ namespace audio {
 			class Manager : public ememory::EnableSharedFromThis<Manager> {
 				private:
 					mutable ethread::MutexRecursive m_mutex; //!< prevent multiple access
+					mutable ethread::Mutex m_mutexNodeCreation; //!< protect the data requested by the node constructor (can be called in parallel when a group is created)
 				private:
 					/**
 					 * @brief Constructor
@@ -50,10 +57,45 @@ namespace audio {
 					 * @param[in] _data json configuration string.
 					 */
 					void initString(const etk::String& _data);
+					/**
+					 * @brief Called by audio::river::reload() to change the hardware configuration without stopping the running flows.
+					 * @note Only the nodes that change are re-created, the interfaces connected on them are migrated on the new node (the flow is stopped during the re-creation).
+					 * @note The removed nodes are destroyed when the last interface connected on it is closed.
+					 * @param[in] _uri Uri file to load.
+					 * @return true The new configuration is applied.
+					 * @return false An error occured (the previous configuration is kept).
+					 */
+					bool reload(const etk::Uri& _uri);
+					/**
+					 * @brief Called by audio::river::reloadString() to change the hardware configuration without stopping the running flows.
+					 * @param[in] _data json configuration string.
+					 * @return true The new configuration is applied.
+					 * @return false An error occured (the previous configuration is kept).
+					 */
+					bool reloadString(const etk::String& _data);
 					/**
 					 * @brief Called by audio::river::inInit() to uninitialize all the low level interface.
 					 */
 					void unInit();
+				private:
+					bool m_portAudioInit; //!< The portaudio backend has been initialized.
+				public:
+					/**
+					 * @brief Initialize the portaudio backend (done only when the first node that use it is created).
+					 * @return true The backend is ready to use.
+					 * @return false An error occured.
+					 */
+					bool initPortAudio();
+				private:
+					audio::river::io::DeviceCache m_deviceCache; //!< Cache of the device capability (avoid probing at each start)
+				public:
+					/**
+					 * @brief Get the device capability cache.
+					 * @return Reference on the cache.
+					 */
+					audio::river::io::DeviceCache& getDeviceCache() {
+						return m_deviceCache;
+					}
 				private:
 					ejson::Document m_config; //!< harware configuration
 					etk::Vector<ememory::SharedPtr<audio::river::io::Node> > m_listKeepAlive; //!< list of all Node that might be keep alive sone/all time
@@ -65,6 +107,135 @@ namespace audio {
 					 * @return Pointer on the noe or a null if the node does not exist in the file or an error occured.
 					 */
 					ememory::SharedPtr<audio::river::io::Node> getNode(const etk::String& _name);
+				private:
+					/**
+					 * @brief Get a node with his name only if it is already created.
+					 * @param[in] _name Name of the node
+					 * @return Pointer on the node or a null if the node is not created.
+					 */
+					ememory::SharedPtr<audio::river::io::Node> getCreatedNode(const etk::String& _name);
+					/**
+					 * @brief Get the machine string of all the node described in the current configuration.
+					 * @return Map of the node name and his configuration.
+					 */
+					etk::Map<etk::String, etk::String> getConfigSnapshot();
+					/**
+					 * @brief Apply the difference between the previous configuration and the current one (called with m_mutex locked).
+					 * The old nodes are stopped and their streams released before the new nodes are opened.
+					 * If a new node can not be opened, the old nodes and the previous configuration are restored.
+					 * @param[in] _previous Snapshot of the previous configuration.
+					 * @param[in] _previousConfig Machine string of the previous configuration (restored on error).
+					 * @param[out] _listReplaced Old nodes to migrate.
+					 * @param[out] _listNewNode New nodes (same order).
+					 * @return true The new configuration is applied.
+					 */
+					bool applyReload(const etk::Map<etk::String, etk::String>& _previous,
+					                 const etk::String& _previousConfig,
+					                 etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listReplaced,
+					                 etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listNewNode);
+					/**
+					 * @brief Migrate the interfaces and the loopback inputs of the old nodes on the new ones.
+					 * @note Called without m_mutex: the interfaces are locked before the manager when they start (same lock order).
+					 * @param[in] _listOld Old nodes.
+					 * @param[in] _listNew New nodes (same order).
+					 */
+					void migrateNodes(const etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listOld,
+					                  const etk::Vector<ememory::SharedPtr<audio::river::io::Node> >& _listNew);
+					ethread::MutexRecursive m_mutexReload; //!< serialize the reloads (taken before m_mutex and kept during the migration)
+				private:
+					ethread::Mutex m_mutexPeriod; //!< protect the period thread
+					etk::Map<etk::String, ememory::SharedPtr<std::atomic<uint32_t> > > m_listPeriodSlot; //!< New nb-chunk requested by each node, 0 if none (the map is protected by m_mutexNodeCreation, the slots are written in the audio thread)
+					ememory::SharedPtr<ethread::Thread> m_periodThread; //!< Thread that re-create the nodes with the new period and deliver the status of the interfaces
+					ethread::Semaphore m_periodSemaphore; //!< Wake up of the period thread
+					std::atomic<bool> m_periodThreadAlive; //!< The period thread is running
+					/**
+					 * @brief Period thread: poll the period slots of the nodes and apply the nb-chunk requests, deliver the status of the interfaces (every 100 ms).
+					 */
+					void periodThreadCallback();
+					/**
+					 * @brief Stop the period thread (must be called without m_mutex locked).
+					 */
+					void stopPeriodThread();
+					/**
+					 * @brief Deliver the status raised in the audio thread (xrun) to the status callback of the interfaces.
+					 */
+					void deliverStatus();
+				public:
+					/**
+					 * @brief Start the thread that apply the period requests and deliver the status of the interfaces
+					 * (called by the nodes that can change their period and by the interfaces that have a status callback).
+					 */
+					void startPeriodThread();
+					/**
+					 * @brief Get the period slot of a node (created at the first call, kept when the node is re-created).
+					 * The node write a new nb-chunk in it (no lock, no allocation: can be done in the audio thread), the period
+					 * thread poll the slots every 100 ms, change the configuration of the node and re-create it (the interfaces are
+					 * migrated on the new node, as a reload of the configuration).
+					 * @param[in] _name Name of the node.
+					 * @return Slot of the node.
+					 */
+					ememory::SharedPtr<std::atomic<uint32_t> > getPeriodSlot(const etk::String& _name);
+					/**
+					 * @brief Check if the period thread is running (the requests of period are applied).
+					 * @note Can be called in the audio thread.
+					 * @return true The thread is running.
+					 */
+					bool isPeriodThreadAlive() const {
+						return m_periodThreadAlive;
+					}
+					/**
+					 * @brief Get the number of xrun of a node.
+					 * @param[in] _name Name of the node.
+					 * @param[out] _underflow Number of underflow.
+					 * @param[out] _overflow Number of overflow.
+					 * @return true The node exist.
+					 */
+					bool getXrun(const etk::String& _name, uint32_t& _underflow, uint32_t& _overflow);
+				private:
+					etk::Map<etk::String, ememory::SharedPtr<audio::river::io::PeriodAdapter> > m_listPeriodAdapter; //!< Period adapter of the nodes (kept when a node is re-created) (protected by m_mutexNodeCreation)
+				public:
+					/**
+					 * @brief Get the period adapter of a node (created at the first call).
+					 * @param[in] _name Name of the node.
+					 * @return Adapter that keep the history of the node.
+					 */
+					ememory::SharedPtr<audio::river::io::PeriodAdapter> getPeriodAdapter(const etk::String& _name);
+				private:
+					/**
+					 * @brief Cancel the pending period request of the adapter of a node (the node is not re-created).
+					 * @param[in] _name Name of the node.
+					 */
+					void cancelPeriodRequest(const etk::String& _name);
+				private:
+					bool m_offline; //!< Offline rendering mode (no hardware, no real time) (changed with m_mutex and m_mutexOffline locked).
+					mutable ethread::Mutex m_mutexOffline; //!< protect the offline mode and master clock (read by the nodes when they start).
+					audio::Time m_offlineTime; //!< Current time of the offline master clock.
+				public:
+					/**
+					 * @brief Select the offline rendering mode: the hardware nodes are replaced by virtual nodes and all the clocked nodes (virtual, file) are driven by renderOffline() without any wait.
+					 * @note Must be set before the first node is created.
+					 * @param[in] _offline true to render offline.
+					 * @return true The mode is changed.
+					 */
+					bool setOfflineMode(bool _offline);
+					/**
+					 * @brief Check if the offline rendering mode is enable.
+					 * @return true The flows are driven by renderOffline().
+					 */
+					bool isOffline() const;
+					/**
+					 * @brief Get the current time of the offline master clock.
+					 * @return Time of the next sample to render.
+					 */
+					audio::Time getOfflineTime() const;
+					/**
+					 * @brief Render a duration of all the started flows as fast as possible.
+					 * The node that is the most late is processed first (at the same time the outputs are processed before the inputs to generate the feedback and the loopback), then the timestamps are sample accurate.
+					 * @param[in] _duration Duration to render.
+					 * @return true The duration has been rendered.
+					 * @return false The offline mode is not enable.
+					 */
+					bool renderOffline(const audio::Duration& _duration);
 				private:
 					etk::Vector<ememory::SharedPtr<audio::drain::VolumeElement> > m_volumeGroup; //!< List of All global volume in the Low level interface.
 				public:
@@ -9,10 +9,24 @@
 
 audio::river::io::Node::Node(const etk::String& _name, const ejson::Object& _config) :
   m_config(_config),
+  m_suspended(false),
   m_name(_name),
-  m_isInput(false) {
+  m_isInput(false),
+  m_threadPolicyApplied(false),
+  m_latencyNbChunkMin(0),
+  m_latencyNbChunkMax(0),
+  m_xrunUnderflow(0),
+  m_xrunOverflow(0),
+  m_xrunReset(true),
+  m_xrunGrowNbChunk(0),
+  m_xrunGrowCount(0) {
+	static ethread::Mutex mutexUid;
 	static uint32_t uid=0;
-	m_uid = uid++;
+	{
+		// node can be created in parallel (group creation)
+		ethread::UniqueLock lock(mutexUid);
+		m_uid = uid++;
+	}
 	RIVER_INFO("-----------------------------------------------------------------");
 	RIVER_INFO("--                       CREATE NODE                           --");
 	RIVER_INFO("-----------------------------------------------------------------");
@@ -34,6 +48,9 @@ audio::river::io::Node::Node(const etk::String& _name, const ejson::Object& _con
 	RIVER_INFO("interfaceType=" << interfaceType);
 	if (    interfaceType == "input"
 	     || interfaceType == "PAinput"
+	     || interfaceType == "file-input"
+	     || interfaceType == "virtual-input"
+	     || interfaceType == "shm-input"
 	     || interfaceType == "aec"
 	     || interfaceType == "muxer") {
 		m_isInput = true;
@@ -98,6 +115,52 @@ audio::river::io::Node::Node(const etk::String& _name, const ejson::Object& _con
 		m_process.setOutputConfig(hardwareFormat);
 		m_process.setInputConfig(interfaceFormat);
 	}
+	// Scheduling of the callback thread:
+	int64_t periodNs = int64_t(m_config["nb-chunk"].toNumber().get(1024))*1000000000LL/int64_t(frequency<=0?48000:frequency);
+	m_threadPolicy.configure(m_config, periodNs);
+	/**
+		xrun:{ # (optionnal) policy when the backend report an underflow or an overflow
+			reset:true, # reset the flows of the interfaces (history of the algo, synchronizer of the aec and muxer)
+			grow-nb-chunk:4096, # double the nb-chunk (up to this value) when 3 xrun happen in 10 seconds
+		},
+	*/
+	// Adaptation of the period (the adapter is kept by the manager when the node is re-created):
+	if (m_config["nb-chunk-adaptive"].toObject().exist() == true) {
+		m_periodAdapter = audio::river::io::Manager::getInstance()->getPeriodAdapter(m_name);
+		m_periodAdapter->configure(m_config, m_config["nb-chunk"].toNumber().get(1024));
+	}
+	/**
+		nb-chunk-latency:{ # (optionnal) the nb-chunk follow the smallest latency requested by the running interfaces
+			min:128, # smallest nb-chunk (limit of the device)
+			max:1024, # nb-chunk when no interface request a latency
+		},
+	*/
+	const ejson::Object latencyObject = m_config["nb-chunk-latency"].toObject();
+	if (latencyObject.exist() == true) {
+		// all the periods of the negotiation are powers of 2: "min" is rounded up (limit of the device), "max" is rounded down
+		uint32_t nbChunkMin = etk::max(int32_t(latencyObject["min"].toNumber().get(128)), 16);
+		m_latencyNbChunkMin = 16;
+		while (m_latencyNbChunkMin < nbChunkMin) {
+			m_latencyNbChunkMin *= 2;
+		}
+		uint32_t nbChunkMax = latencyObject["max"].toNumber().get(1024);
+		m_latencyNbChunkMax = m_latencyNbChunkMin;
+		while (m_latencyNbChunkMax*2 <= nbChunkMax) {
+			m_latencyNbChunkMax *= 2;
+		}
+	}
+	const ejson::Object xrunObject = m_config["xrun"].toObject();
+	if (xrunObject.exist() == true) {
+		m_xrunReset = xrunObject["reset"].toBoolean().get(true);
+		m_xrunGrowNbChunk = xrunObject["grow-nb-chunk"].toNumber().get(0);
+	}
+	if (    m_periodAdapter != null
+	     || m_latencyNbChunkMin != 0
+	     || m_xrunGrowNbChunk != 0) {
+		// the period can change: the request is written in a slot allocated here (no allocation in the audio thread)
+		m_periodSlot = audio::river::io::Manager::getInstance()->getPeriodSlot(m_name);
+		audio::river::io::Manager::getInstance()->startPeriodThread();
+	}
 	//m_process.updateInterAlgo();
 }
 
@@ -105,6 +168,10 @@ audio::river::io::Node::~Node() {
 	RIVER_INFO("-----------------------------------------------------------------");
 	RIVER_INFO("--                      DESTROY NODE                           --");
 	RIVER_INFO("-----------------------------------------------------------------");
+	if (    m_xrunUnderflow != 0
+	     || m_xrunOverflow != 0) {
+		RIVER_WARNING("Node '" << m_name << "' xrun: underflow=" << m_xrunUnderflow << " overflow=" << m_xrunOverflow);
+	}
 };
 
 size_t audio::river::io::Node::getNumberOfInterface(enum audio::river::modeInterface _interfaceType) {
@@ -155,6 +222,7 @@ void audio::river::io::Node::interfaceAdd(const ememory::SharedPtr<audio::river:
 		}
 		RIVER_INFO("ADD interface for stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
 		m_list.pushBack(_interface);
+		updateLatency();
 	}
 	if (m_list.size() == 1) {
 		startInGroup();
@@ -171,12 +239,155 @@ void audio::river::io::Node::interfaceRemove(const ememory::SharedPtr<audio::riv
 				break;
 			}
 		}
+		updateLatency();
 	}
 	if (m_list.size() == 0) {
 		stopInGroup();
 	}
 }
 
+void audio::river::io::Node::updateLatency() {
+	if (    m_latencyNbChunkMin == 0
+	     || m_suspended == true
+	     || m_list.size() == 0) {
+		// no interface: the node keep its period until the next start (no re-creation when a stream stop)
+		return;
+	}
+	uint32_t latency = 0;
+	for (size_t iii=0; iii<m_list.size(); ++iii) {
+		if (    m_list[iii] != null
+		     && m_list[iii]->getLatency() != 0) {
+			if (    latency == 0
+			     || m_list[iii]->getLatency() < latency) {
+				latency = m_list[iii]->getLatency();
+			}
+		}
+	}
+	uint32_t nbChunk = m_latencyNbChunkMax;
+	if (latency != 0) {
+		// biggest power of 2 (not lower than the minimum) with a period lower than the latency
+		uint64_t latencyChunk = uint64_t(latency)*uint64_t(getHarwareFormat().getFrequency())/1000000LL;
+		nbChunk = m_latencyNbChunkMin;
+		while (    nbChunk*2 <= latencyChunk
+		        && nbChunk*2 <= m_latencyNbChunkMax) {
+			nbChunk *= 2;
+		}
+	}
+	uint32_t currentNbChunk = m_config["nb-chunk"].toNumber().get(1024);
+	if (nbChunk == currentNbChunk) {
+		return;
+	}
+	// hysteresis: a smaller period is applied at once (the latency is needed), a bigger one only when it is at least
+	// 4 times the current one (a too small period only cost some wakeup: no re-creation at each start/stop of a stream)
+	if (    nbChunk > currentNbChunk
+	     && nbChunk < currentNbChunk*4) {
+		return;
+	}
+	RIVER_INFO("Node '" << m_name << "' smallest latency requested: " << latency << " us ==> nb-chunk=" << nbChunk);
+	// the node is re-created with the new period (the interfaces are migrated)
+	requestPeriod(nbChunk);
+}
+
+void audio::river::io::Node::migrateInterface(const ememory::SharedPtr<audio::river::io::Node>& _node) {
+	if (    _node == null
+	     || _node.get() == this) {
+		return;
+	}
+	if (_node->isInput() != isInput()) {
+		RIVER_ERROR("Can not migrate interface of '" << m_name << "' the new node has not the same direction");
+		return;
+	}
+	RIVER_INFO("Migrate interfaces of '" << m_name << "' on the new node");
+	etk::Vector<ememory::WeakPtr<audio::river::io::Node> > listLoopback;
+	{
+		// the node is replaced: the remove of the interfaces must not request a new period
+		ethread::UniqueLock lock(m_mutex);
+		m_latencyNbChunkMin = 0;
+		listLoopback = m_loopbackList;
+		m_loopbackList.clear();
+	}
+	// the loopback inputs are connected before the start of the new output (no period lost)
+	for (auto &it : listLoopback) {
+		ememory::SharedPtr<audio::river::io::Node> element = it.lock();
+		if (element != null) {
+			element->loopbackChangeSource(_node);
+		}
+	}
+	etk::Vector<ememory::WeakPtr<audio::river::Interface> > listAvaillable = m_listAvaillable;
+	for (auto &it : listAvaillable) {
+		ememory::SharedPtr<audio::river::Interface> element = it.lock();
+		if (element == null) {
+			continue;
+		}
+		bool isRunning = false;
+		bool isSuspended = false;
+		{
+			ethread::UniqueLock lock(m_mutex);
+			isRunning = etk::isIn(element, m_list);
+			isSuspended = etk::isIn(element, m_listSuspended);
+		}
+		if (isRunning == true) {
+			interfaceRemove(element);
+		}
+		if (element->systemChangeNode(_node) == false) {
+			RIVER_ERROR("    Can not migrate interface: '" << element->getName() << "'");
+			continue;
+		}
+		if (    isRunning == true
+		     || isSuspended == true) {
+			_node->interfaceAdd(element);
+		}
+	}
+	m_listAvaillable.clear();
+	m_listSuspended.clear();
+}
+
+void audio::river::io::Node::suspend() {
+	if (m_suspended == true) {
+		return;
+	}
+	RIVER_INFO("Suspend '" << m_name << "'");
+	etk::Vector<ememory::SharedPtr<audio::river::Interface> > list;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		// the remove of the interfaces must not request a new period
+		m_suspended = true;
+		list = m_list;
+	}
+	// the last remove stop the stream
+	for (auto &it : list) {
+		interfaceRemove(it);
+	}
+	m_listSuspended = list;
+	streamRelease();
+}
+
+bool audio::river::io::Node::resume() {
+	if (m_suspended == false) {
+		return true;
+	}
+	RIVER_INFO("Resume '" << m_name << "'");
+	if (m_periodAdapter != null) {
+		// the new node has configured the adapter with its period: restore the one of this node (the stream is not running)
+		m_periodAdapter->configure(m_config, m_config["nb-chunk"].toNumber().get(1024));
+	}
+	bool ret = streamRestore();
+	if (ret == false) {
+		RIVER_ERROR("Can not re-open the stream of '" << m_name << "' ==> the interfaces stay stopped");
+	}
+	{
+		ethread::UniqueLock lock(m_mutex);
+		m_suspended = false;
+	}
+	etk::Vector<ememory::SharedPtr<audio::river::Interface> > list = m_listSuspended;
+	m_listSuspended.clear();
+	if (ret == true) {
+		for (auto &it : list) {
+			interfaceAdd(it);
+		}
+	}
+	return ret;
+}
 
 void audio::river::io::Node::volumeChange() {
 	for (size_t iii=0; iii< m_listAvaillable.size(); ++iii) {
@@ -187,6 +398,98 @@ void audio::river::io::Node::volumeChange() {
 	}
 }
 
+void audio::river::io::Node::xrun(bool _underflow, const audio::Time& _time) {
+	if (_underflow == true) {
+		m_xrunUnderflow++;
+	} else {
+		m_xrunOverflow++;
+	}
+	// called in the audio thread: the counters are logged when the node is destroyed
+	RIVER_VERBOSE("Node '" << m_name << "' " << (_underflow==true?"underflow":"overflow") << " underflow=" << m_xrunUnderflow << " overflow=" << m_xrunOverflow);
+	if (m_xrunReset == true) {
+		for (size_t iii=0; iii< m_list.size(); ++iii) {
+			if (m_list[iii] != null) {
+				m_list[iii]->systemXrun(_underflow);
+			}
+		}
+	}
+	if (m_periodAdapter != null) {
+		uint32_t nbChunk = m_periodAdapter->xrun();
+		if (    nbChunk != 0
+		     && requestPeriod(nbChunk) == false) {
+			m_periodAdapter->cancelRequest();
+		}
+		return;
+	}
+	if (m_xrunGrowNbChunk == 0) {
+		return;
+	}
+	if (    m_xrunGrowCount == 0
+	     || _time - m_xrunGrowTime > audio::Duration(10, 0)) {
+		m_xrunGrowTime = _time;
+		m_xrunGrowCount = 0;
+	}
+	m_xrunGrowCount++;
+	if (m_xrunGrowCount < 3) {
+		return;
+	}
+	uint32_t nbChunk = m_config["nb-chunk"].toNumber().get(1024);
+	if (nbChunk < m_xrunGrowNbChunk) {
+		// the node is re-created with the new period (not in the audio thread)
+		requestPeriod(etk::min(nbChunk*2, m_xrunGrowNbChunk));
+	}
+	// one request by node (the node will be replaced)
+	m_xrunGrowNbChunk = 0;
+}
+
+void audio::river::io::Node::processStop(uint32_t _nbChunk) {
+	if (m_periodAdapter == null) {
+		return;
+	}
+	uint32_t nbChunk = m_periodAdapter->processStop(_nbChunk, getHarwareFormat().getFrequency());
+	if (nbChunk != 0) {
+		// the node is re-created with the new period (not in the audio thread)
+		if (requestPeriod(nbChunk) == false) {
+			m_periodAdapter->cancelRequest();
+		}
+	}
+}
+
+bool audio::river::io::Node::requestPeriod(uint32_t _nbChunk) {
+	// no lock, no allocation: the period thread poll the slot
+	if (    m_periodSlot == null
+	     || audio::river::io::Manager::getInstance()->isPeriodThreadAlive() == false) {
+		return false;
+	}
+	m_periodSlot->store(_nbChunk);
+	return true;
+}
+
+void audio::river::io::Node::deliverStatus() {
+	etk::Vector<ememory::SharedPtr<audio::river::Interface> > list;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		list = m_list;
+	}
+	for (auto &it : list) {
+		if (it != null) {
+			it->systemDeliverStatus();
+		}
+	}
+}
+
+void audio::river::io::Node::getXrun(uint32_t& _underflow, uint32_t& _overflow) {
+	ethread::UniqueLock lock(m_mutex);
+	_underflow = m_xrunUnderflow;
+	_overflow = m_xrunOverflow;
+}
+
+void audio::river::io::Node::resetXrun() {
+	ethread::UniqueLock lock(m_mutex);
+	m_xrunUnderflow = 0;
+	m_xrunOverflow = 0;
+}
+
 void audio::river::io::Node::newInput(const void* _inputBuffer,
                                       uint32_t _nbChunk,
                                       const audio::Time& _time) {
@@ -207,6 +510,39 @@ void audio::river::io::Node::newInput(const void* _inputBuffer,
 	return;
 }
 
+template<typename TYPE> void audio::river::io::Node::mixOutput(void* _outputBuffer,
+                                                                uint32_t _nbChunk,
+                                                                const audio::Time& _time) {
+	size_t nbChannel = m_process.getInputConfig().getMap().size();
+	etk::Vector<TYPE> output;
+	RIVER_VERBOSE("resize=" << _nbChunk*nbChannel);
+	output.resize(_nbChunk*nbChannel, 0);
+	etk::Vector<TYPE> outputTmp;
+	outputTmp.resize(_nbChunk*nbChannel, 0);
+	for (size_t iii=0; iii< m_list.size(); ++iii) {
+		if (m_list[iii] == null) {
+			continue;
+		}
+		if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
+			continue;
+		}
+		RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
+		RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
+		if (m_list[iii]->systemNeedOutputData(_time, &outputTmp[0], _nbChunk, sizeof(TYPE)*nbChannel) == false) {
+			// muted (data dropped), drained or full zero: nothing to mix
+			continue;
+		}
+		RIVER_VERBOSE("        Mix it ...");
+		// Add data to the output tmp buffer:
+		for (size_t kkk=0; kkk<output.size(); ++kkk) {
+			output[kkk] += outputTmp[kkk];
+		}
+		// TODO : if a signal is upper than the headroom of the muxer format (256* for int8_on_int16 ...) it can create a real problem ...
+	}
+	RIVER_VERBOSE("    End stack process data ...");
+	m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+}
+
 void audio::river::io::Node::newOutput(void* _outputBuffer,
                                        uint32_t _nbChunk,
                                        const audio::Time& _time) {
@@ -214,163 +550,17 @@ void audio::river::io::Node::newOutput(void* _outputBuffer,
 		return;
 	}
 	enum audio::format muxerFormatType = m_process.getInputConfig().getFormat();
-	etk::Vector<uint8_t> outputTmp2;
-	uint32_t nbByteTmpBuffer = audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size()*_nbChunk;
-	RIVER_VERBOSE("resize=" << nbByteTmpBuffer);
-	outputTmp2.resize(nbByteTmpBuffer);
-	
 	if (muxerFormatType == audio::format_int8_on_int16) {
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		//            process 16 bits
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		// $$$$ change the int16
-		etk::Vector<int16_t> output;
-		RIVER_VERBOSE("resize=" << _nbChunk*m_process.getInputConfig().getMap().size());
-		output.resize(_nbChunk*m_process.getInputConfig().getMap().size(), 0);
-		// $$$$ change the int16
-		const int16_t* outputTmp = null;
-		for (size_t iii=0; iii< m_list.size(); ++iii) {
-			if (m_list[iii] == null) {
-				continue;
-			}
-			if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
-				continue;
-			}
-			RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
-			// clear datas ...
-			memset(&outputTmp2[0], 0, nbByteTmpBuffer);
-			RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
-			m_list[iii]->systemNeedOutputData(_time, &outputTmp2[0], _nbChunk, audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size());
-			// $$$$ change the int16
-			outputTmp = reinterpret_cast<const int16_t*>(&outputTmp2[0]);
-			RIVER_VERBOSE("        Mix it ...");
-			// Add data to the output tmp buffer:
-			for (size_t kkk=0; kkk<output.size(); ++kkk) {
-				output[kkk] += outputTmp[kkk];
-			}
-			// TODO : if a signal is upper than 256* the maximum of 1 it can create a real problem ...
-		}
-		RIVER_VERBOSE("    End stack process data ...");
-		m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+		mixOutput<int16_t>(_outputBuffer, _nbChunk, _time);
 	} else if (    muxerFormatType == audio::format_int16_on_int32
 	            || muxerFormatType == audio::format_int24_on_int32) {
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		//            process 32 bits
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		etk::Vector<int32_t> output;
-		RIVER_VERBOSE("resize=" << _nbChunk*m_process.getInputConfig().getMap().size());
-		output.resize(_nbChunk*m_process.getInputConfig().getMap().size(), 0);
-		const int32_t* outputTmp = null;
-		for (size_t iii=0; iii< m_list.size(); ++iii) {
-			if (m_list[iii] == null) {
-				continue;
-			}
-			if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
-				continue;
-			}
-			RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
-			// clear datas ...
-			memset(&outputTmp2[0], 0, nbByteTmpBuffer);
-			RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
-			m_list[iii]->systemNeedOutputData(_time, &outputTmp2[0], _nbChunk, audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size());
-			outputTmp = reinterpret_cast<const int32_t*>(&outputTmp2[0]);
-			RIVER_VERBOSE("        Mix it ...");
-			// Add data to the output tmp buffer:
-			for (size_t kkk=0; kkk<output.size(); ++kkk) {
-				output[kkk] += outputTmp[kkk];
-			}
-			// TODO : if a signal is upper than 256* (for 24 bits) or 65335* (for 16 bits) the maximum of 1 it can create a real problem ...
-		}
-		RIVER_VERBOSE("    End stack process data ...");
-		m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+		mixOutput<int32_t>(_outputBuffer, _nbChunk, _time);
 	} else if (muxerFormatType == audio::format_int32_on_int64) {
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		//            process 64 bits
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		etk::Vector<int64_t> output;
-		RIVER_VERBOSE("resize=" << _nbChunk*m_process.getInputConfig().getMap().size());
-		output.resize(_nbChunk*m_process.getInputConfig().getMap().size(), 0);
-		const int64_t* outputTmp = null;
-		for (size_t iii=0; iii< m_list.size(); ++iii) {
-			if (m_list[iii] == null) {
-				continue;
-			}
-			if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
-				continue;
-			}
-			RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
-			// clear datas ...
-			memset(&outputTmp2[0], 0, nbByteTmpBuffer);
-			RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
-			m_list[iii]->systemNeedOutputData(_time, &outputTmp2[0], _nbChunk, audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size());
-			outputTmp = reinterpret_cast<const int64_t*>(&outputTmp2[0]);
-			RIVER_VERBOSE("        Mix it ...");
-			// Add data to the output tmp buffer:
-			for (size_t kkk=0; kkk<output.size(); ++kkk) {
-				output[kkk] += outputTmp[kkk];
-			}
-			// TODO : if a signal is upper than 2000000000* the maximum of 1 it can create a real problem ...
-		}
-		RIVER_VERBOSE("    End stack process data ...");
-		m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+		mixOutput<int64_t>(_outputBuffer, _nbChunk, _time);
 	} else if (muxerFormatType == audio::format_float) {
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		//            process 32 bits FLOAT
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		etk::Vector<float> output;
-		RIVER_VERBOSE("resize=" << _nbChunk*m_process.getInputConfig().getMap().size());
-		output.resize(_nbChunk*m_process.getInputConfig().getMap().size(), 0);
-		const float* outputTmp = null;
-		for (size_t iii=0; iii< m_list.size(); ++iii) {
-			if (m_list[iii] == null) {
-				continue;
-			}
-			if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
-				continue;
-			}
-			RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
-			// clear datas ...
-			memset(&outputTmp2[0], 0, nbByteTmpBuffer);
-			RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
-			m_list[iii]->systemNeedOutputData(_time, &outputTmp2[0], _nbChunk, audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size());
-			outputTmp = reinterpret_cast<const float*>(&outputTmp2[0]);
-			RIVER_VERBOSE("        Mix it ...");
-			// Add data to the output tmp buffer:
-			for (size_t kkk=0; kkk<output.size(); ++kkk) {
-				output[kkk] += outputTmp[kkk];
-			}
-		}
-		RIVER_VERBOSE("    End stack process data ...");
-		m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+		mixOutput<float>(_outputBuffer, _nbChunk, _time);
 	} else if (muxerFormatType == audio::format_double) {
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		//            process 64 bits FLOAT
-		//////////////////////////////////////////////////////////////////////////////////////////////////
-		etk::Vector<double> output;
-		RIVER_VERBOSE("resize=" << _nbChunk*m_process.getInputConfig().getMap().size());
-		output.resize(_nbChunk*m_process.getInputConfig().getMap().size(), 0);
-		const double* outputTmp = null;
-		for (size_t iii=0; iii< m_list.size(); ++iii) {
-			if (m_list[iii] == null) {
-				continue;
-			}
-			if (m_list[iii]->getMode() != audio::river::modeInterface_output) {
-				continue;
-			}
-			RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " " << iii);
-			// clear datas ...
-			memset(&outputTmp2[0], 0, nbByteTmpBuffer);
-			RIVER_VERBOSE("        request Data="<< _nbChunk << " time=" << _time);
-			m_list[iii]->systemNeedOutputData(_time, &outputTmp2[0], _nbChunk, audio::getFormatBytes(muxerFormatType)*m_process.getInputConfig().getMap().size());
-			outputTmp = reinterpret_cast<const double*>(&outputTmp2[0]);
-			RIVER_VERBOSE("        Mix it ...");
-			// Add data to the output tmp buffer:
-			for (size_t kkk=0; kkk<output.size(); ++kkk) {
-				output[kkk] += outputTmp[kkk];
-			}
-		}
-		RIVER_VERBOSE("    End stack process data ...");
-		m_process.processIn(&output[0], _nbChunk, _outputBuffer, _nbChunk);
+		mixOutput<double>(_outputBuffer, _nbChunk, _time);
 	} else {
 		RIVER_ERROR("Wrong demuxer type: " << muxerFormatType);
 		return;
@@ -387,10 +577,52 @@ void audio::river::io::Node::newOutput(void* _outputBuffer,
 		RIVER_VERBOSE("    IO name="<< m_list[iii]->getName() << " (feedback) time=" << _time);
 		m_list[iii]->systemNewInputData(_time, _outputBuffer, _nbChunk);
 	}
+	// The loopback inputs share the same block (no copy): they are processed in this thread, with the lock of this node
+	for (auto &it : m_loopbackList) {
+		ememory::SharedPtr<audio::river::io::Node> element = it.lock();
+		if (element != null) {
+			element->loopbackInput(_outputBuffer, _nbChunk, _time);
+		}
+	}
 	RIVER_VERBOSE("data Output size request :" << _nbChunk << " [ END ]");
 	return;
 }
 
+bool audio::river::io::Node::loopbackAdd(const ememory::SharedPtr<audio::river::io::Node>& _node) {
+	if (_node == null) {
+		return false;
+	}
+	ethread::UniqueLock lock(m_mutex);
+	if (m_isInput == true) {
+		RIVER_ERROR("Can not loopback '" << _node->getName() << "' on the input '" << m_name << "'");
+		return false;
+	}
+	const audio::drain::IOFormatInterface& format = getHarwareFormat();
+	const audio::drain::IOFormatInterface& formatLoopback = _node->getHarwareFormat();
+	if (    format.getFormat() != formatLoopback.getFormat()
+	     || format.getFrequency() != formatLoopback.getFrequency()
+	     || format.getMap().size() != formatLoopback.getMap().size()) {
+		RIVER_ERROR("Can not loopback '" << m_name << "' " << format << " on '" << _node->getName() << "' " << formatLoopback << " ==> the hardware format must be the same");
+		return false;
+	}
+	m_loopbackList.pushBack(_node);
+	return true;
+}
+
+void audio::river::io::Node::loopbackRemove(const ememory::SharedPtr<audio::river::io::Node>& _node) {
+	ethread::UniqueLock lock(m_mutex);
+	auto it = m_loopbackList.begin();
+	while (it != m_loopbackList.end()) {
+		ememory::SharedPtr<audio::river::io::Node> element = it->lock();
+		if (    element == null
+		     || element == _node) {
+			it = m_loopbackList.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
 static void link(ememory::SharedPtr<etk::io::Interface>& _io, const etk::String& _first, const etk::String& _op, const etk::String& _second) {
 	if (_op == "->") {
 		*_io << "			" << _first << " -> " << _second << ";\n";
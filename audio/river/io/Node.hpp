@@ -15,6 +15,8 @@
 #include <audio/river/Interface.hpp>
 #include <audio/drain/IOFormatInterface.hpp>
 #include <audio/drain/Volume.hpp>
+#include <audio/river/io/ThreadPolicy.hpp>
+#include <audio/river/io/PeriodAdapter.hpp>
 #include <etk/io/Interface.hpp>
 
 namespace audio {
@@ -78,11 +80,20 @@ namespace audio {
 							return m_process.getOutputConfig();
 						}
 					}
+					/**
+					 * @brief Get the configured period of the node (the backend can give an other number of chunk in its callback).
+					 * @return Number of chunk of a period.
+					 */
+					uint32_t getNbChunk() {
+						return m_config["nb-chunk"].toNumber().get(1024);
+					}
 				protected:
 					ememory::SharedPtr<audio::drain::VolumeElement> m_volume; //!< if a volume is set it is set here ... for hardware interface only.
 				protected:
 					etk::Vector<ememory::WeakPtr<audio::river::Interface> > m_listAvaillable; //!< List of all interface that exist on this Node
 					etk::Vector<ememory::SharedPtr<audio::river::Interface> > m_list; //!< List of all connected interface at this node.
+					etk::Vector<ememory::SharedPtr<audio::river::Interface> > m_listSuspended; //!< Interfaces stopped by @ref suspend (restarted by @ref resume or on the new node by @ref migrateInterface).
+					bool m_suspended; //!< The node is suspended: its stream is released and the period is not negotiated.
 					/**
 					 * @brief Get the number of interface with a specific type.
 					 * @param[in] _interfaceType Type of the interface.
@@ -120,6 +131,42 @@ namespace audio {
 					 * @param[in] _interface Pointer on the interface to register.
 					 */
 					void interfaceRemove(const ememory::SharedPtr<audio::river::Interface>& _interface);
+					/**
+					 * @brief Move all the interfaces registered on this node on an other node (used when the configuration is reloaded).
+					 * @note The running (or suspended) interfaces are stopped on this node and started on the new one, the loopback inputs follow the new node.
+					 * @param[in] _node New node to connect the interfaces.
+					 */
+					void migrateInterface(const ememory::SharedPtr<audio::river::io::Node>& _node);
+					/**
+					 * @brief Stop the running interfaces and release the stream of the backend (a device can be opened only one time: used before the node is re-created).
+					 */
+					void suspend();
+					/**
+					 * @brief Re-open the stream released by @ref suspend and restart the interfaces (the re-creation of the node has failed).
+					 * @return true The stream is open again.
+					 */
+					bool resume();
+					/**
+					 * @brief Check if the stream of the backend is open.
+					 * @return true The node can process data.
+					 */
+					virtual bool isStreamOpen() {
+						return true;
+					}
+				protected:
+					/**
+					 * @brief Close the stream of the backend (the node is stopped).
+					 */
+					virtual void streamRelease() {
+						
+					}
+					/**
+					 * @brief Re-open the stream closed by @ref streamRelease.
+					 * @return true The stream is open.
+					 */
+					virtual bool streamRestore() {
+						return true;
+					}
 				protected:
 					etk::String m_name; //!< Name of the interface
 				public:
@@ -157,6 +204,37 @@ namespace audio {
 					void setGroup(ememory::SharedPtr<audio::river::io::Group> _group) {
 						m_group = _group;
 					}
+				protected:
+					etk::Vector<ememory::WeakPtr<audio::river::io::Node> > m_loopbackList; //!< Input nodes that receive the data played by this output
+				public:
+					/**
+					 * @brief Add an input that receive the data played by this output (the block is shared, not copied).
+					 * @param[in] _node Input node.
+					 * @return true The input is connected.
+					 */
+					bool loopbackAdd(const ememory::SharedPtr<audio::river::io::Node>& _node);
+					/**
+					 * @brief Remove an input that receive the data played by this output.
+					 * @param[in] _node Input node.
+					 */
+					void loopbackRemove(const ememory::SharedPtr<audio::river::io::Node>& _node);
+					/**
+					 * @brief Receive the data played by the output that this input loopback on.
+					 * @note Called synchronously in the thread of the output, with the lock of the output taken: the lock of the input is taken after it (never in the other order).
+					 * @param[in] _data Pointer on the data (hardware format of the output, read only).
+					 * @param[in] _nbChunk Number of chunk in the buffer.
+					 * @param[in] _time Time of the first sample.
+					 */
+					virtual void loopbackInput(const void* _data, uint32_t _nbChunk, const audio::Time& _time) {
+						
+					}
+					/**
+					 * @brief Change the output that this input loopback on (the output has been re-created by a reload of the configuration).
+					 * @param[in] _source New output node.
+					 */
+					virtual void loopbackChangeSource(const ememory::SharedPtr<audio::river::io::Node>& _source) {
+						
+					}
 				protected:
 					/**
 					 * @brief Start the flow in the group (start if no group)
@@ -206,6 +284,92 @@ namespace audio {
 					void newOutput(void* _outputBuffer,
 					               uint32_t _nbChunk,
 					               const audio::Time& _time);
+				private:
+					/**
+					 * @brief Request the data of all the output interfaces and mix them in the muxer format.
+					 * @param[in,out] _outputBuffer Pointer on the buffer to write the data.
+					 * @param[in] _nbChunk Number of chunk to write in the buffer.
+					 * @param[in] _time Time where the data might be played.
+					 */
+					template<typename TYPE> void mixOutput(void* _outputBuffer,
+					                                       uint32_t _nbChunk,
+					                                       const audio::Time& _time);
+				protected:
+					audio::river::io::ThreadPolicy m_threadPolicy; //!< Scheduling requested for the thread that call the node.
+					bool m_threadPolicyApplied; //!< The scheduling has been set on the current callback thread.
+					/**
+					 * @brief Call by the hardware child classes at the start of the callback: apply the thread scheduling at the first call.
+					 */
+					void applyThreadPolicy() {
+						if (m_threadPolicyApplied == true) {
+							return;
+						}
+						m_threadPolicyApplied = true;
+						if (m_threadPolicy.isRequested() == true) {
+							m_threadPolicy.apply(m_name);
+						}
+					}
+				protected:
+					ememory::SharedPtr<audio::river::io::PeriodAdapter> m_periodAdapter; //!< Adaptation of the nb-chunk on the load (null if not configured)
+					/**
+					 * @brief Call by the hardware child classes at the start of the callback (with the lock of the node).
+					 */
+					void processStart() {
+						if (m_periodAdapter != null) {
+							m_periodAdapter->processStart();
+						}
+					}
+					/**
+					 * @brief Call by the hardware child classes at the end of the callback (with the lock of the node): request a new period if needed.
+					 * @param[in] _nbChunk Number of chunk processed in the callback.
+					 */
+					void processStop(uint32_t _nbChunk);
+				protected:
+					uint32_t m_latencyNbChunkMin; //!< Negotiation of the period: minimum nb-chunk (0: no negotiation)
+					uint32_t m_latencyNbChunkMax; //!< Negotiation of the period: nb-chunk when no interface request a latency
+					/**
+					 * @brief Select the period with the smallest latency requested by the running interfaces (called with the lock of the node).
+					 * The period is decreased at once, increased only when the new one is at least 4 times bigger, and kept when the last interface stop.
+					 */
+					void updateLatency();
+				protected:
+					uint32_t m_xrunUnderflow; //!< Number of underflow reported by the backend
+					uint32_t m_xrunOverflow; //!< Number of overflow reported by the backend
+					bool m_xrunReset; //!< Policy: reset the flows of the interfaces after a xrun
+					uint32_t m_xrunGrowNbChunk; //!< Policy: maximum nb-chunk when the period grow after some xrun (0: disable)
+					uint32_t m_xrunGrowCount; //!< Number of xrun in the current window of the grow policy
+					audio::Time m_xrunGrowTime; //!< Start of the current window of the grow policy
+					/**
+					 * @brief Call by the hardware child classes when the backend report a xrun (called with the lock of the node).
+					 * @param[in] _underflow true: underflow (the device has missed data), false: overflow (the device has lost data).
+					 * @param[in] _time Time of the callback.
+					 */
+					void xrun(bool _underflow, const audio::Time& _time);
+				protected:
+					ememory::SharedPtr<std::atomic<uint32_t> > m_periodSlot; //!< Slot of the manager where a new period is requested (null if the period can not change)
+					/**
+					 * @brief Request a new nb-chunk: the node is re-created by the period thread of the manager.
+					 * @note No lock and no allocation: can be called in the audio thread.
+					 * @param[in] _nbChunk New number of chunk of a period.
+					 * @return true The request is pending, false The request is dropped (no period thread).
+					 */
+					bool requestPeriod(uint32_t _nbChunk);
+				public:
+					/**
+					 * @brief Deliver the status raised in the audio thread to the interfaces (called by the period thread of the manager).
+					 */
+					virtual void deliverStatus();
+				public:
+					/**
+					 * @brief Get the number of xrun reported by the backend since the creation of the node (or the last reset).
+					 * @param[out] _underflow Number of underflow.
+					 * @param[out] _overflow Number of overflow.
+					 */
+					void getXrun(uint32_t& _underflow, uint32_t& _overflow);
+					/**
+					 * @brief Reset the xrun counters.
+					 */
+					void resetXrun();
 				public:
 					/**
 					 * @brief Generate the node dot file section
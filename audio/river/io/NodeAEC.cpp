@@ -9,6 +9,10 @@
 #include <etk/types.hpp>
 #include <ememory/memory.hpp>
 #include <etk/Function.hpp>
+#include <cstdlib>
+
+// Number of consecutive estimation needed to apply a new delay
+static const uint32_t delayStableCount = 3;
 
 ememory::SharedPtr<audio::river::io::NodeAEC> audio::river::io::NodeAEC::create(const etk::String& _name, const ejson::Object& _config) {
 	return ememory::SharedPtr<audio::river::io::NodeAEC>(ETK_NEW(audio::river::io::NodeAEC, _name, _config));
@@ -27,7 +31,6 @@ ememory::SharedPtr<audio::river::Interface> audio::river::io::NodeAEC::createInp
 	}
 	etk::String streamName = tmppp["map-on"].toString().get("error");
 	
-	m_nbChunk = m_config["nb-chunk"].toNumber().get(1024);
 	// check if it is an Output:
 	etk::String type = tmppp["io"].toString().get("error");
 	if (    type != "input"
@@ -51,14 +54,33 @@ ememory::SharedPtr<audio::river::Interface> audio::river::io::NodeAEC::createInp
 
 audio::river::io::NodeAEC::NodeAEC(const etk::String& _name, const ejson::Object& _config) :
   Node(_name, _config),
+  m_nbChunk(1024),
+  m_gainValue(32767),
+  m_sampleCount(0),
   m_P_attaqueTime(1),
   m_P_releaseTime(100),
   m_P_minimumGain(10),
   m_P_threshold(2),
-  m_P_latencyTime(100) {
+  m_P_latencyTime(100),
+  m_cutterIncrease(32767),
+  m_cutterDecrease(32767),
+  m_cutterMinimumGain(0),
+  m_cutterThreshold(0),
+  m_cutterLatency(0),
+  m_useEchoCanceller(false),
+  m_delayEstimation(false),
+  m_delaySample(0),
+  m_maxDelaySample(0),
+  m_delayMargin(0),
+  m_delayCandidate(0),
+  m_delayCandidateCount(0) {
 	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
 	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
-	m_sampleTime = audio::Duration(1000000000/int64_t(hardwareFormat.getFrequency()));
+	m_worker.configure(m_config, hardwareFormat.getFrequency());
+	m_nbChunk = m_config["nb-chunk"].toNumber().get(1024);
+	if (m_nbChunk <= 0) {
+		m_nbChunk = 1024;
+	}
 	/**
 		# connect in input mode
 		map-on-microphone:{
@@ -76,9 +98,36 @@ audio::river::io::NodeAEC::NodeAEC(const etk::String& _name, const ejson::Object
 			resampling-option:"quality=10",
 		},
 		# AEC algo definition
-		algo:"river-remover",
+		algo:"river-remover", # "river-remover": cutter of the microphone when the speaker play, "mdf": adaptive echo canceller
 		algo-mode:"cutter",
+		# mdf parameters (optionnal) (nb-chunk must be a power of 2)
+		filter-length:100, # ms: length of the echo path
+		mdf-step:0.5, # adaptation step [0..1]
+		# process in a dedicated thread (optionnal)
+		worker:{
+			latency:10, # ms
+		},
+		# resample the feedback to follow the clock of the microphone (no jump in the flows)
+		drift-compensation:false,
+		# delay between the feedback and the microphone (optionnal)
+		delay:0, # ms: initial delay
+		delay-estimation:{ # continuous estimation of the delay (GCC-PHAT)
+			max-delay:300, # ms (< 500 ms)
+			period:1000, # ms between 2 estimations
+			margin:2, # ms: removed from the estimation (the echo must stay after the feedback)
+		},
+		# cutter parameters (optionnal)
+		attack-time:1, # ms
+		release-time:100, # ms
+		minimum-gain:10, # per-mille
+		threshold:2, # per-mille of the full scale of the feedback
+		latency-time:100, # ms
 	*/
+	// all the algorithms (the cutter too) and the delay estimation process int16 samples
+	if (hardwareFormat.getFormat() != audio::format_int16) {
+		RIVER_ERROR("AEC need int16 format (not " << hardwareFormat.getFormat() << ") ==> node '" << _name << "' disabled");
+		return;
+	}
 	etk::Vector<audio::channel> feedbackMap;
 	feedbackMap.pushBack(audio::channel_frontCenter);
 	RIVER_INFO("Create FEEDBACK : ");
@@ -120,19 +169,70 @@ audio::river::io::NodeAEC::NodeAEC(const etk::String& _name, const ejson::Object
 	                                            const etk::Vector<audio::channel>& _map) {
 	                                            	onDataReceivedMicrophone(_data, _time, _nbChunk, _format, _frequency, _map);
 	                                            });
-	m_bufferMicrophone.setCapacity(echrono::milliseconds(1000),
-	                               audio::getFormatBytes(hardwareFormat.getFormat())*hardwareFormat.getMap().size(),
-	                               hardwareFormat.getFrequency());
-	m_bufferFeedBack.setCapacity(echrono::milliseconds(1000),
-	                             audio::getFormatBytes(hardwareFormat.getFormat()), // only one channel ...
-	                             hardwareFormat.getFrequency());
-	
+	// a xrun on one of the device break the alignment of the 2 flows: restart the synchronization
+	m_interfaceFeedBack->setStatusFunction([=](const etk::String& _origin, const etk::String& _status) {
+	                                       	if (_origin == "xrun") {
+	                                       		m_synchronizer.clear();
+	                                       	}
+	                                       });
+	m_interfaceMicrophone->setStatusFunction([=](const etk::String& _origin, const etk::String& _status) {
+	                                         	if (_origin == "xrun") {
+	                                         		m_synchronizer.clear();
+	                                         	}
+	                                         });
+	// the microphone is the reference of the synchronization
+	m_synchronizer.init(hardwareFormat.getFrequency(), m_nbChunk, m_config["drift-compensation"].toBoolean().get(false));
+	m_synchronizer.addSource(hardwareFormat.getFormat(), hardwareFormat.getMap().size(), echrono::milliseconds(1000));
+	m_synchronizer.addSource(hardwareFormat.getFormat(), 1, echrono::milliseconds(1000)); // only one channel ...
+	m_synchronizer.setLatency(m_worker.getLatency());
+	m_gainCurve.resize(m_nbChunk, 0);
+	m_P_attaqueTime = m_config["attack-time"].toNumber().get(m_P_attaqueTime);
+	m_P_releaseTime = m_config["release-time"].toNumber().get(m_P_releaseTime);
+	m_P_minimumGain = m_config["minimum-gain"].toNumber().get(m_P_minimumGain);
+	m_P_threshold = m_config["threshold"].toNumber().get(m_P_threshold);
+	m_P_latencyTime = m_config["latency-time"].toNumber().get(m_P_latencyTime);
+	updateCutterParameter();
+	const ejson::Object delayEstimation = m_config["delay-estimation"].toObject();
+	int32_t maxDelay = 500;
+	if (delayEstimation.exist() == true) {
+		// the feedback buffer store 1 second
+		maxDelay = etk::avg(1, int32_t(delayEstimation["max-delay"].toNumber().get(300)), 500);
+	}
+	m_maxDelaySample = int32_t(hardwareFormat.getFrequency())*maxDelay/1000;
+	setDelay(int32_t(hardwareFormat.getFrequency())*int32_t(m_config["delay"].toNumber().get(0))/1000);
+	if (delayEstimation.exist() == true) {
+		m_delayEstimation = m_delayEstimator.init(hardwareFormat.getFrequency(),
+		                                          maxDelay,
+		                                          delayEstimation["period"].toNumber().get(1000));
+		// an estimation too late by one decimated sample make the reference non causal: keep a margin
+		m_delayMargin = etk::max(int32_t(m_delayEstimator.getDecimation()),
+		                         int32_t(hardwareFormat.getFrequency())*int32_t(delayEstimation["margin"].toNumber().get(2))/1000);
+	}
+	etk::String algo = m_config["algo"].toString().get("river-remover");
+	if (algo == "mdf") {
+		int32_t filterLength = m_config["filter-length"].toNumber().get(100);
+		int32_t nbSample = etk::max(1, int32_t(hardwareFormat.getFrequency())*filterLength/1000);
+		int32_t nbPartition = (nbSample + m_nbChunk - 1) / m_nbChunk;
+		m_useEchoCanceller = m_echoCanceller.init(m_nbChunk,
+		                                          nbPartition,
+		                                          hardwareFormat.getMap().size(),
+		                                          m_config["mdf-step"].toNumber().get(0.5));
+		if (m_useEchoCanceller == false) {
+			RIVER_ERROR("Can not initialize the AEC 'mdf' (nb-chunk=" << m_nbChunk << " must be a power of 2) ==> use the cutter");
+		} else {
+			// the divergences of the filter are reported by the period thread
+			audio::river::io::Manager::getInstance()->startPeriodThread();
+		}
+	} else if (algo != "river-remover") {
+		RIVER_ERROR("Unknow AEC algo: '" << algo << "' availlable: [river-remover,mdf] ==> use river-remover");
+	}
 	m_process.updateInterAlgo();
 }
 
 audio::river::io::NodeAEC::~NodeAEC() {
 	RIVER_INFO("close input stream");
 	stop();
+	m_delayEstimator.unInit();
 	m_interfaceFeedBack.reset();
 	m_interfaceMicrophone.reset();
 };
@@ -140,6 +240,8 @@ audio::river::io::NodeAEC::~NodeAEC() {
 void audio::river::io::NodeAEC::start() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	m_threadPolicyApplied = false;
+	m_worker.start("RIVER AEC", [=](){this->onWorker();});
 	if (m_interfaceFeedBack != null) {
 		RIVER_INFO("Start FEEDBACK : ");
 		m_interfaceFeedBack->start();
@@ -151,16 +253,31 @@ void audio::river::io::NodeAEC::start() {
 }
 
 void audio::river::io::NodeAEC::stop() {
-	ethread::UniqueLock lock(m_mutex);
-	if (m_interfaceFeedBack != null) {
-		m_interfaceFeedBack->stop();
-	}
-	if (m_interfaceMicrophone != null) {
-		m_interfaceMicrophone->stop();
+	{
+		ethread::UniqueLock lock(m_mutex);
+		if (m_interfaceFeedBack != null) {
+			m_interfaceFeedBack->stop();
+		}
+		if (m_interfaceMicrophone != null) {
+			m_interfaceMicrophone->stop();
+		}
 	}
+	// join without the lock: the worker need it to finish the current process.
+	m_worker.stop();
 }
 
 
+void audio::river::io::NodeAEC::deliverStatus() {
+	audio::river::io::Node::deliverStatus();
+	if (m_useEchoCanceller == false) {
+		return;
+	}
+	uint32_t nbDivergence = m_echoCanceller.takeDivergence();
+	if (nbDivergence != 0) {
+		RIVER_WARNING("Echo canceller of '" << m_name << "' diverge " << nbDivergence << " time(s) ==> reset of the channel(s)");
+	}
+}
+
 void audio::river::io::NodeAEC::onDataReceivedMicrophone(const void* _data,
                                                   const audio::Time& _time,
                                                   size_t _nbChunk,
@@ -173,9 +290,13 @@ void audio::river::io::NodeAEC::onDataReceivedMicrophone(const void* _data,
 		RIVER_ERROR("call wrong type ... (need int16_t)");
 	}
 	// push data synchronize
-	ethread::UniqueLock lock(m_mutex);
-	m_bufferMicrophone.write(_data, _nbChunk, _time);
+	m_synchronizer.write(0, _data, _nbChunk, _time);
 	//RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone.raw", _data, _nbChunk*_map.size());
+	if (m_worker.isEnable() == true) {
+		m_worker.notify();
+		return;
+	}
+	ethread::UniqueLock lock(m_mutex);
 	process();
 }
 
@@ -191,126 +312,156 @@ void audio::river::io::NodeAEC::onDataReceivedFeedBack(const void* _data,
 		RIVER_ERROR("call wrong type ... (need int16_t)");
 	}
 	// push data synchronize
-	ethread::UniqueLock lock(m_mutex);
-	m_bufferFeedBack.write(_data, _nbChunk, _time);
+	m_synchronizer.write(1, _data, _nbChunk, _time);
 	//RIVER_SAVE_FILE_MACRO(int16_t, "REC_FeedBack.raw", _data, _nbChunk*_map.size());
+	if (m_worker.isEnable() == true) {
+		m_worker.notify();
+		return;
+	}
+	ethread::UniqueLock lock(m_mutex);
+	process();
+}
+
+void audio::river::io::NodeAEC::onWorker() {
+	ethread::UniqueLock lock(m_mutex);
+	applyThreadPolicy();
 	process();
 }
 
 void audio::river::io::NodeAEC::process() {
-	if (    m_bufferMicrophone.getSize() <= m_nbChunk
-	     || m_bufferFeedBack.getSize() <= m_nbChunk) {
-		return;
+	audio::Time MicTime;
+	// the rings are locked only during the synchronization: the callbacks are not blocked by the algorithm
+	while (m_synchronizer.acquire(MicTime) == true) {
+		void* dataMicrophone = m_synchronizer.getData(0);
+		void* dataFeedBack = m_synchronizer.getData(1);
+		RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone_sync.raw", dataMicrophone, m_nbChunk*getHarwareFormat().getMap().size());
+		RIVER_SAVE_FILE_MACRO(int16_t, "REC_FeedBack_sync.raw", dataFeedBack, m_nbChunk);
+		if (m_delayEstimation == true) {
+			// only a decimation: the correlation is done in the estimator thread
+			m_delayEstimator.push(static_cast<const int16_t*>(dataMicrophone),
+			                      getHarwareFormat().getMap().size(),
+			                      static_cast<const int16_t*>(dataFeedBack),
+			                      m_nbChunk);
+		}
+		processAEC(dataMicrophone, dataFeedBack, m_nbChunk, MicTime);
+		m_synchronizer.release();
+		// a new delay is applied by the synchronization of the next chunk
+		updateDelay();
 	}
-	audio::Time MicTime = m_bufferMicrophone.getReadTimeStamp();
-	audio::Time fbTime = m_bufferFeedBack.getReadTimeStamp();
-	audio::Duration delta;
-	if (MicTime < fbTime) {
-		delta = fbTime - MicTime;
-	} else {
-		delta = MicTime - fbTime;
+}
+
+void audio::river::io::NodeAEC::setDelay(int32_t _delay) {
+	m_delaySample = etk::avg(0, _delay, m_maxDelaySample);
+	int64_t delayNs = int64_t(m_delaySample)*1000000000LL/int64_t(getHarwareFormat().getFrequency());
+	m_delay = audio::Duration(delayNs/1000000000LL, delayNs%1000000000LL);
+	// the feedback sample played at T is in the microphone at T+delay
+	m_synchronizer.setOffset(1, m_delay);
+}
+
+bool audio::river::io::NodeAEC::updateDelay() {
+	if (m_delayEstimation == false) {
+		return false;
 	}
-	
-	RIVER_INFO("check delta " << delta << " > " << m_sampleTime);
-	if (delta > m_sampleTime) {
-		// Synchronize if possible
-		if (MicTime < fbTime) {
-			RIVER_INFO("micTime < fbTime : Change Microphone time start " << fbTime);
-			RIVER_INFO("                                 old time stamp=" << m_bufferMicrophone.getReadTimeStamp());
-			m_bufferMicrophone.setReadPosition(fbTime);
-			RIVER_INFO("                                 new time stamp=" << m_bufferMicrophone.getReadTimeStamp());
-		}
-		if (MicTime > fbTime) {
-			RIVER_INFO("micTime > fbTime : Change FeedBack time start " << MicTime);
-			RIVER_INFO("                               old time stamp=" << m_bufferFeedBack.getReadTimeStamp());
-			m_bufferFeedBack.setReadPosition(MicTime);
-			RIVER_INFO("                               new time stamp=" << m_bufferFeedBack.getReadTimeStamp());
-		}
+	int32_t residual = 0;
+	if (m_delayEstimator.getDelay(residual) == false) {
+		return false;
 	}
-	// check if enought time after synchronisation ...
-	if (    m_bufferMicrophone.getSize() <= m_nbChunk
-	     || m_bufferFeedBack.getSize() <= m_nbChunk) {
-		return;
+	// the estimation is done on the flows already aligned with the current delay (the margin is in the residual)
+	int32_t target = etk::avg(0, m_delaySample + residual - m_delayMargin, m_maxDelaySample);
+	if (std::abs(target - m_delaySample) <= m_delayMargin) {
+		// the echo is still after the feedback: the jitter of the estimation does not reset the filter
+		m_delayCandidateCount = 0;
+		return false;
 	}
-	
-	MicTime = m_bufferMicrophone.getReadTimeStamp();
-	fbTime = m_bufferFeedBack.getReadTimeStamp();
-	
-	if (MicTime-fbTime > m_sampleTime) {
-		RIVER_ERROR("Can not synchronize flow ... : " << MicTime << " != " << fbTime << "  delta = " << (MicTime-fbTime));
-		return;
+	if (    m_delayCandidateCount == 0
+	     || std::abs(target - m_delayCandidate) > int32_t(m_delayEstimator.getDecimation())) {
+		m_delayCandidate = target;
+		m_delayCandidateCount = 1;
+		return false;
 	}
-	etk::Vector<uint8_t> dataMic;
-	etk::Vector<uint8_t> dataFB;
-	dataMic.resize(m_nbChunk*sizeof(int16_t)*2, 0);
-	dataFB.resize(m_nbChunk*sizeof(int16_t), 0);
-	while (true) {
-		MicTime = m_bufferMicrophone.getReadTimeStamp();
-		fbTime = m_bufferFeedBack.getReadTimeStamp();
-		RIVER_INFO(" process 256 samples ... micTime=" << MicTime << " fbTime=" << fbTime << " delta = " << (MicTime-fbTime));
-		m_bufferMicrophone.read(&dataMic[0], m_nbChunk);
-		m_bufferFeedBack.read(&dataFB[0], m_nbChunk);
-		RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone_sync.raw", &dataMic[0], m_nbChunk*getHarwareFormat().getMap().size());
-		RIVER_SAVE_FILE_MACRO(int16_t, "REC_FeedBack_sync.raw", &dataFB[0], m_nbChunk);
-		// if threaded : send event / otherwise, process ...
-		processAEC(&dataMic[0], &dataFB[0], m_nbChunk, MicTime);
-		if (    m_bufferMicrophone.getSize() <= m_nbChunk
-		     || m_bufferFeedBack.getSize() <= m_nbChunk) {
-			return;
-		}
+	m_delayCandidateCount++;
+	if (m_delayCandidateCount < delayStableCount) {
+		return false;
+	}
+	m_delayCandidateCount = 0;
+	int32_t previous = m_delaySample;
+	setDelay(target);
+	RIVER_INFO("AEC delay: " << previous << " ==> " << m_delaySample << " samples (" << m_delay << ")");
+	// the filter and the history are for the previous alignment
+	m_delayEstimator.reset();
+	if (m_useEchoCanceller == true) {
+		m_echoCanceller.reset();
 	}
+	return true;
 }
 
+void audio::river::io::NodeAEC::updateCutterParameter() {
+	int32_t frequency = getHarwareFormat().getFrequency();
+	int32_t attaqueTime = etk::avg(0, m_P_attaqueTime, 1000);
+	int32_t releaseTime = etk::avg(0, m_P_releaseTime, 1000);
+	m_cutterMinimumGain = 32767 * etk::avg(0, m_P_minimumGain, 1000) / 1000;
+	m_cutterThreshold = 32767 * etk::avg(0, m_P_threshold, 1000) / 1000;
+	m_cutterLatency = (frequency/1000) * etk::avg(0, m_P_latencyTime, 1000);
+	m_cutterIncrease = 32767;
+	if (frequency * attaqueTime / 1000 > 0) {
+		m_cutterIncrease = 32767/(frequency * attaqueTime / 1000);
+	}
+	m_cutterDecrease = 32767;
+	if (frequency * releaseTime / 1000 > 0) {
+		m_cutterDecrease = 32767/(frequency * releaseTime / 1000);
+	}
+	RIVER_DEBUG("AEC cutter: increase=" << m_cutterIncrease << " decrease=" << m_cutterDecrease << " min-gain=" << m_cutterMinimumGain << " threshold=" << m_cutterThreshold << " latency=" << m_cutterLatency);
+}
 
 void audio::river::io::NodeAEC::processAEC(void* _dataMic, void* _dataFB, uint32_t _nbChunk, const audio::Time& _time) {
-	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
-	// TODO : Set all these parameter in the parameter configuration section ...
-	int32_t attaqueTime = etk::min(etk::max(0,m_P_attaqueTime),1000);
-	int32_t releaseTime = etk::min(etk::max(0,m_P_releaseTime),1000);
-	int32_t min_gain = 32767 * etk::min(etk::max(0,m_P_minimumGain),1000) / 1000;
-	int32_t threshold = 32767 * etk::min(etk::max(0,m_P_threshold),1000) / 1000;
-	
-	int32_t latencyTime = etk::min(etk::max(0,m_P_latencyTime),1000);
-	int32_t nb_sample_latency = (hardwareFormat.getFrequency()/1000)*latencyTime;
-	
-	int32_t increaseSample = 32767;
-	if (attaqueTime != 0) {
-		increaseSample = 32767/(hardwareFormat.getFrequency() * attaqueTime / 1000);
-	}
-	int32_t decreaseSample = 32767;
-	if (attaqueTime != 0) {
-		decreaseSample = 32767/(hardwareFormat.getFrequency() * releaseTime / 1000);
+	if (    m_useEchoCanceller == true
+	     && _nbChunk == m_echoCanceller.getBlockSize()) {
+		m_echoCanceller.process(static_cast<int16_t*>(_dataMic), static_cast<const int16_t*>(_dataFB));
+		RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone_clean.raw", _dataMic, _nbChunk*getHarwareFormat().getMap().size());
+		newInput(_dataMic, _nbChunk, _time);
+		return;
 	}
-	// Process section:
+	const size_t nbChannel = getHarwareFormat().getMap().size();
 	int16_t* dataMic = static_cast<int16_t*>(_dataMic);
-	int16_t* dataFB = static_cast<int16_t*>(_dataFB);
+	const int16_t* dataFB = static_cast<const int16_t*>(_dataFB);
+	int32_t* gain = &m_gainCurve[0];
+	_nbChunk = etk::min(_nbChunk, uint32_t(m_gainCurve.size()));
+	// 1: threshold mask of the feedback (no dependency between the samples ==> vectorized by the compiler)
+	const int32_t threshold = m_cutterThreshold;
+	for (size_t iii=0; iii<_nbChunk; ++iii) {
+		int32_t value = dataFB[iii];
+		gain[iii] = (value > threshold) | (value < -threshold);
+	}
+	// 2: scan of the mask ==> gain curve (the only serial part: one operation per sample, not per channel)
+	int32_t sampleCount = m_sampleCount;
+	int32_t gainValue = m_gainValue;
 	for (size_t iii=0; iii<_nbChunk; ++iii) {
-		if (abs(*dataFB++) > threshold) {
-			m_sampleCount = 0;
+		sampleCount = (gain[iii] != 0) ? 0 : sampleCount + 1;
+		if (sampleCount > m_cutterLatency) {
+			gainValue = etk::min(gainValue + m_cutterDecrease, 32767);
 		} else {
-			m_sampleCount++;
+			gainValue = etk::max(gainValue - m_cutterIncrease, m_cutterMinimumGain);
 		}
-		if (m_sampleCount > nb_sample_latency) {
-			m_gainValue += decreaseSample;
-			if (m_gainValue >= 32767) {
-				m_gainValue = 32767;
-			}
-		} else {
-			if (m_gainValue <= increaseSample) {
-				m_gainValue = 0;
-			} else {
-				m_gainValue -= increaseSample;
-			}
-			if (m_gainValue < min_gain) {
-				m_gainValue = min_gain;
-			}
+		gain[iii] = gainValue;
+	}
+	// keep the counter bounded when the feedback stay silent
+	m_sampleCount = etk::min(sampleCount, m_cutterLatency + 1);
+	m_gainValue = gainValue;
+	// 3: apply the gain on all the channels in one pass
+	if (nbChannel == 1) {
+		for (size_t iii=0; iii<_nbChunk; ++iii) {
+			dataMic[iii] = static_cast<int16_t>((int32_t(dataMic[iii]) * gain[iii]) >> 15);
 		}
-		for (size_t jjj=0; jjj<hardwareFormat.getMap().size(); ++jjj) {
-			*dataMic = static_cast<int16_t>((*dataMic * m_gainValue) >> 15);
-			dataMic++;
+	} else {
+		for (size_t iii=0; iii<_nbChunk; ++iii) {
+			const int32_t value = gain[iii];
+			for (size_t jjj=0; jjj<nbChannel; ++jjj) {
+				dataMic[jjj] = static_cast<int16_t>((int32_t(dataMic[jjj]) * value) >> 15);
+			}
+			dataMic += nbChannel;
 		}
 	}
-		RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone_clean.raw", _dataMic, _nbChunk*getHarwareFormat().getMap().size());
+	RIVER_SAVE_FILE_MACRO(int16_t, "REC_Microphone_clean.raw", _dataMic, _nbChunk*nbChannel);
 	// simply send to upper requester...
 	newInput(_dataMic, _nbChunk, _time);
 }
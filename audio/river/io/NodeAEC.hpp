@@ -7,7 +7,10 @@
 
 #include <audio/river/io/Node.hpp>
 #include <audio/river/Interface.hpp>
-#include <audio/drain/CircularBuffer.hpp>
+#include <audio/river/io/EchoCanceller.hpp>
+#include <audio/river/io/DelayEstimator.hpp>
+#include <audio/river/io/NodeWorker.hpp>
+#include <audio/river/io/StreamSynchronizer.hpp>
 
 namespace audio {
 	namespace river {
@@ -33,6 +36,9 @@ namespace audio {
 				protected:
 					virtual void start();
 					virtual void stop();
+				public:
+					virtual void deliverStatus();
+				protected:
 					ememory::SharedPtr<audio::river::Interface> m_interfaceMicrophone; //!< Interface on the Microphone.
 					ememory::SharedPtr<audio::river::Interface> m_interfaceFeedBack; //!< Interface on the feedback of speaker.
 					/**
@@ -69,10 +75,13 @@ namespace audio {
 					                            enum audio::format _format,
 					                            uint32_t _frequency,
 					                            const etk::Vector<audio::channel>& _map);
+					/**
+					 * @brief Process the data in the worker thread.
+					 */
+					void onWorker();
 				protected:
-					audio::drain::CircularBuffer m_bufferMicrophone; //!< temporary buffer to synchronize data.
-					audio::drain::CircularBuffer m_bufferFeedBack; //!< temporary buffer to synchronize data.
-					audio::Duration m_sampleTime; //!< represent the sample time at the specify frequency.
+					audio::river::io::NodeWorker m_worker; //!< Optionnal processing thread
+					audio::river::io::StreamSynchronizer m_synchronizer; //!< Synchronization of the microphone (reference) and the feedback (the only lock taken by the callbacks with a worker).
 					/**
 					 * @brief Process synchronization on the 2 flow.
 					 */
@@ -95,10 +104,40 @@ namespace audio {
 					
 					int32_t m_P_attaqueTime; //ms
 					int32_t m_P_releaseTime; //ms
-					int32_t m_P_minimumGain; // %
-					int32_t m_P_threshold; // %
+					int32_t m_P_minimumGain; // per-mille
+					int32_t m_P_threshold; // per-mille
 					int32_t m_P_latencyTime; // ms
 					
+					int32_t m_cutterIncrease; //!< Gain step of a sample during the attack (precomputed)
+					int32_t m_cutterDecrease; //!< Gain step of a sample during the release (precomputed)
+					int32_t m_cutterMinimumGain; //!< Minimum gain on 15 bits (precomputed)
+					int32_t m_cutterThreshold; //!< Threshold of the feedback on 15 bits (precomputed)
+					int32_t m_cutterLatency; //!< Number of silent sample before release the gain (precomputed)
+					etk::Vector<int32_t> m_gainCurve; //!< Gain of each sample of a block (preallocated)
+					bool m_useEchoCanceller; //!< algo "mdf": use the adaptive filter instead of the cutter
+					audio::river::io::EchoCanceller m_echoCanceller; //!< Frequency domain adaptive filter
+					bool m_delayEstimation; //!< The delay between the feedback and the microphone is estimated
+					audio::river::io::DelayEstimator m_delayEstimator; //!< Estimator of the delay (GCC-PHAT in a low priority thread)
+					int32_t m_delaySample; //!< Delay of the microphone after the feedback (sample)
+					int32_t m_maxDelaySample; //!< Maximum delay (sample)
+					audio::Duration m_delay; //!< Delay of the microphone after the feedback (read offset of the synchronization)
+					int32_t m_delayMargin; //!< Causal margin removed from the estimated delay (sample, at least the decimation factor)
+					int32_t m_delayCandidate; //!< Estimated delay waiting to be stable before being applied (sample)
+					uint32_t m_delayCandidateCount; //!< Number of consecutive estimation that confirm the candidate
+					/**
+					 * @brief Set the delay between the feedback and the microphone.
+					 * @param[in] _delay Delay in sample (limited to the maximum delay).
+					 */
+					void setDelay(int32_t _delay);
+					/**
+					 * @brief Apply the last estimation of the delay (with an hysteresis: the filter is reset at each change).
+					 * @return true The delay has changed (the flows need to be synchronized again).
+					 */
+					bool updateDelay();
+					/**
+					 * @brief Update the constants of the cutter algorithm when the parameters change.
+					 */
+					void updateCutterParameter();
 			};
 		}
 	}
@@ -0,0 +1,162 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/NodeClock.hpp>
+#include <audio/river/debug.hpp>
+#include <ememory/memory.hpp>
+
+extern "C" {
+	#include <errno.h>
+	#include <time.h>
+}
+
+audio::river::io::NodeClock::NodeClock(const etk::String& _name, const ejson::Object& _config) :
+  Node(_name, _config),
+  m_nbChunk(1024),
+  m_manualClock(false),
+  m_running(false),
+  m_nbSample(0),
+  m_alive(false) {
+	m_nbChunk = m_config["nb-chunk"].toNumber().get(1024);
+	if (m_nbChunk == 0) {
+		m_nbChunk = 1024;
+	}
+	etk::String clock = m_config["clock"].toString().get("timer");
+	if (clock == "manual") {
+		m_manualClock = true;
+	} else if (clock != "timer") {
+		RIVER_ERROR("Unknow clock: '" << clock << "' availlable: [timer,manual] ==> use timer");
+	}
+}
+
+audio::river::io::NodeClock::~NodeClock() {
+	if (m_thread != null) {
+		RIVER_ERROR("The child class must stop the timer thread before destroying the node: '" << m_name << "'");
+		stop();
+	}
+}
+
+bool audio::river::io::NodeClock::setManualClock(bool _manual) {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_running == true) {
+		RIVER_ERROR("Can not change the clock of '" << m_name << "' when the flow is started");
+		return false;
+	}
+	m_manualClock = _manual;
+	return true;
+}
+
+bool audio::river::io::NodeClock::isRunning() const {
+	ethread::UniqueLock lock(m_mutex);
+	return m_running;
+}
+
+bool audio::river::io::NodeClock::step(uint32_t _nbPeriod) {
+	ethread::UniqueLock lock(m_mutex);
+	if (    m_manualClock == false
+	     || m_running == false) {
+		return false;
+	}
+	for (uint32_t iii=0; iii<_nbPeriod; ++iii) {
+		processNextPeriod();
+	}
+	return true;
+}
+
+audio::Time audio::river::io::NodeClock::getClockTime() {
+	ethread::UniqueLock lock(m_mutex);
+	uint32_t frequency = getHarwareFormat().getFrequency();
+	if (frequency == 0) {
+		return m_startTime;
+	}
+	return m_startTime + getSampleDuration(m_nbSample, frequency);
+}
+
+audio::Duration audio::river::io::NodeClock::getSampleDuration(uint64_t _nbSample, uint32_t _frequency) {
+	// m_nbSample*1000000000 overflow after 106 hours at 48kHz
+	uint64_t second = _nbSample/uint64_t(_frequency);
+	uint64_t nanoSecond = (_nbSample%uint64_t(_frequency))*1000000000ULL/uint64_t(_frequency);
+	return audio::Duration(int64_t(second), int64_t(nanoSecond));
+}
+
+void audio::river::io::NodeClock::processNextPeriod() {
+	uint32_t frequency = getHarwareFormat().getFrequency();
+	if (frequency == 0) {
+		return;
+	}
+	// time is computed from the number of sample to prevent drift of the clock
+	processPeriod(m_startTime + getSampleDuration(m_nbSample, frequency));
+	m_nbSample += m_nbChunk;
+}
+
+void audio::river::io::NodeClock::threadCallback() {
+	uint32_t frequency = getHarwareFormat().getFrequency();
+	if (frequency == 0) {
+		RIVER_ERROR("Can not clock the node '" << m_name << "' with frequency=0");
+		return;
+	}
+	struct timespec startClock;
+	clock_gettime(CLOCK_MONOTONIC, &startClock);
+	uint64_t nbSample = 0;
+	while (m_alive == true) {
+		{
+			ethread::UniqueLock lock(m_mutex);
+			applyThreadPolicy();
+			processNextPeriod();
+			nbSample = m_nbSample;
+		}
+		// wait the start of the next period
+		uint64_t second = nbSample/uint64_t(frequency);
+		int64_t nextNs = int64_t((nbSample%uint64_t(frequency))*1000000000ULL/uint64_t(frequency)) + startClock.tv_nsec;
+		struct timespec deadline;
+		deadline.tv_sec = startClock.tv_sec + second + nextNs/1000000000LL;
+		deadline.tv_nsec = nextNs%1000000000LL;
+		while (    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, null) == EINTR
+		        && m_alive == true) {
+			// interrupted by a signal ==> wait again
+		}
+	}
+}
+
+void audio::river::io::NodeClock::start() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_running == true) {
+		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " ==> already started ..." );
+		return;
+	}
+	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " clock=" << (m_manualClock?"manual":"timer"));
+	m_running = true;
+	if (    m_manualClock == true
+	     && audio::river::io::Manager::getInstance()->isOffline() == true) {
+		// all the flows are aligned on the master clock of the offline rendering
+		m_startTime = audio::river::io::Manager::getInstance()->getOfflineTime();
+	} else {
+		m_startTime = audio::Time::now();
+	}
+	m_nbSample = 0;
+	if (m_manualClock == true) {
+		return;
+	}
+	m_alive = true;
+	m_threadPolicyApplied = false;
+	m_thread = ememory::makeShared<ethread::Thread>([=](){this->threadCallback();}, "RIVER clock");
+}
+
+void audio::river::io::NodeClock::stop() {
+	ememory::SharedPtr<ethread::Thread> thread;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		RIVER_INFO("Stop stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+		m_running = false;
+		m_alive = false;
+		thread = m_thread;
+		m_thread.reset();
+	}
+	// join without the lock: the timer thread need it to finish the current period.
+	if (thread != null) {
+		thread->join();
+	}
+}
@@ -0,0 +1,109 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <audio/river/io/Node.hpp>
+#include <ethread/Thread.hpp>
+#include <audio/Duration.hpp>
+#include <atomic>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Base of the nodes that simulate an hardware: the flow is clocked by an internal timer thread or by the user with step().
+			 * @code
+			 * clock:"timer", # "timer": real time thread, "manual": the flow advance only when step() is called
+			 * @endcode
+			 */
+			class NodeClock : public audio::river::io::Node {
+				protected:
+					/**
+					 * @brief Constructor
+					 */
+					NodeClock(const etk::String& _name, const ejson::Object& _config);
+				public:
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~NodeClock();
+					virtual bool isHarwareNode() {
+						return true;
+					};
+				protected:
+					uint32_t m_nbChunk; //!< Number of chunk processed at each period
+					bool m_manualClock; //!< The clock is driven by step() (no thread)
+					bool m_running; //!< The flow is started
+					audio::Time m_startTime; //!< Time of the first sample of the flow
+					uint64_t m_nbSample; //!< Number of sample processed since the start
+					ememory::SharedPtr<ethread::Thread> m_thread; //!< Timer thread of the flow
+					std::atomic<bool> m_alive; //!< Thread is active
+				public:
+					/**
+					 * @brief Get the number of chunk processed at each period
+					 * @return Number of chunk.
+					 */
+					uint32_t getPeriodSize() const {
+						return m_nbChunk;
+					}
+					/**
+					 * @brief Check if the clock is driven by step().
+					 * @return true No timer thread.
+					 */
+					bool isManualClock() const {
+						return m_manualClock;
+					}
+					/**
+					 * @brief Select the clock of the flow (only availlable when the flow is stopped).
+					 * @param[in] _manual true: driven by step(), false: driven by the timer thread.
+					 * @return true The clock has been changed.
+					 */
+					bool setManualClock(bool _manual);
+					/**
+					 * @brief Check if the flow is started.
+					 * @return true The flow is started.
+					 */
+					bool isRunning() const;
+					/**
+					 * @brief Process some period of the flow without waiting (manual clock only).
+					 * @param[in] _nbPeriod Number of period to process.
+					 * @return true The periods have been processed.
+					 * @return false The flow is stopped or clocked by the timer thread.
+					 */
+					bool step(uint32_t _nbPeriod=1);
+					/**
+					 * @brief Get the time of the next period.
+					 * @return Time of the first sample of the next period.
+					 */
+					audio::Time getClockTime();
+					/**
+					 * @brief Get the duration of a number of sample (the seconds and the rest are computed separately: no overflow of the nanoseconds).
+					 * @param[in] _nbSample Number of sample.
+					 * @param[in] _frequency Frequency of the flow (not 0).
+					 * @return Duration of the samples.
+					 */
+					static audio::Duration getSampleDuration(uint64_t _nbSample, uint32_t _frequency);
+				protected:
+					/**
+					 * @brief Process one period of the node (called with m_mutex locked).
+					 * @param[in] _time Time of the first sample of the period.
+					 */
+					virtual void processPeriod(const audio::Time& _time) = 0;
+					/**
+					 * @brief Process the next period and update the sample counter (m_mutex must be locked).
+					 */
+					void processNextPeriod();
+					/**
+					 * @brief Timer thread: call the node every nb-chunk period.
+					 */
+					void threadCallback();
+				protected:
+					virtual void start();
+					virtual void stop();
+			};
+		}
+	}
+}
@@ -10,272 +10,438 @@
 #include <audio/river/debug.hpp>
 #include <ememory/memory.hpp>
 
-int32_t audio::river::io::NodeFile::recordCallback(const void* _inputBuffer,
-                                                   const audio::Time& _timeInput,
-                                                   uint32_t _nbChunk,
-                                                   const etk::Vector<audio::orchestra::status>& _status) {
-	ethread::UniqueLock lock(m_mutex);
-	// TODO : Manage status ...
-	RIVER_VERBOSE("data Input size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size());
-	newInput(_inputBuffer, _nbChunk, _timeInput);
-	return 0;
+extern "C" {
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <string.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 }
 
-int32_t audio::river::io::NodeFile::playbackCallback(void* _outputBuffer,
-                                                     const audio::Time& _timeOutput,
-                                                     uint32_t _nbChunk,
-                                                     const etk::Vector<audio::orchestra::status>& _status) {
-	ethread::UniqueLock lock(m_mutex);
-	// TODO : Manage status ...
-	RIVER_VERBOSE("data Output size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size());
-	newOutput(_outputBuffer, _nbChunk, _timeOutput);
-	return 0;
+// Size of the standard wav header (RIFF + fmt + data)
+static const size_t wavHeaderSize = 44;
+// Maximum size of the samples in a wav file (the sizes of the header are on 32 bits)
+static const uint64_t wavMaxDataSize = 0xFFFFFFFFULL - 36;
+// Size of a 'fmt ' chunk with the WAVE_FORMAT_EXTENSIBLE extension (sub-format GUID at the offset 24)
+static const uint32_t wavFmtExtensibleSize = 40;
+// Granularity of the growing of the output file (in period)
+static const size_t outputGrowStep = 512;
+
+static uint16_t getLE16(const uint8_t* _data) {
+	return uint16_t(_data[0]) | (uint16_t(_data[1]) << 8);
+}
+
+static uint32_t getLE32(const uint8_t* _data) {
+	return uint32_t(_data[0]) | (uint32_t(_data[1]) << 8) | (uint32_t(_data[2]) << 16) | (uint32_t(_data[3]) << 24);
+}
+
+static void setLE16(uint8_t* _data, uint16_t _value) {
+	_data[0] = _value & 0xFF;
+	_data[1] = (_value >> 8) & 0xFF;
+}
+
+static void setLE32(uint8_t* _data, uint32_t _value) {
+	_data[0] = _value & 0xFF;
+	_data[1] = (_value >> 8) & 0xFF;
+	_data[2] = (_value >> 16) & 0xFF;
+	_data[3] = (_value >> 24) & 0xFF;
 }
 
+static bool isWavFile(const etk::String& _fileName) {
+	if (_fileName.size() < 4) {
+		return false;
+	}
+	const char* extention = ".wav";
+	for (size_t iii=0; iii<4; ++iii) {
+		char value = _fileName[_fileName.size()-4+iii];
+		if (value >= 'A' && value <= 'Z') {
+			value += 'a'-'A';
+		}
+		if (value != extention[iii]) {
+			return false;
+		}
+	}
+	return true;
+}
 
+/**
+ * @brief Convert an audio format in a wav format.
+ * @param[in] _format Audio format.
+ * @param[out] _wavFormat Wav format tag (1: PCM, 3: float).
+ * @param[out] _nbBits Number of bits per sample.
+ * @return true The format can be stored in a wav file.
+ */
+static bool getWavFormat(enum audio::format _format, uint16_t& _wavFormat, uint16_t& _nbBits) {
+	switch (_format) {
+		case audio::format_int16:
+			_wavFormat = 1;
+			_nbBits = 16;
+			return true;
+		case audio::format_int32:
+			_wavFormat = 1;
+			_nbBits = 32;
+			return true;
+		case audio::format_float:
+			_wavFormat = 3;
+			_nbBits = 32;
+			return true;
+		case audio::format_double:
+			_wavFormat = 3;
+			_nbBits = 64;
+			return true;
+		default:
+			break;
+	}
+	return false;
+}
 
-ememory::SharedPtr<audio::river::io::NodeFile> audio::river::io::NodeFile::create(const etk::Path& _path, const ejson::Object& _config) {
-	return ememory::SharedPtr<audio::river::io::NodeFile>(ETK_NEW(audio::river::io::NodeFile, _path, _config));
+ememory::SharedPtr<audio::river::io::NodeFile> audio::river::io::NodeFile::create(const etk::String& _name, const ejson::Object& _config) {
+	return ememory::SharedPtr<audio::river::io::NodeFile>(ETK_NEW(audio::river::io::NodeFile, _name, _config));
 }
 
-audio::river::io::NodeFile::NodeFile(const etk::Path& _path, const ejson::Object& _config) :
-  Node(_path.getString(), _config) {
+audio::river::io::NodeFile::NodeFile(const etk::String& _name, const ejson::Object& _config) :
+  NodeClock(_name, _config),
+  m_isWav(false),
+  m_fileDescriptor(-1),
+  m_data(null),
+  m_dataSize(0),
+  m_headerSize(0),
+  m_dataEnd(0),
+  m_position(0),
+  m_frameSize(0),
+  m_restartAtEnd(false),
+  m_endReached(false) {
 	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
 	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
 	/**
-		map-on:{ # select hardware interface and name
-			interface:"alsa", # interface : "alsa", "pulse", "core", ...
-			name:"default", # name of the interface
+		map-on:{ # select the file
+			path:"/home/xxx/record.wav", # path of the file (wav header if extention is ".wav", raw otherwise)
+			loop:true, # restart at the start of the file when the end is reach (input only)
 		},
-		nb-chunk:1024 # number of chunk to open device (create the latency anf the frequency to call user)
+		nb-chunk:1024 # number of chunk send at each period (create the latency and the frequency to call user)
 	*/
-	etk::String typeInterface = audio::orchestra::type::undefined;
-	etk::String streamName = "default";
 	const ejson::Object tmpObject = m_config["map-on"].toObject();
 	if (tmpObject.exist() == false) {
-		RIVER_WARNING("missing node : 'map-on' ==> auto map : 'auto:default'");
+		RIVER_ERROR("missing node : 'map-on' ==> can not open a file node without 'path'");
+		return;
+	}
+	m_fileName = tmpObject["path"].toString().get();
+	m_restartAtEnd = tmpObject["loop"].toBoolean().get(false);
+	m_isWav = isWavFile(m_fileName);
+	if (m_isInput == true) {
+		if (openInput(hardwareFormat) == false) {
+			closeFile();
+			return;
+		}
+		interfaceFormat.setFrequency(hardwareFormat.getFrequency());
+		interfaceFormat.setMap(hardwareFormat.getMap());
 	} else {
-		typeInterface = tmpObject.getStringValue("interface", audio::orchestra::type::undefined);
-		if (typeInterface == "auto") {
-			typeInterface = audio::orchestra::type::undefined;
+		if (openOutput() == false) {
+			closeFile();
+			return;
 		}
-		streamName = tmpObject.getStringValue("name", "default");
 	}
-	int32_t nbChunk = m_config.getNumberValue("nb-chunk", 1024);
-	
-	// intanciate specific API ...
-	m_interface.instanciate(typeInterface);
-	m_interface.setName(_name);
-	// TODO : Check return ...
-	etk::String type = m_config.getStringValue("type", "int16");
-	if (streamName == "") {
-		streamName = "default";
-	}
-	
-	// search device ID :
-	RIVER_INFO("Open :");
-	RIVER_INFO("    m_streamName=" << streamName);
+	RIVER_INFO("Open file :");
+	RIVER_INFO("    m_fileName=" << m_fileName << (m_isWav==true?" (wav)":" (raw)"));
 	RIVER_INFO("    m_freq=" << hardwareFormat.getFrequency());
 	RIVER_INFO("    m_map=" << hardwareFormat.getMap());
 	RIVER_INFO("    m_format=" << hardwareFormat.getFormat());
 	RIVER_INFO("    m_isInput=" << m_isInput);
-	int32_t deviceId = -1;
-	/*
-	// TODO : Remove this from here (create an extern interface ...)
-	RIVER_INFO("Device list:");
-	for (int32_t iii=0; iii<m_interface.getDeviceCount(); ++iii) {
-		m_info = m_interface.getDeviceInfo(iii);
-		RIVER_INFO("    " << iii << " name :" << m_info.name);
-		m_info.display(2);
-	}
-	*/
-	// special case for default IO:
-	if (streamName == "default") {
-		if (m_isInput == true) {
-			deviceId = m_interface.getDefaultInputDevice();
-		} else {
-			deviceId = m_interface.getDefaultOutputDevice();
-		}
+	RIVER_INFO("    m_loop=" << m_restartAtEnd);
+	if (m_isInput == true) {
+		m_process.setInputConfig(hardwareFormat);
+		m_process.setOutputConfig(interfaceFormat);
 	} else {
-		for (int32_t iii=0; iii<m_interface.getDeviceCount(); ++iii) {
-			m_info = m_interface.getDeviceInfo(iii);
-			if (m_info.name == streamName) {
-				RIVER_INFO("    Select ... id =" << iii);
-				deviceId = iii;
-			}
-		}
+		m_process.setInputConfig(interfaceFormat);
+		m_process.setOutputConfig(hardwareFormat);
 	}
-	// TODO : Check if the devace with the specific name exist ...
-	/*
-	if (deviceId == -1) {
-		RIVER_ERROR("Can not find the " << streamName << " audio interface ... (use O default ...)");
-		deviceId = 0;
+	m_frameSize = audio::getFormatBytes(hardwareFormat.getFormat())*hardwareFormat.getMap().size();
+	// Preallocate the buffer used when the read wrap at the end of the file:
+	m_buffer.resize(m_frameSize*m_nbChunk, 0);
+	m_process.updateInterAlgo();
+}
+
+audio::river::io::NodeFile::~NodeFile() {
+	if (m_thread != null) {
+		stop();
 	}
-	*/
-	
-	// Open specific ID :
-	if (deviceId == -1) {
-		m_info = m_interface.getDeviceInfo(streamName);
-	} else {
-		m_info = m_interface.getDeviceInfo(deviceId);
+	ethread::UniqueLock lock(m_mutex);
+	RIVER_INFO("close file: " << m_fileName);
+	closeFile();
+};
+
+bool audio::river::io::NodeFile::openInput(audio::drain::IOFormatInterface& _hardwareFormat) {
+	m_fileDescriptor = ::open(m_fileName.c_str(), O_RDONLY);
+	if (m_fileDescriptor < 0) {
+		RIVER_ERROR("Can not open the file: '" << m_fileName << "' : " << strerror(errno));
+		return false;
+	}
+	struct stat fileStat;
+	if (    fstat(m_fileDescriptor, &fileStat) != 0
+	     || fileStat.st_size == 0) {
+		RIVER_ERROR("Can not read the size of the file (or empty file): '" << m_fileName << "'");
+		return false;
+	}
+	m_dataSize = fileStat.st_size;
+	void* data = mmap(null, m_dataSize, PROT_READ, MAP_SHARED, m_fileDescriptor, 0);
+	if (data == MAP_FAILED) {
+		RIVER_ERROR("Can not map the file: '" << m_fileName << "' : " << strerror(errno));
+		m_dataSize = 0;
+		return false;
 	}
-	// display property :
-	{
-		RIVER_INFO("Device " << deviceId << " - '" << streamName << "' property :");
-		m_info.display();
-		
-		if (etk::isIn(hardwareFormat.getFormat(), m_info.nativeFormats) == false) {
-			if (type == "auto") {
-				if (etk::isIn(audio::format_int16, m_info.nativeFormats) == true) {
-					hardwareFormat.setFormat(audio::format_int16);
-					RIVER_INFO("auto set format: " << hardwareFormat.getFormat());
-				} else if (etk::isIn(audio::format_float, m_info.nativeFormats) == true) {
-					hardwareFormat.setFormat(audio::format_float);
-					RIVER_INFO("auto set format: " << hardwareFormat.getFormat());
-				} else if (etk::isIn(audio::format_int16_on_int32, m_info.nativeFormats) == true) {
-					hardwareFormat.setFormat(audio::format_int16_on_int32);
-					RIVER_INFO("auto set format: " << hardwareFormat.getFormat());
-				} else if (etk::isIn(audio::format_int24, m_info.nativeFormats) == true) {
-					hardwareFormat.setFormat(audio::format_int24);
-					RIVER_INFO("auto set format: " << hardwareFormat.getFormat());
-				} else if (m_info.nativeFormats.size() != 0) {
-					hardwareFormat.setFormat(m_info.nativeFormats[0]);
-					RIVER_INFO("auto set format: " << hardwareFormat.getFormat());
-				} else {
-					RIVER_CRITICAL("auto set format no element in the configuration: " << m_info.nativeFormats);
+	m_data = static_cast<uint8_t*>(data);
+	// The file is read sequentially:
+	madvise(m_data, m_dataSize, MADV_SEQUENTIAL);
+	m_headerSize = 0;
+	m_dataEnd = m_dataSize;
+	if (m_isWav == true) {
+		if (    m_dataSize < 12
+		     || memcmp(m_data, "RIFF", 4) != 0
+		     || memcmp(m_data+8, "WAVE", 4) != 0) {
+			RIVER_ERROR("Not a wav file: '" << m_fileName << "'");
+			return false;
+		}
+		uint16_t wavFormat = 0;
+		uint16_t nbChannel = 0;
+		uint32_t frequency = 0;
+		uint16_t nbBits = 0;
+		size_t offset = 12;
+		while (offset+8 <= m_dataSize) {
+			uint32_t chunkSize = getLE32(m_data+offset+4);
+			if (memcmp(m_data+offset, "fmt ", 4) == 0) {
+				if (    chunkSize < 16
+				     || offset+8+16 > m_dataSize) {
+					RIVER_ERROR("Wrong wav 'fmt ' chunk: '" << m_fileName << "'");
+					return false;
 				}
-			} else {
-				RIVER_CRITICAL("Can not manage input transforamtion: " << hardwareFormat.getFormat() << " not in " << m_info.nativeFormats);
+				wavFormat = getLE16(m_data+offset+8);
+				nbChannel = getLE16(m_data+offset+10);
+				frequency = getLE32(m_data+offset+12);
+				nbBits = getLE16(m_data+offset+22);
+				if (wavFormat == 0xFFFE) {
+					if (    chunkSize < wavFmtExtensibleSize
+					     || offset+8+wavFmtExtensibleSize > m_dataSize) {
+						RIVER_ERROR("Wrong wav 'fmt ' chunk (WAVE_FORMAT_EXTENSIBLE with a size of " << chunkSize << "): '" << m_fileName << "'");
+						return false;
+					}
+					// WAVE_FORMAT_EXTENSIBLE: the real format is the first element of the sub-format GUID
+					wavFormat = getLE16(m_data+offset+32);
+				}
+			} else if (memcmp(m_data+offset, "data", 4) == 0) {
+				m_headerSize = offset+8;
+				m_dataEnd = etk::min(m_dataSize, m_headerSize+chunkSize);
+				break;
 			}
+			// chunk are aligned on 2 bytes
+			offset += 8 + chunkSize + (chunkSize&1);
+		}
+		if (    m_headerSize == 0
+		     || nbChannel == 0) {
+			RIVER_ERROR("Can not find the 'fmt ' or 'data' chunk in the wav file: '" << m_fileName << "'");
+			return false;
+		}
+		enum audio::format format = audio::format_unknow;
+		if (wavFormat == 1 && nbBits == 16) {
+			format = audio::format_int16;
+		} else if (wavFormat == 1 && nbBits == 32) {
+			format = audio::format_int32;
+		} else if (wavFormat == 3 && nbBits == 32) {
+			format = audio::format_float;
+		} else if (wavFormat == 3 && nbBits == 64) {
+			format = audio::format_double;
+		} else {
+			RIVER_ERROR("Not supported wav format=" << wavFormat << " bits=" << nbBits << " in: '" << m_fileName << "'");
+			return false;
+		}
+		if (format != _hardwareFormat.getFormat()) {
+			RIVER_INFO("wav set format: " << format);
+			_hardwareFormat.setFormat(format);
+		}
+		if (frequency != _hardwareFormat.getFrequency()) {
+			RIVER_INFO("wav set frequency: " << frequency);
+			_hardwareFormat.setFrequency(frequency);
 		}
-		if (etk::isIn(hardwareFormat.getFrequency(), m_info.sampleRates) == false) {
-			if (etk::isIn(48000, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(48000);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (etk::isIn(44100, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(44100);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (etk::isIn(32000, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(32000);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (etk::isIn(16000, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(16000);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (etk::isIn(8000, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(8000);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (etk::isIn(96000, m_info.sampleRates) == true) {
-				hardwareFormat.setFrequency(96000);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
-			} else if (m_info.sampleRates.size() != 0) {
-				hardwareFormat.setFrequency(m_info.sampleRates[0]);
-				RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency() << "(first element in list) in " << m_info.sampleRates);
+		if (nbChannel != _hardwareFormat.getMap().size()) {
+			etk::Vector<audio::channel> map;
+			if (nbChannel == 1) {
+				map.pushBack(audio::channel_frontCenter);
+			} else if (nbChannel == 2) {
+				map.pushBack(audio::channel_frontLeft);
+				map.pushBack(audio::channel_frontRight);
 			} else {
-				RIVER_CRITICAL("Can not manage input transforamtion:" << hardwareFormat.getFrequency() << " not in " << m_info.sampleRates);
+				RIVER_ERROR("wav file has " << nbChannel << " channels and 'channel-map' has " << _hardwareFormat.getMap().size() << " ==> set the 'channel-map' in the configuration");
+				return false;
 			}
-			interfaceFormat.setFrequency(hardwareFormat.getFrequency());
+			RIVER_INFO("wav set map: " << map);
+			_hardwareFormat.setMap(map);
 		}
 	}
-	
-	// open Audio device:
-	audio::orchestra::StreamParameters params;
-	params.deviceId = deviceId;
-	params.deviceName = streamName;
-	params.nChannels = hardwareFormat.getMap().size();
-	if (m_info.channels.size() < params.nChannels) {
-		RIVER_CRITICAL("Can not open hardware device with more channel (" << params.nChannels << ") that is autorized by hardware (" << m_info.channels.size() << ").");
+	m_position = m_headerSize;
+	m_endReached = false;
+	return true;
+}
+
+bool audio::river::io::NodeFile::openOutput() {
+	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
+	if (m_isWav == true) {
+		uint16_t wavFormat = 0;
+		uint16_t nbBits = 0;
+		if (getWavFormat(hardwareFormat.getFormat(), wavFormat, nbBits) == false) {
+			RIVER_WARNING("Can not store format " << hardwareFormat.getFormat() << " in a wav file ==> write raw data in: '" << m_fileName << "'");
+			m_isWav = false;
+		}
 	}
-	audio::orchestra::StreamOptions option;
-	etk::from_string(option.mode, tmpObject->getStringValue("timestamp-mode", "soft"));
-	
-	RIVER_DEBUG("interfaceFormat=" << interfaceFormat);
-	RIVER_DEBUG("hardwareFormat=" << hardwareFormat);
-	
-	m_rtaudioFrameSize = nbChunk;
-	RIVER_INFO("Open output stream nbChannels=" << params.nChannels);
-	enum audio::orchestra::error err = audio::orchestra::error_none;
-	if (m_isInput == true) {
-		m_process.setInputConfig(hardwareFormat);
-		m_process.setOutputConfig(interfaceFormat);
-		err = m_interface.openStream(null,
-		                             &params,
-		                             hardwareFormat.getFormat(),
-		                             hardwareFormat.getFrequency(),
-		                             &m_rtaudioFrameSize,
-		                             [=](const void* _data,
-		                                 const audio::Time& _time,
-		                                 size_t _nbChunk,
-		                                 enum audio::format _format,
-		                                 uint32_t _frequency,
-		                                 const etk::Vector<audio::channel>& _map
-		                                 ) {
-		                             	recordCallback(_data, _time, _nbChunk, _map);
-		                             },
-		                             option
-		                             );
-	} else {
-		m_process.setInputConfig(interfaceFormat);
-		m_process.setOutputConfig(hardwareFormat);
-		err = m_interface.openStream(&params,
-		                             null,
-		                             hardwareFormat.getFormat(),
-		                             hardwareFormat.getFrequency(),
-		                             &m_rtaudioFrameSize,
-		                             [=](const void* _data,
-		                                 const audio::Time& _time,
-		                                 size_t _nbChunk,
-		                                 enum audio::format _format,
-		                                 uint32_t _frequency,
-		                                 const etk::Vector<audio::channel>& _map
-		                                 ) {
-		                             	playbackCallback(_data, _time, _nbChunk, _map);
-		                             },
-		                             option
-		                        );
+	m_fileDescriptor = ::open(m_fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fileDescriptor < 0) {
+		RIVER_ERROR("Can not create the file: '" << m_fileName << "' : " << strerror(errno));
+		return false;
 	}
-	if (err != audio::orchestra::error_none) {
-		RIVER_ERROR("Create stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not create stream " << err);
+	m_headerSize = 0;
+	if (m_isWav == true) {
+		m_headerSize = wavHeaderSize;
 	}
-	m_process.updateInterAlgo();
+	m_position = m_headerSize;
+	m_dataEnd = m_headerSize;
+	size_t frameSize = audio::getFormatBytes(hardwareFormat.getFormat())*hardwareFormat.getMap().size();
+	if (growOutput(m_headerSize + frameSize*m_nbChunk*outputGrowStep) == false) {
+		return false;
+	}
+	return true;
 }
 
-audio::river::io::NodeFile::~NodeFile() {
-	ethread::UniqueLock lock(m_mutex);
-	RIVER_INFO("close input stream");
-	if (m_interface.isStreamOpen() ) {
-		m_interface.closeStream();
+bool audio::river::io::NodeFile::growOutput(size_t _size) {
+	if (_size <= m_dataSize) {
+		return true;
 	}
-};
-
-void audio::river::io::NodeFile::threadCallback() {
-	etk::thread::setName("RIVER file-IO");
-	// open the file
-	
-	while (m_alive == true) {
-		ethread::sleepMilliSeconds((100));
+	size_t newSize = etk::max(_size, m_dataSize*2);
+	if (m_data != null) {
+		munmap(m_data, m_dataSize);
+		m_data = null;
+	}
+	if (ftruncate(m_fileDescriptor, newSize) != 0) {
+		RIVER_ERROR("Can not resize the file: '" << m_fileName << "' : " << strerror(errno));
+		m_dataSize = 0;
+		return false;
+	}
+	void* data = mmap(null, newSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fileDescriptor, 0);
+	if (data == MAP_FAILED) {
+		RIVER_ERROR("Can not map the file: '" << m_fileName << "' : " << strerror(errno));
+		m_dataSize = 0;
+		return false;
 	}
-	
+	m_data = static_cast<uint8_t*>(data);
+	m_dataSize = newSize;
+	return true;
 }
 
-void audio::river::io::NodeFile::start() {
-	ethread::UniqueLock lock(m_mutex);
-	if (m_thread != null) {
-		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"read":"write") << " ==> already started ..." );
-		return;
+void audio::river::io::NodeFile::closeFile() {
+	if (    m_isInput == false
+	     && m_data != null) {
+		if (m_isWav == true) {
+			audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
+			uint16_t wavFormat = 1;
+			uint16_t nbBits = 16;
+			getWavFormat(hardwareFormat.getFormat(), wavFormat, nbBits);
+			uint16_t nbChannel = hardwareFormat.getMap().size();
+			uint32_t frequency = hardwareFormat.getFrequency();
+			uint32_t dataSize = m_dataEnd - m_headerSize;
+			memcpy(m_data, "RIFF", 4);
+			setLE32(m_data+4, 36 + dataSize);
+			memcpy(m_data+8, "WAVE", 4);
+			memcpy(m_data+12, "fmt ", 4);
+			setLE32(m_data+16, 16);
+			setLE16(m_data+20, wavFormat);
+			setLE16(m_data+22, nbChannel);
+			setLE32(m_data+24, frequency);
+			setLE32(m_data+28, frequency*nbChannel*(nbBits/8));
+			setLE16(m_data+32, nbChannel*(nbBits/8));
+			setLE16(m_data+34, nbBits);
+			memcpy(m_data+36, "data", 4);
+			setLE32(m_data+40, dataSize);
+		}
+		munmap(m_data, m_dataSize);
+		m_data = null;
+		// remove the preallocated area:
+		if (ftruncate(m_fileDescriptor, m_dataEnd) != 0) {
+			RIVER_ERROR("Can not set the final size of the file: '" << m_fileName << "' : " << strerror(errno));
+		}
+	}
+	if (m_data != null) {
+		munmap(m_data, m_dataSize);
+		m_data = null;
+	}
+	m_dataSize = 0;
+	if (m_fileDescriptor >= 0) {
+		::close(m_fileDescriptor);
+		m_fileDescriptor = -1;
 	}
-	m_alive = true;
-	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"read":"write") );
-	m_thread = ememory::makeShared<ethread::Thread>(&audio::river::io::NodeFile::threadCallback2, this);
-	m_time = audio::Time::now();
 }
 
-void audio::river::io::NodeFile::stop() {
-	ethread::UniqueLock lock(m_mutex);
-	m_alive = false;
-	RIVER_INFO("Stop stream : '" << m_name << "' mode=" << (m_isInput?"read":"write") );
-	// TODO : Need join ...
-	m_thread->join();
-	m_thread.reset();
+void audio::river::io::NodeFile::processPeriod(const audio::Time& _time) {
+	if (    m_data == null
+	     || m_frameSize == 0) {
+		return;
+	}
+	size_t periodSize = m_frameSize*m_nbChunk;
+	if (m_isInput == true) {
+		if (m_endReached == true) {
+			// keep the clock alive with silence
+			memset(&m_buffer[0], 0, periodSize);
+			newInput(&m_buffer[0], m_nbChunk, _time);
+			return;
+		}
+		if (m_position + periodSize <= m_dataEnd) {
+			// direct access on the mapped file (no copy)
+			newInput(m_data+m_position, m_nbChunk, _time);
+			m_position += periodSize;
+			return;
+		}
+		// End of the file: fill the temporary buffer
+		size_t offset = 0;
+		while (offset < periodSize) {
+			size_t availlable = etk::min(periodSize-offset, m_dataEnd-m_position);
+			availlable -= availlable%m_frameSize;
+			if (availlable == 0) {
+				if (    m_restartAtEnd == true
+				     && m_dataEnd-m_headerSize >= m_frameSize) {
+					m_position = m_headerSize;
+					continue;
+				}
+				RIVER_INFO("End of the file: '" << m_fileName << "' ==> continue with silence");
+				m_endReached = true;
+				memset(&m_buffer[offset], 0, periodSize-offset);
+				break;
+			}
+			memcpy(&m_buffer[offset], m_data+m_position, availlable);
+			offset += availlable;
+			m_position += availlable;
+		}
+		newInput(&m_buffer[0], m_nbChunk, _time);
+		return;
+	}
+	if (    m_isWav == true
+	     && m_position + periodSize - m_headerSize > wavMaxDataSize) {
+		// the sizes of the wav header are on 32 bits: the file is closed at 4 GB
+		if (m_endReached == false) {
+			RIVER_ERROR("The wav file is full (4 GB): '" << m_fileName << "' ==> drop data");
+			m_endReached = true;
+		}
+		newOutput(&m_buffer[0], m_nbChunk, _time);
+		return;
+	}
+	if (m_position + periodSize > m_dataSize) {
+		// need to grow the file (rare: done every outputGrowStep period)
+		if (growOutput(m_position + periodSize*outputGrowStep) == false) {
+			RIVER_ERROR("Can not write in the file: '" << m_fileName << "' ==> drop data");
+			newOutput(&m_buffer[0], m_nbChunk, _time);
+			return;
+		}
+	}
+	// the node mix directly in the mapped file
+	newOutput(m_data+m_position, m_nbChunk, _time);
+	m_position += periodSize;
+	m_dataEnd = m_position;
 }
 
 #endif
@@ -7,8 +7,7 @@
 
 #ifdef AUDIO_RIVER_BUILD_FILE
 
-#include <audio/river/io/Node.hpp>
-#include <audio/orchestra/Interface.hpp>
+#include <audio/river/io/NodeClock.hpp>
 
 namespace audio {
 	namespace river {
@@ -16,37 +15,72 @@ namespace audio {
 			class Manager;
 			class Group;
 			/**
-			 * @brief Low level node that is manage on the interface with the extern lib airtaudio
+			 * @brief Low level node that read or write a raw/wav file (memory mapped) clocked like an hardware (see @ref NodeClock).
+			 * @code
+			 * file-in:{
+			 * 	io:"file-input", # "file-input" or "file-output"
+			 * 	map-on:{
+			 * 		path:"/home/xxx/record.wav", # ".wav" extention: use the header to configure the node
+			 * 		loop:true, # restart at the start of the file when the end is reach
+			 * 	},
+			 * 	frequency:48000,
+			 * 	channel-map:["front-left", "front-right"],
+			 * 	type:"int16",
+			 * 	nb-chunk:1024,
+			 * 	clock:"timer",
+			 * 	mux-demux-type:"int16",
+			 * },
+			 * @endcode
 			 */
-			class NodeFile : public audio::river::io::Node {
+			class NodeFile : public audio::river::io::NodeClock {
 				friend class audio::river::io::Group;
 				protected:
 					/**
 					 * @brief Constructor
 					 */
-					NodeFile(const etk::Path& _path, const ejson::Object& _config);
+					NodeFile(const etk::String& _name, const ejson::Object& _config);
 				public:
-					static ememory::SharedPtr<NodeFile> create(const etk::Path& _path, const ejson::Object& _config);
+					static ememory::SharedPtr<NodeFile> create(const etk::String& _name, const ejson::Object& _config);
 					/**
 					 * @brief Destructor
 					 */
 					virtual ~NodeFile();
-					virtual bool isHarwareNode() {
-						return true;
-					};
 				protected:
-					audio::Time m_time; //!< time of the flow
-					ememory::SharedPtr<etk::io::Interface>& m_file; //!< File interface
+					etk::String m_fileName; //!< Path of the file
+					bool m_isWav; //!< The file has a wav header
+					int m_fileDescriptor; //!< File descriptor of the file
+					uint8_t* m_data; //!< Memory map of the file
+					size_t m_dataSize; //!< Size of the memory map
+					size_t m_headerSize; //!< Offset of the first sample in the file
+					size_t m_dataEnd; //!< Offset of the end of the samples (read: end of data chunk, write: current written size)
+					size_t m_position; //!< Current position in the file
+					size_t m_frameSize; //!< Size of one chunk in the file
 					bool m_restartAtEnd; //!< The read is done in loop
-					uint32_t m_sampleRate; //!< Sample Rate of the Raw file
-					audio::format m_format; //!< Format of the file
-					etk::Vector<audio::channel> m_map; //!< Map of the file
-					ememory::SharedPtr<ethread::Thread> m_thread; //!< playing thread of the flow
-					bool m_alive; //!< thread is active
+					bool m_endReached; //!< The end of the file has been reach
+					etk::Vector<uint8_t> m_buffer; //!< Temporary buffer (when the read wrap at the end of the file)
 				protected:
-					virtual void start();
-					virtual void stop();
-					virtual void threadCallback():
+					/**
+					 * @brief Open and map the input file (parse the wav header if needed).
+					 * @param[in,out] _hardwareFormat Format of the file.
+					 * @return true The file is ready to read.
+					 */
+					bool openInput(audio::drain::IOFormatInterface& _hardwareFormat);
+					/**
+					 * @brief Create and map the output file (write the wav header if needed).
+					 * @return true The file is ready to write.
+					 */
+					bool openOutput();
+					/**
+					 * @brief Grow the output file and the memory map.
+					 * @param[in] _size Minimum size requested.
+					 * @return true The map is large enought.
+					 */
+					bool growOutput(size_t _size);
+					/**
+					 * @brief Close the file (set the real size of an output file).
+					 */
+					void closeFile();
+					virtual void processPeriod(const audio::Time& _time);
 			};
 		}
 	}
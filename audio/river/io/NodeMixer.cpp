@@ -0,0 +1,178 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/NodeMixer.hpp>
+#include <audio/river/debug.hpp>
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Function.hpp>
+
+ememory::SharedPtr<audio::river::io::NodeMixer> audio::river::io::NodeMixer::create(const etk::String& _name, const ejson::Object& _config) {
+	return ememory::SharedPtr<audio::river::io::NodeMixer>(ETK_NEW(audio::river::io::NodeMixer, _name, _config));
+}
+
+ememory::SharedPtr<audio::river::Interface> audio::river::io::NodeMixer::createOutput(float _freq,
+                                                                      const etk::Vector<audio::channel>& _map,
+                                                                      audio::format _format,
+                                                                      const etk::String& _objectName,
+                                                                      const etk::String& _name) {
+	// check if the output exist
+	const ejson::Object tmppp = m_config[_objectName].toObject();
+	if (tmppp.exist() == false) {
+		RIVER_ERROR("can not open a non existance virtual interface: '" << _objectName << "' not present in : " << m_config.getKeys());
+		return ememory::SharedPtr<audio::river::Interface>();
+	}
+	etk::String streamName = tmppp["map-on"].toString().get("error");
+	
+	// check if it is an Output:
+	etk::String type = tmppp["io"].toString().get("error");
+	if (type != "output") {
+		RIVER_ERROR("can not open in input a mixer bus: '" << streamName << "' configured has : " << type);
+		return ememory::SharedPtr<audio::river::Interface>();
+	}
+	// get global hardware interface:
+	ememory::SharedPtr<audio::river::io::Manager> manager = audio::river::io::Manager::getInstance();
+	// get the output channel :
+	ememory::SharedPtr<audio::river::io::Node> node = manager->getNode(streamName);
+	if (node == null) {
+		RIVER_ERROR("can not open the parent node of the mixer bus: '" << streamName << "'");
+		return ememory::SharedPtr<audio::river::Interface>();
+	}
+	// create user iterface:
+	ememory::SharedPtr<audio::river::Interface> interface;
+	interface = audio::river::Interface::create(_freq, _map, _format, node, tmppp);
+	if (interface != null) {
+		interface->setName(_name);
+	}
+	return interface;
+}
+
+
+audio::river::io::NodeMixer::NodeMixer(const etk::String& _name, const ejson::Object& _config) :
+  Node(_name, _config) {
+	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
+	/**
+		io:"mixer",
+		# format of the bus (the interfaces are mixed with "mux-demux-type")
+		frequency:48000,
+		channel-map:["front-left", "front-right"],
+		type:"int16",
+		nb-chunk:1024,
+		mux-demux-type:"int16-on-int32",
+		# volume applied once on the result of the bus (optionnal)
+		bus-volume:"SFX",
+		# parent of the bus
+		map-on-output:{
+			io:"output",
+			map-on:"speaker",
+			resampling-type:"speexdsp",
+			resampling-option:"quality=10"
+		},
+	*/
+	RIVER_INFO("Create BUS OUTPUT : ");
+	m_interfaceOutput = createOutput(hardwareFormat.getFrequency(),
+	                                 hardwareFormat.getMap(),
+	                                 hardwareFormat.getFormat(),
+	                                 "map-on-output",
+	                                 _name + "-MIXER-output");
+	if (m_interfaceOutput == null) {
+		RIVER_ERROR("Can not opne virtual device ... map-on-output in " << _name);
+		return;
+	}
+	etk::String busVolume = m_config["bus-volume"].toString().get();
+	if (busVolume != "") {
+		RIVER_INFO("add bus volume stage : '" << busVolume << "'");
+		m_interfaceOutput->addVolumeGroup(busVolume);
+	}
+	// set callback mode ...
+	m_interfaceOutput->setOutputCallback([=](void* _data,
+	                                         const audio::Time& _time,
+	                                         size_t _nbChunk,
+	                                         enum audio::format _format,
+	                                         uint32_t _frequency,
+	                                         const etk::Vector<audio::channel>& _map) {
+	                                         	onDataNeeded(_data, _time, _nbChunk, _format, _frequency, _map);
+	                                         });
+	m_process.updateInterAlgo();
+}
+
+audio::river::io::NodeMixer::~NodeMixer() {
+	RIVER_INFO("close mixer bus");
+	stop();
+	m_interfaceOutput.reset();
+};
+
+void audio::river::io::NodeMixer::start() {
+	ethread::UniqueLock lock(m_mutex);
+	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_interfaceOutput != null) {
+		RIVER_INFO("Start BUS OUTPUT : ");
+		m_interfaceOutput->start();
+	}
+}
+
+void audio::river::io::NodeMixer::stop() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_interfaceOutput != null) {
+		m_interfaceOutput->stop();
+	}
+}
+
+void audio::river::io::NodeMixer::onDataNeeded(void* _data,
+                                               const audio::Time& _time,
+                                               size_t _nbChunk,
+                                               enum audio::format _format,
+                                               uint32_t _frequency,
+                                               const etk::Vector<audio::channel>& _map) {
+	RIVER_VERBOSE("Mixer Time=" << _time << " _nbChunk=" << _nbChunk << " _map=" << _map << " _format=" << _format << " freq=" << _frequency);
+	if (    _format != m_process.getOutputConfig().getFormat()
+	     || _map.size() != m_process.getOutputConfig().getMap().size()) {
+		RIVER_ERROR("call wrong type ... (need " << m_process.getOutputConfig().getFormat() << " on " << m_process.getOutputConfig().getMap().size() << " channels)");
+		return;
+	}
+	// mix all the interfaces of the bus in the buffer of the parent
+	ethread::UniqueLock lock(m_mutex);
+	newOutput(_data, _nbChunk, _time);
+}
+
+void audio::river::io::NodeMixer::generateDot(ememory::SharedPtr<etk::io::Interface>& _io) {
+	*_io << "	subgraph clusterNode_" << m_uid << " {\n";
+	*_io << "		color=blue;\n";
+	*_io << "		label=\"[" << m_uid << "] IO::Node : " << m_name << "\";\n";
+		*_io << "			NODE_" << m_uid << "_HW_MIXER [ label=\"MIXER\\n channelMap=" << etk::toString(getHarwareFormat().getMap()) << "\" ];\n";
+		etk::String nameIn;
+		etk::String nameOut;
+		m_process.generateDotProcess(_io, 3, m_uid, nameIn, nameOut, true);
+		*_io << "		node [shape=square];\n";
+		*_io << "			NODE_" << m_uid << "_muxer [ label=\"MUXER\\n format=" << etk::toString(m_process.getInputConfig().getFormat()) << "\" ];\n";
+		// Link all nodes :
+		*_io << "			NODE_" << m_uid << "_muxer -> " << nameIn << ";\n";
+		*_io << "			" << nameOut << " -> NODE_" << m_uid << "_HW_MIXER;\n";
+	*_io << "	}\n";
+	if (m_interfaceOutput != null) {
+		*_io << "	NODE_" << m_uid << "_HW_MIXER -> " << m_interfaceOutput->getDotNodeName() << ";\n";
+	}
+	*_io << "	\n";
+	
+	for (size_t iii=0; iii< m_listAvaillable.size(); ++iii) {
+		if (m_listAvaillable[iii].expired() == true) {
+			continue;
+		}
+		ememory::SharedPtr<audio::river::Interface> element = m_listAvaillable[iii].lock();
+		if (element == null) {
+			continue;
+		}
+		bool isLink = false;
+		for (size_t jjj=0; jjj<m_list.size(); ++jjj) {
+			if (element == m_list[jjj]) {
+				isLink = true;
+			}
+		}
+		if (element->getMode() == modeInterface_output) {
+			element->generateDot(_io, "NODE_" + etk::toString(m_uid) + "_muxer", isLink);
+		}
+	}
+}
@@ -0,0 +1,56 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <audio/river/io/Node.hpp>
+#include <audio/river/Interface.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			class Manager;
+			/**
+			 * @brief Submix bus: mix all the output interfaces connected on it at its own rate and format, and play the result as one
+			 * output interface of its parent node ("map-on-output"). The conversion (resampling) to the parent and the volume of the
+			 * bus ("bus-volume") are applied once for all the streams of the bus.
+			 */
+			class NodeMixer : public Node {
+				protected:
+					/**
+					 * @brief Constructor
+					 */
+					NodeMixer(const etk::String& _name, const ejson::Object& _config);
+				public:
+					static ememory::SharedPtr<NodeMixer> create(const etk::String& _name, const ejson::Object& _config);
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~NodeMixer();
+				protected:
+					virtual void start();
+					virtual void stop();
+					ememory::SharedPtr<audio::river::Interface> m_interfaceOutput; //!< Interface of the bus on the parent node
+					ememory::SharedPtr<audio::river::Interface> createOutput(float _freq,
+					                                               const etk::Vector<audio::channel>& _map,
+					                                               audio::format _format,
+					                                               const etk::String& _streamName,
+					                                               const etk::String& _name);
+					/**
+					 * @brief Stream data request callback of the parent node: mix the interfaces of the bus.
+					 */
+					void onDataNeeded(void* _data,
+					                  const audio::Time& _time,
+					                  size_t _nbChunk,
+					                  enum audio::format _format,
+					                  uint32_t _frequency,
+					                  const etk::Vector<audio::channel>& _map);
+				public:
+					virtual void generateDot(ememory::SharedPtr<etk::io::Interface>& _io);
+			};
+		}
+	}
+}
+
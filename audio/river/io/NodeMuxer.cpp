@@ -50,12 +50,20 @@ ememory::SharedPtr<audio::river::Interface> audio::river::io::NodeMuxer::createI
 
 
 audio::river::io::NodeMuxer::NodeMuxer(const etk::String& _name, const ejson::Object& _config) :
-  Node(_name, _config) {
+  Node(_name, _config),
+  m_nbChunk(256) {
 	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
 	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
-	m_sampleTime = audio::Duration(1000000000/int64_t(hardwareFormat.getFrequency()));
+	m_worker.configure(m_config, hardwareFormat.getFrequency());
+	m_nbChunk = m_config["nb-chunk"].toNumber().get(256);
+	if (m_nbChunk == 0) {
+		m_nbChunk = 256;
+	}
+	// the first input is the reference of the synchronization
+	m_synchronizer.init(hardwareFormat.getFrequency(), m_nbChunk, m_config["drift-compensation"].toBoolean().get(false));
+	m_synchronizer.setLatency(m_worker.getLatency());
 	/**
-		# connect in input mode
+		# connect in input mode (any number of input: map-on-input-1, map-on-input-2, map-on-input-3 ...)
 		map-on-input-1:{
 			# generic virtual definition
 			io:"input",
@@ -71,364 +79,237 @@ audio::river::io::NodeMuxer::NodeMuxer(const etk::String& _name, const ejson::Ob
 			resampling-option:"quality=10",
 		},
 		input-2-remap:["rear-left", "rear-right"], # remap the IO inputs ...
-		# AEC algo definition
-		algo:"river-remover",
-		algo-mode:"cutter",
+		nb-chunk:256, # number of sample muxed at each process
+		drift-compensation:false, # resample the inputs to follow the clock of the first one (no jump in the flows)
+		# process in a dedicated thread (optionnal)
+		worker:{
+			latency:10, # ms
+		},
 	*/
-	RIVER_INFO("Create IN 1 : ");
-	m_interfaceInput1 = createInput(hardwareFormat.getFrequency(),
-	                                etk::Vector<audio::channel>(),
-	                                hardwareFormat.getFormat(),
-	                                "map-on-input-1",
-	                                _name + "-muxer-in1");
-	if (m_interfaceInput1 == null) {
-		RIVER_ERROR("Can not opne virtual device ... map-on-input-1 in " << _name);
-		return;
-	}
-	const ejson::Array listChannelMap = m_config["input-1-remap"].toArray();
-	if (    listChannelMap.exist() == false
-	     || listChannelMap.size() == 0) {
-		m_mapInput1 = m_interfaceInput1->getInterfaceFormat().getMap();
-	} else {
-		m_mapInput1.clear();
-		for (const auto it : listChannelMap) {
-			etk::String value = it.toString().get();
-			m_mapInput1.pushBack(audio::getChannelFromString(value));
+	for (size_t iii=1; true; ++iii) {
+		etk::String objectName = "map-on-input-" + etk::toString(iii);
+		if (m_config[objectName].toObject().exist() == false) {
+			break;
 		}
-		if (m_mapInput1.size() != m_interfaceInput1->getInterfaceFormat().getMap().size()) {
-			RIVER_ERROR("Request remap of the Input 1 the 2 size is wrong ... request=");
-			m_mapInput1 = m_interfaceInput1->getInterfaceFormat().getMap();
+		RIVER_INFO("Create IN " << iii << " : ");
+		ememory::SharedPtr<MuxerInput> input = ememory::makeShared<MuxerInput>();
+		input->m_interface = createInput(hardwareFormat.getFrequency(),
+		                                 etk::Vector<audio::channel>(),
+		                                 hardwareFormat.getFormat(),
+		                                 objectName,
+		                                 _name + "-muxer-in" + etk::toString(iii));
+		if (input->m_interface == null) {
+			RIVER_ERROR("Can not opne virtual device ... " << objectName << " in " << _name);
+			m_inputs.clear();
+			return;
+		}
+		const ejson::Array listChannelMap = m_config["input-" + etk::toString(iii) + "-remap"].toArray();
+		if (    listChannelMap.exist() == false
+		     || listChannelMap.size() == 0) {
+			input->m_map = input->m_interface->getInterfaceFormat().getMap();
+		} else {
+			input->m_map.clear();
+			for (const auto it : listChannelMap) {
+				etk::String value = it.toString().get();
+				input->m_map.pushBack(audio::getChannelFromString(value));
+			}
+			if (input->m_map.size() != input->m_interface->getInterfaceFormat().getMap().size()) {
+				RIVER_ERROR("Request remap of the Input " << iii << " the 2 size is wrong ... request=");
+				input->m_map = input->m_interface->getInterfaceFormat().getMap();
+			}
 		}
+		size_t id = m_synchronizer.addSource(hardwareFormat.getFormat(), input->m_map.size(), echrono::milliseconds(1000));
+		// set callback mode ...
+		input->m_interface->setInputCallback([=](const void* _data,
+		                                         const audio::Time& _time,
+		                                         size_t _nbChunk,
+		                                         enum audio::format _format,
+		                                         uint32_t _frequency,
+		                                         const etk::Vector<audio::channel>& _map) {
+		                                         	onDataReceivedInput(id, _data, _time, _nbChunk, _format, _frequency, _map);
+		                                         });
+		// a xrun on one of the device break the alignment of the flows: restart the synchronization
+		input->m_interface->setStatusFunction([=](const etk::String& _origin, const etk::String& _status) {
+		                                      	if (_origin == "xrun") {
+		                                      		m_synchronizer.clear();
+		                                      	}
+		                                      });
+		m_inputs.pushBack(input);
 	}
-	
-	RIVER_INFO("Create IN 2 : ");
-	m_interfaceInput2 = createInput(hardwareFormat.getFrequency(),
-	                                etk::Vector<audio::channel>(),
-	                                hardwareFormat.getFormat(),
-	                                "map-on-input-2",
-	                                _name + "-muxer-in2");
-	if (m_interfaceInput2 == null) {
-		RIVER_ERROR("Can not opne virtual device ... map-on-input-2 in " << _name);
+	if (m_inputs.size() == 0) {
+		RIVER_ERROR("No input in the muxer '" << _name << "' (need map-on-input-1)");
 		return;
 	}
-	const ejson::Array listChannelMap2 = m_config["input-2-remap"].toArray();
-	if (    listChannelMap2.exist() == false
-	     || listChannelMap2.size() == 0) {
-		m_mapInput2 = m_interfaceInput2->getInterfaceFormat().getMap();
-	} else {
-		m_mapInput2.clear();
-		for (const auto it : listChannelMap2) {
-			etk::String value = it.toString().get();
-			m_mapInput2.pushBack(audio::getChannelFromString(value));
-		}
-		if (m_mapInput2.size() != m_interfaceInput2->getInterfaceFormat().getMap().size()) {
-			RIVER_ERROR("Request remap of the Input 2 the 2 size is wrong ... request=");
-			m_mapInput2 = m_interfaceInput2->getInterfaceFormat().getMap();
-		}
-	}
-	
-	// set callback mode ...
-	m_interfaceInput1->setInputCallback([=](const void* _data,
-	                                        const audio::Time& _time,
-	                                        size_t _nbChunk,
-	                                        enum audio::format _format,
-	                                        uint32_t _frequency,
-	                                        const etk::Vector<audio::channel>& _map) {
-	                                        	onDataReceivedInput1(_data, _time, _nbChunk, _format, _frequency, _map);
-	                                        });
-	// set callback mode ...
-	m_interfaceInput2->setInputCallback([=](const void* _data,
-	                                        const audio::Time& _time,
-	                                        size_t _nbChunk,
-	                                        enum audio::format _format,
-	                                        uint32_t _frequency,
-	                                        const etk::Vector<audio::channel>& _map) {
-	                                        	onDataReceivedInput2(_data, _time, _nbChunk, _format, _frequency, _map);
-	                                        });
-	
-	m_bufferInput1.setCapacity(echrono::milliseconds(1000),
-	                           audio::getFormatBytes(hardwareFormat.getFormat())*m_mapInput1.size(),
-	                           hardwareFormat.getFrequency());
-	m_bufferInput2.setCapacity(echrono::milliseconds(1000),
-	                           audio::getFormatBytes(hardwareFormat.getFormat())*m_mapInput2.size(),
-	                           hardwareFormat.getFrequency());
-	
+	m_data.resize(m_nbChunk*audio::getFormatBytes(getInterfaceFormat().getFormat())*getInterfaceFormat().getMap().size(), 0);
+	updateRouting();
 	m_process.updateInterAlgo();
 }
 
 audio::river::io::NodeMuxer::~NodeMuxer() {
 	RIVER_INFO("close input stream");
 	stop();
-	m_interfaceInput1.reset();
-	m_interfaceInput2.reset();
+	m_inputs.clear();
 };
 
+void audio::river::io::NodeMuxer::updateRouting() {
+	const etk::Vector<audio::channel>& outputMap = getInterfaceFormat().getMap();
+	m_routes.clear();
+	for (size_t kkk=0; kkk<outputMap.size(); ++kkk) {
+		MuxerRoute route;
+		route.m_output = kkk;
+		for (size_t iii=0; iii<m_inputs.size(); ++iii) {
+			const etk::Vector<audio::channel>& inputMap = m_inputs[iii]->m_map;
+			if (outputMap.size() == 1) {
+				// mono output: mean of all the channels
+				for (size_t jjj=0; jjj<inputMap.size(); ++jjj) {
+					route.m_input.pushBack(iii);
+					route.m_channel.pushBack(jjj);
+					route.m_stride.pushBack(inputMap.size());
+				}
+				continue;
+			}
+			if (    inputMap.size() == 1
+			     && inputMap[0] == audio::channel_frontCenter) {
+				route.m_input.pushBack(iii);
+				route.m_channel.pushBack(0);
+				route.m_stride.pushBack(1);
+				continue;
+			}
+			for (size_t jjj=0; jjj<inputMap.size(); ++jjj) {
+				if (outputMap[kkk] == inputMap[jjj]) {
+					route.m_input.pushBack(iii);
+					route.m_channel.pushBack(jjj);
+					route.m_stride.pushBack(inputMap.size());
+					break;
+				}
+			}
+		}
+		route.m_source.resize(route.m_input.size(), null);
+		route.m_gain = 1.0;
+		if (route.m_input.size() > 1) {
+			route.m_gain = 1.0/double(route.m_input.size());
+		}
+		RIVER_INFO("Muxer route: " << outputMap[kkk] << " <== input=" << route.m_input << " channel=" << route.m_channel);
+		m_routes.pushBack(route);
+	}
+}
+
 void audio::river::io::NodeMuxer::start() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
-	if (m_interfaceInput1 != null) {
-		RIVER_INFO("Start FEEDBACK : ");
-		m_interfaceInput1->start();
-	}
-	if (m_interfaceInput2 != null) {
-		RIVER_INFO("Start Microphone : ");
-		m_interfaceInput2->start();
+	m_threadPolicyApplied = false;
+	m_worker.start("RIVER muxer", [=](){this->onWorker();});
+	for (size_t iii=0; iii<m_inputs.size(); ++iii) {
+		RIVER_INFO("Start input " << iii+1 << " : ");
+		m_inputs[iii]->m_interface->start();
 	}
 }
 
 void audio::river::io::NodeMuxer::stop() {
-	ethread::UniqueLock lock(m_mutex);
-	if (m_interfaceInput1 != null) {
-		m_interfaceInput1->stop();
-	}
-	if (m_interfaceInput2 != null) {
-		m_interfaceInput2->stop();
+	{
+		ethread::UniqueLock lock(m_mutex);
+		for (size_t iii=0; iii<m_inputs.size(); ++iii) {
+			m_inputs[iii]->m_interface->stop();
+		}
 	}
+	// join without the lock: the worker need it to finish the current process.
+	m_worker.stop();
 }
 
 
-void audio::river::io::NodeMuxer::onDataReceivedInput1(const void* _data,
-                                                       const audio::Time& _time,
-                                                       size_t _nbChunk,
-                                                       enum audio::format _format,
-                                                       uint32_t _frequency,
-                                                       const etk::Vector<audio::channel>& _map) {
-	RIVER_PRINT("Input-1 Time=" << _time << " _nbChunk=" << _nbChunk << " _map=" << _map << " _format=" << _format << " freq=" << _frequency);
-	RIVER_DEBUG("        next=" << _time + audio::Duration(0, _nbChunk*1000000000LL/int64_t(_frequency)) );
-	/*
-	if (_format != audio::format_int16) {
-		RIVER_ERROR("call wrong type ... (need int16_t)");
-	}
-	*/
+void audio::river::io::NodeMuxer::onDataReceivedInput(size_t _id,
+                                                      const void* _data,
+                                                      const audio::Time& _time,
+                                                      size_t _nbChunk,
+                                                      enum audio::format _format,
+                                                      uint32_t _frequency,
+                                                      const etk::Vector<audio::channel>& _map) {
+	RIVER_VERBOSE("Input-" << _id+1 << " Time=" << _time << " _nbChunk=" << _nbChunk << " _map=" << _map << " _format=" << _format << " freq=" << _frequency);
+	RIVER_VERBOSE("        next=" << _time + audio::Duration(0, _nbChunk*1000000000LL/int64_t(_frequency)) );
 	// push data synchronize
+	m_synchronizer.write(_id, _data, _nbChunk, _time);
+	if (m_worker.isEnable() == true) {
+		m_worker.notify();
+		return;
+	}
 	ethread::UniqueLock lock(m_mutex);
-	m_bufferInput1.write(_data, _nbChunk, _time);
-	//RIVER_SAVE_FILE_MACRO(int16_t, "REC_muxer_input_1.raw", _data, _nbChunk*_map.size());
 	process();
 }
 
-void audio::river::io::NodeMuxer::onDataReceivedInput2(const void* _data,
-                                                       const audio::Time& _time,
-                                                       size_t _nbChunk,
-                                                       enum audio::format _format,
-                                                       uint32_t _frequency,
-                                                       const etk::Vector<audio::channel>& _map) {
-	RIVER_PRINT("Input-2 Time=" << _time << " _nbChunk=" << _nbChunk << " _map=" << _map << " _format=" << _format << " freq=" << _frequency);
-	RIVER_DEBUG("        next=" << _time + audio::Duration(0, _nbChunk*1000000000LL/int64_t(_frequency)) );
-	/*
-	if (_format != audio::format_int16) {
-		RIVER_ERROR("call wrong type ... (need int16_t)");
-	}
-	*/
-	// push data synchronize
+void audio::river::io::NodeMuxer::onWorker() {
 	ethread::UniqueLock lock(m_mutex);
-	m_bufferInput2.write(_data, _nbChunk, _time);
-	//RIVER_SAVE_FILE_MACRO(int16_t, "REC_muxer_input_2.raw", _data, _nbChunk*_map.size());
+	applyThreadPolicy();
 	process();
 }
 
 void audio::river::io::NodeMuxer::process() {
-	if (m_bufferInput1.getSize() <= 256) {
-		return;
-	}
-	if (m_bufferInput2.getSize() <= 256) {
+	if (    m_inputs.size() == 0
+	     || m_data.size() == 0) {
 		return;
 	}
-	RIVER_PRINT("process : s1=" << m_bufferInput1.getSize() << " s2=" << m_bufferInput2.getSize());
-	audio::Time in1Time = m_bufferInput1.getReadTimeStamp();
-	audio::Time in2Time = m_bufferInput2.getReadTimeStamp();
-	audio::Duration delta;
-	if (in1Time < in2Time) {
-		delta = in2Time - in1Time;
-	} else {
-		delta = in1Time - in2Time;
+	audio::Time inTime;
+	// the rings are locked only during the synchronization: the callbacks are not blocked by the muxer
+	while (m_synchronizer.acquire(inTime) == true) {
+		processMuxer(m_nbChunk, inTime);
+		m_synchronizer.release();
 	}
-	RIVER_VERBOSE("check delta " << delta << " > " << m_sampleTime);
-	if (delta > m_sampleTime) {
-		// Synchronize if possible
-		if (in1Time < in2Time) {
-			RIVER_INFO("in1Time < in2Time : Change Input-1 time start " << in2Time);
-			RIVER_INFO("                                 old time stamp=" << m_bufferInput1.getReadTimeStamp());
-			m_bufferInput1.setReadPosition(in2Time);
-			RIVER_INFO("                                 new time stamp=" << m_bufferInput1.getReadTimeStamp());
+}
+
+template<typename TYPE, typename ACCUMULATOR>
+void audio::river::io::NodeMuxer::applyRouting(uint32_t _nbChunk) {
+	const size_t nbOutput = getInterfaceFormat().getMap().size();
+	TYPE* output = reinterpret_cast<TYPE*>(&m_data[0]);
+	for (auto &route : m_routes) {
+		TYPE* out = output + route.m_output;
+		if (route.m_input.size() == 0) {
+			for (size_t iii=0; iii<_nbChunk; ++iii) {
+				out[iii*nbOutput] = 0;
+			}
+			continue;
 		}
-		if (in1Time > in2Time) {
-			RIVER_INFO("in1Time > in2Time : Change Input-2 time start " << in1Time);
-			RIVER_INFO("                               old time stamp=" << m_bufferInput2.getReadTimeStamp());
-			m_bufferInput2.setReadPosition(in1Time);
-			RIVER_INFO("                               new time stamp=" << m_bufferInput2.getReadTimeStamp());
+		if (route.m_input.size() == 1) {
+			const TYPE* in = static_cast<const TYPE*>(m_synchronizer.getData(route.m_input[0])) + route.m_channel[0];
+			const size_t nbInput = route.m_stride[0];
+			for (size_t iii=0; iii<_nbChunk; ++iii) {
+				out[iii*nbOutput] = in[iii*nbInput];
+			}
+			continue;
 		}
-	}
-	// check if enought time after synchronisation ...
-	if (m_bufferInput1.getSize() <= 256) {
-		return;
-	}
-	if (m_bufferInput2.getSize() <= 256) {
-		return;
-	}
-	
-	in1Time = m_bufferInput1.getReadTimeStamp();
-	in2Time = m_bufferInput2.getReadTimeStamp();
-	
-	if (in1Time-in2Time > m_sampleTime) {
-		RIVER_ERROR("Can not synchronize flow ... : " << in1Time << " != " << in2Time << "  delta = " << (in1Time-in2Time));
-		return;
-	}
-	etk::Vector<uint8_t> dataIn1;
-	etk::Vector<uint8_t> dataIn2;
-	dataIn1.resize(256*audio::getFormatBytes(getInterfaceFormat().getFormat())*m_mapInput1.size(), 0);
-	dataIn2.resize(256*audio::getFormatBytes(getInterfaceFormat().getFormat())*m_mapInput2.size(), 0);
-	m_data.resize(256*audio::getFormatBytes(getInterfaceFormat().getFormat())*getInterfaceFormat().getMap().size(), 0);
-	while (true) {
-		in1Time = m_bufferInput1.getReadTimeStamp();
-		in2Time = m_bufferInput2.getReadTimeStamp();
-		//RIVER_INFO(" process 256 samples ... in1Time=" << in1Time << " in2Time=" << in2Time << " delta = " << (in1Time-in2Time));
-		m_bufferInput1.read(&dataIn1[0], 256);
-		m_bufferInput2.read(&dataIn2[0], 256);
-		//RIVER_SAVE_FILE_MACRO(int16_t, "REC_muxer_output_1.raw", &dataIn1[0], 256 * m_mapInput1.size());
-		//RIVER_SAVE_FILE_MACRO(int16_t, "REC_muxer_output_2.raw", &dataIn2[0], 256 * m_mapInput2.size());
-		// if threaded : send event / otherwise, process ...
-		processMuxer(&dataIn1[0], &dataIn2[0], 256, in1Time);
-		if (    m_bufferInput1.getSize() <= 256
-		     || m_bufferInput2.getSize() <= 256) {
-			return;
+		// the chunks are in the rings of the synchronizer: get their position once per process
+		for (size_t jjj=0; jjj<route.m_input.size(); ++jjj) {
+			route.m_source[jjj] = static_cast<const TYPE*>(m_synchronizer.getData(route.m_input[jjj])) + route.m_channel[jjj];
+		}
+		for (size_t iii=0; iii<_nbChunk; ++iii) {
+			ACCUMULATOR value = 0;
+			for (size_t jjj=0; jjj<route.m_input.size(); ++jjj) {
+				value += static_cast<const TYPE*>(route.m_source[jjj])[iii*route.m_stride[jjj]];
+			}
+			out[iii*nbOutput] = TYPE(double(value)*route.m_gain);
 		}
 	}
 }
 
-
-void audio::river::io::NodeMuxer::reorder(void* _output, uint32_t _nbChunk, void* _input, const etk::Vector<audio::channel>& _mapInput) {
-	// real process: (only depend of data size):
+void audio::river::io::NodeMuxer::processMuxer(uint32_t _nbChunk, const audio::Time& _time) {
 	switch (getInterfaceFormat().getFormat()) {
 		case audio::format_int8:
-			{
-				RIVER_VERBOSE("convert " << _mapInput << " ==> " << getInterfaceFormat().getMap());
-				int8_t* in = static_cast<int8_t*>(_input);
-				int8_t* out = static_cast<int8_t*>(_output);
-				for (size_t kkk=0; kkk<getInterfaceFormat().getMap().size(); ++kkk) {
-					int32_t convertId = -1;
-					if (    _mapInput.size() == 1
-					     && _mapInput[0] == audio::channel_frontCenter) {
-						convertId = 0;
-					} else {
-						for (size_t jjj=0; jjj<_mapInput.size(); ++jjj) {
-							if (getInterfaceFormat().getMap()[kkk] == _mapInput[jjj]) {
-								convertId = jjj;
-								break;
-							}
-						}
-					}
-					RIVER_VERBOSE("    " << convertId << " ==> " << kkk);
-					if (convertId != -1) {
-						for (size_t iii=0; iii<_nbChunk; ++iii) {
-							out[iii*getInterfaceFormat().getMap().size()+kkk] = in[iii*_mapInput.size()+convertId];
-						}
-					}
-				}
-			}
+			applyRouting<int8_t, int32_t>(_nbChunk);
 			break;
 		default:
 		case audio::format_int16:
-			if (getInterfaceFormat().getMap().size() == 1) {
-				RIVER_VERBOSE("convert " << _mapInput << " ==> " << getInterfaceFormat().getMap());
-				int16_t* in = static_cast<int16_t*>(_input);
-				int16_t* out = static_cast<int16_t*>(_output);
-				for (size_t iii=0; iii<_nbChunk; ++iii) {
-					int32_t val = 0;
-					for (size_t jjj=0; jjj<_mapInput.size(); ++jjj) {
-						val += in[iii*_mapInput.size()+jjj];
-					}
-					out[iii] = val/_mapInput.size();
-				}
-			} else {
-				RIVER_VERBOSE("convert " << _mapInput << " ==> " << getInterfaceFormat().getMap());
-				int16_t* in = static_cast<int16_t*>(_input);
-				int16_t* out = static_cast<int16_t*>(_output);
-				for (size_t kkk=0; kkk<getInterfaceFormat().getMap().size(); ++kkk) {
-					int32_t convertId = -1;
-					if (    _mapInput.size() == 1
-					     && _mapInput[0] == audio::channel_frontCenter) {
-						convertId = 0;
-					} else {
-						for (size_t jjj=0; jjj<_mapInput.size(); ++jjj) {
-							if (getInterfaceFormat().getMap()[kkk] == _mapInput[jjj]) {
-								convertId = jjj;
-								break;
-							}
-						}
-					}
-					RIVER_VERBOSE("    " << convertId << " ==> " << kkk);
-					if (convertId != -1) {
-						for (size_t iii=0; iii<_nbChunk; ++iii) {
-							out[iii*getInterfaceFormat().getMap().size()+kkk] = in[iii*_mapInput.size()+convertId];
-						}
-					}
-				}
-			}
+			applyRouting<int16_t, int32_t>(_nbChunk);
 			break;
 		case audio::format_int16_on_int32:
 		case audio::format_int24:
 		case audio::format_int32:
+			applyRouting<int32_t, int64_t>(_nbChunk);
+			break;
 		case audio::format_float:
-			{
-				RIVER_VERBOSE("convert (2) " << _mapInput << " ==> " << getInterfaceFormat().getMap());
-				uint32_t* in = static_cast<uint32_t*>(_input);
-				uint32_t* out = static_cast<uint32_t*>(_output);
-				for (size_t kkk=0; kkk<getInterfaceFormat().getMap().size(); ++kkk) {
-					int32_t convertId = -1;
-					if (    _mapInput.size() == 1
-					     && _mapInput[0] == audio::channel_frontCenter) {
-						convertId = 0;
-					} else {
-						for (size_t jjj=0; jjj<_mapInput.size(); ++jjj) {
-							if (getInterfaceFormat().getMap()[kkk] == _mapInput[jjj]) {
-								convertId = jjj;
-								break;
-							}
-						}
-					}
-					if (convertId != -1) {
-						for (size_t iii=0; iii<_nbChunk; ++iii) {
-							out[iii*getInterfaceFormat().getMap().size()+kkk] = in[iii*_mapInput.size()+convertId];
-						}
-					}
-				}
-			}
+			applyRouting<float, float>(_nbChunk);
 			break;
 		case audio::format_double:
-			{
-				RIVER_VERBOSE("convert (2) " << _mapInput << " ==> " << getInterfaceFormat().getMap());
-				uint64_t* in = static_cast<uint64_t*>(_input);
-				uint64_t* out = static_cast<uint64_t*>(_output);
-				for (size_t kkk=0; kkk<getInterfaceFormat().getMap().size(); ++kkk) {
-					int32_t convertId = -1;
-					if (    _mapInput.size() == 1
-					     && _mapInput[0] == audio::channel_frontCenter) {
-						convertId = 0;
-					} else {
-						for (size_t jjj=0; jjj<_mapInput.size(); ++jjj) {
-							if (getInterfaceFormat().getMap()[kkk] == _mapInput[jjj]) {
-								convertId = jjj;
-								break;
-							}
-						}
-					}
-					if (convertId != -1) {
-						for (size_t iii=0; iii<_nbChunk; ++iii) {
-							out[iii*getInterfaceFormat().getMap().size()+kkk] = in[iii*_mapInput.size()+convertId];
-						}
-					}
-				}
-			}
+			applyRouting<double, double>(_nbChunk);
 			break;
 	}
-}
-
-void audio::river::io::NodeMuxer::processMuxer(void* _dataIn1, void* _dataIn2, uint32_t _nbChunk, const audio::Time& _time) {
-	//RIVER_INFO("must Mux data : " << m_mapInput1 << " + " << m_mapInput2 << " ==> " << getInterfaceFormat().getMap());
-	memset(&m_data[0], 0, m_data.size());
-	reorder(&m_data[0], _nbChunk, _dataIn1, m_mapInput1);
-	reorder(&m_data[0], _nbChunk, _dataIn2, m_mapInput2);
 	newInput(&m_data[0], _nbChunk, _time);
 }
 
@@ -450,11 +331,8 @@ void audio::river::io::NodeMuxer::generateDot(ememory::SharedPtr<etk::io::Interf
 		*_io << "			NODE_" << m_uid << "_HW_MUXER -> " << nameIn << ";\n";
 		*_io << "			" << nameOut << " -> NODE_" << m_uid << "_demuxer;\n";
 	*_io << "	}\n";
-	if (m_interfaceInput2 != null) {
-		*_io << "	" << m_interfaceInput2->getDotNodeName() << " -> NODE_" << m_uid << "_HW_MUXER;\n";
-	}
-	if (m_interfaceInput1 != null) {
-		*_io << "	" << m_interfaceInput1->getDotNodeName() << " -> NODE_" << m_uid << "_HW_MUXER;\n";
+	for (size_t iii=0; iii<m_inputs.size(); ++iii) {
+		*_io << "	" << m_inputs[iii]->m_interface->getDotNodeName() << " -> NODE_" << m_uid << "_HW_MUXER;\n";
 	}
 	*_io << "	\n";
 	for (size_t iii=0; iii< m_listAvaillable.size(); ++iii) {
@@ -7,7 +7,8 @@
 
 #include <audio/river/io/Node.hpp>
 #include <audio/river/Interface.hpp>
-#include <audio/drain/CircularBuffer.hpp>
+#include <audio/river/io/NodeWorker.hpp>
+#include <audio/river/io/StreamSynchronizer.hpp>
 
 namespace audio {
 	namespace river {
@@ -15,6 +16,27 @@ namespace audio {
 			class Manager;
 			class NodeMuxer : public Node {
 				protected:
+					/**
+					 * @brief One source of the muxer ("map-on-input-N").
+					 */
+					class MuxerInput {
+						public:
+							ememory::SharedPtr<audio::river::Interface> m_interface; //!< Interface on the source node
+							etk::Vector<audio::channel> m_map; //!< Channel map of the source (after the "input-N-remap")
+					};
+					/**
+					 * @brief Routing of one output channel (compiled when the channel maps are known).
+					 * No source: the channel is set to 0, one source: copy, more sources: mean of the sources.
+					 */
+					class MuxerRoute {
+						public:
+							uint32_t m_output; //!< Id of the output channel
+							etk::Vector<uint32_t> m_input; //!< Id of the input of each source
+							etk::Vector<uint32_t> m_channel; //!< Id of the channel in the input of each source
+							etk::Vector<uint32_t> m_stride; //!< Number of channel of the input of each source
+							etk::Vector<const void*> m_source; //!< Position of each source in the current chunk
+							double m_gain; //!< Gain of the mean (1/number of sources)
+					};
 					/**
 					 * @brief Constructor
 					 */
@@ -28,37 +50,51 @@ namespace audio {
 				protected:
 					virtual void start();
 					virtual void stop();
-					ememory::SharedPtr<audio::river::Interface> m_interfaceInput1;
-					ememory::SharedPtr<audio::river::Interface> m_interfaceInput2;
+					etk::Vector<ememory::SharedPtr<MuxerInput>> m_inputs; //!< All the sources of the muxer
+					etk::Vector<MuxerRoute> m_routes; //!< Routing of each output channel
 					ememory::SharedPtr<audio::river::Interface> createInput(float _freq,
 					                                              const etk::Vector<audio::channel>& _map,
 					                                              audio::format _format,
 					                                              const etk::String& _streamName,
 					                                              const etk::String& _name);
-					void onDataReceivedInput1(const void* _data,
-					                          const audio::Time& _time,
-					                          size_t _nbChunk,
-					                          enum audio::format _format,
-					                          uint32_t _frequency,
-					                          const etk::Vector<audio::channel>& _map);
-					void onDataReceivedInput2(const void* _data,
-					                          const audio::Time& _time,
-					                          size_t _nbChunk,
-					                          enum audio::format _format,
-					                          uint32_t _frequency,
-					                          const etk::Vector<audio::channel>& _map);
-					etk::Vector<audio::channel> m_mapInput1;
-					etk::Vector<audio::channel> m_mapInput2;
-					audio::drain::CircularBuffer m_bufferInput1;
-					audio::drain::CircularBuffer m_bufferInput2;
-					audio::Duration m_sampleTime; //!< represent the sample time at the specify frequency.
+					/**
+					 * @brief Stream data input callback
+					 * @param[in] _id Id of the input.
+					 */
+					void onDataReceivedInput(size_t _id,
+					                         const void* _data,
+					                         const audio::Time& _time,
+					                         size_t _nbChunk,
+					                         enum audio::format _format,
+					                         uint32_t _frequency,
+					                         const etk::Vector<audio::channel>& _map);
+					/**
+					 * @brief Process the data in the worker thread.
+					 */
+					void onWorker();
+					audio::river::io::NodeWorker m_worker; //!< Optionnal processing thread
+					audio::river::io::StreamSynchronizer m_synchronizer; //!< Synchronization of the inputs (the only lock taken by the callbacks with a worker).
+					uint32_t m_nbChunk; //!< Number of sample muxed at each process
 					void process();
-					void processMuxer(void* _dataMic, void* _dataFB, uint32_t _nbChunk, const audio::Time& _time);
+					/**
+					 * @brief Mux the chunks of all the inputs (acquired in the synchronizer) and send the result to the interfaces.
+					 * @param[in] _nbChunk Number of sample.
+					 * @param[in] _time Time of the first sample.
+					 */
+					void processMuxer(uint32_t _nbChunk, const audio::Time& _time);
 					etk::Vector<uint8_t> m_data;
 				public:
 					virtual void generateDot(ememory::SharedPtr<etk::io::Interface>& _io);
 				private:
-					void reorder(void* _output, uint32_t _nbChunk, void* _input, const etk::Vector<audio::channel>& _mapInput);
+					/**
+					 * @brief Compile the routing of the output channels (called once the channel maps are known).
+					 */
+					void updateRouting();
+					/**
+					 * @brief Apply the routing on a specific sample type.
+					 * @param[in] _nbChunk Number of sample.
+					 */
+					template<typename TYPE, typename ACCUMULATOR> void applyRouting(uint32_t _nbChunk);
 			};
 		}
 	}
@@ -8,6 +8,8 @@
 
 #include <audio/river/io/NodeOrchestra.hpp>
 #include <audio/river/debug.hpp>
+#include <audio/river/io/Manager.hpp>
+#include <audio/river/io/DeviceCache.hpp>
 #include <ememory/memory.hpp>
 
 int32_t audio::river::io::NodeOrchestra::recordCallback(const void* _inputBuffer,
@@ -15,9 +17,18 @@ int32_t audio::river::io::NodeOrchestra::recordCallback(const void* _inputBuffer
                                                         uint32_t _nbChunk,
                                                         const etk::Vector<audio::orchestra::status>& _status) {
 	ethread::UniqueLock lock(m_mutex);
-	// TODO : Manage status ...
+	applyThreadPolicy();
+	for (auto &it : _status) {
+		if (it == audio::orchestra::status::overflow) {
+			xrun(false, _timeInput);
+		} else if (it == audio::orchestra::status::underflow) {
+			xrun(true, _timeInput);
+		}
+	}
 	RIVER_VERBOSE("data Input size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size());
+	processStart();
 	newInput(_inputBuffer, _nbChunk, _timeInput);
+	processStop(_nbChunk);
 	return 0;
 }
 
@@ -26,13 +37,66 @@ int32_t audio::river::io::NodeOrchestra::playbackCallback(void* _outputBuffer,
                                                           uint32_t _nbChunk,
                                                           const etk::Vector<audio::orchestra::status>& _status) {
 	ethread::UniqueLock lock(m_mutex);
-	// TODO : Manage status ...
+	applyThreadPolicy();
+	for (auto &it : _status) {
+		if (it == audio::orchestra::status::overflow) {
+			xrun(false, _timeOutput);
+		} else if (it == audio::orchestra::status::underflow) {
+			xrun(true, _timeOutput);
+		}
+	}
 	RIVER_VERBOSE("data Output size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size() << "  data=" << uint64_t(_outputBuffer));
+	processStart();
 	newOutput(_outputBuffer, _nbChunk, _timeOutput);
+	processStop(_nbChunk);
 	return 0;
 }
 
+/**
+ * @brief Get the fingerprint of the device list of the backend: a device plugged or removed change it.
+ * @note The device informations are not read (it is the slow probe that the cache avoid). A device swapped for an other
+ *       at the same place is detected when the stream can not be open with the cached capability.
+ * @param[in] _interface Backend interface.
+ * @param[in] _defaultDeviceId Id of the default device.
+ * @return Fingerprint string: "count/default".
+ */
+static etk::String getDeviceListFingerprint(audio::orchestra::Interface& _interface, int32_t _defaultDeviceId) {
+	return etk::toString(_interface.getDeviceCount()) + "/" + etk::toString(_defaultDeviceId);
+}
 
+/**
+ * @brief Probe the device of a stream in the backend.
+ * @param[in] _interface Backend interface.
+ * @param[in] _streamName Name of the stream ("default" for the default device).
+ * @param[in] _defaultDeviceId Id of the default device.
+ * @param[out] _info Information of the device.
+ * @return Id of the device (-1 if it is opened by name).
+ */
+static int32_t probeDevice(audio::orchestra::Interface& _interface,
+                           const etk::String& _streamName,
+                           int32_t _defaultDeviceId,
+                           audio::orchestra::DeviceInfo& _info) {
+	int32_t deviceId = -1;
+	// special case for default IO:
+	if (_streamName == "default") {
+		deviceId = _defaultDeviceId;
+	} else {
+		for (int32_t iii=0; iii<_interface.getDeviceCount(); ++iii) {
+			_info = _interface.getDeviceInfo(iii);
+			if (_info.name == _streamName) {
+				RIVER_INFO("    Select ... id =" << iii);
+				deviceId = iii;
+			}
+		}
+	}
+	// Open specific ID :
+	if (deviceId == -1) {
+		_info = _interface.getDeviceInfo(_streamName);
+	} else {
+		_info = _interface.getDeviceInfo(deviceId);
+	}
+	return deviceId;
+}
 
 ememory::SharedPtr<audio::river::io::NodeOrchestra> audio::river::io::NodeOrchestra::create(const etk::String& _name, const ejson::Object& _config) {
 	return ememory::SharedPtr<audio::river::io::NodeOrchestra>(ETK_NEW(audio::river::io::NodeOrchestra, _name, _config));
@@ -80,44 +144,36 @@ audio::river::io::NodeOrchestra::NodeOrchestra(const etk::String& _name, const e
 	RIVER_INFO("    m_format=" << hardwareFormat.getFormat());
 	RIVER_INFO("    m_isInput=" << m_isInput);
 	int32_t deviceId = -1;
-	/*
-	// TODO : Remove this from here (create an extern interface ...)
-	RIVER_INFO("Device list:");
-	for (int32_t iii=0; iii<m_interface.getDeviceCount(); ++iii) {
-		m_info = m_interface.getDeviceInfo(iii);
-		RIVER_INFO("    " << iii << " name :" << m_info.name);
-		m_info.display(2);
-	}
-	*/
-	// special case for default IO:
-	if (streamName == "default") {
-		if (m_isInput == true) {
-			deviceId = m_interface.getDefaultInputDevice();
-		} else {
-			deviceId = m_interface.getDefaultOutputDevice();
-		}
+	// The probe of the devices is slow: get it from the disk cache while the backend does not change
+	int32_t defaultDeviceId = -1;
+	if (m_isInput == true) {
+		defaultDeviceId = m_interface.getDefaultInputDevice();
 	} else {
-		for (int32_t iii=0; iii<m_interface.getDeviceCount(); ++iii) {
-			m_info = m_interface.getDeviceInfo(iii);
-			if (m_info.name == streamName) {
-				RIVER_INFO("    Select ... id =" << iii);
-				deviceId = iii;
-			}
-		}
-	}
-	// TODO : Check if the devace with the specific name exist ...
-	/*
-	if (deviceId == -1) {
-		RIVER_ERROR("Can not find the " << streamName << " audio interface ... (use O default ...)");
-		deviceId = 0;
+		defaultDeviceId = m_interface.getDefaultOutputDevice();
 	}
-	*/
-	
-	// Open specific ID :
-	if (deviceId == -1) {
-		m_info = m_interface.getDeviceInfo(streamName);
+	etk::String cacheKey = typeInterface + ":" + streamName + ":" + (m_isInput?"input":"output");
+	etk::String fingerprint = getDeviceListFingerprint(m_interface, defaultDeviceId);
+	audio::river::io::DeviceCapability capability;
+	ememory::SharedPtr<audio::river::io::Manager> manager = audio::river::io::Manager::getInstance();
+	bool fromCache = false;
+	if (    manager != null
+	     && manager->getDeviceCache().get(cacheKey, fingerprint, capability) == true) {
+		fromCache = true;
+		deviceId = capability.deviceId;
+		m_info.name = capability.name;
+		m_info.channels = capability.channels;
+		m_info.sampleRates = capability.sampleRates;
+		m_info.nativeFormats = capability.nativeFormats;
 	} else {
-		m_info = m_interface.getDeviceInfo(deviceId);
+		deviceId = probeDevice(m_interface, streamName, defaultDeviceId, m_info);
+		if (manager != null) {
+			capability.deviceId = deviceId;
+			capability.name = m_info.name;
+			capability.channels = m_info.channels;
+			capability.sampleRates = m_info.sampleRates;
+			capability.nativeFormats = m_info.nativeFormats;
+			manager->getDeviceCache().set(cacheKey, fingerprint, capability);
+		}
 	}
 	// display property :
 	{
@@ -179,27 +235,49 @@ audio::river::io::NodeOrchestra::NodeOrchestra(const etk::String& _name, const e
 	}
 	
 	// open Audio device:
-	audio::orchestra::StreamParameters params;
-	params.deviceId = deviceId;
-	params.deviceName = streamName;
-	params.nChannels = hardwareFormat.getMap().size();
-	if (m_info.channels.size() < params.nChannels) {
-		RIVER_ERROR("Can not open hardware device with more channel (" << params.nChannels << ") that is autorized by hardware (" << m_info.channels.size() << ").");
+	m_params.deviceId = deviceId;
+	m_params.deviceName = streamName;
+	m_params.nChannels = hardwareFormat.getMap().size();
+	if (m_info.channels.size() < m_params.nChannels) {
+		RIVER_ERROR("Can not open hardware device with more channel (" << m_params.nChannels << ") that is autorized by hardware (" << m_info.channels.size() << ").");
 	}
-	audio::orchestra::StreamOptions option;
-	etk::from_string(option.mode, tmpObject["timestamp-mode"].toString().get("soft"));
+	etk::from_string(m_option.mode, tmpObject["timestamp-mode"].toString().get("soft"));
 	
 	RIVER_DEBUG("interfaceFormat=" << interfaceFormat);
 	RIVER_DEBUG("hardwareFormat=" << hardwareFormat);
 	
-	m_rtaudioFrameSize = nbChunk;
-	RIVER_INFO("Open output stream nbChannels=" << params.nChannels);
-	enum audio::orchestra::error err = audio::orchestra::error_none;
+	m_nbChunk = nbChunk;
 	if (m_isInput == true) {
 		m_process.setInputConfig(hardwareFormat);
 		m_process.setOutputConfig(interfaceFormat);
+	} else {
+		m_process.setInputConfig(interfaceFormat);
+		m_process.setOutputConfig(hardwareFormat);
+	}
+	if (    openStream() == false
+	     && fromCache == true) {
+		// The device may have been swapped for an other one at the same place: probe it again
+		RIVER_WARNING("Can not open the stream with the cached capability of '" << streamName << "' ==> probe the device");
+		m_params.deviceId = probeDevice(m_interface, streamName, defaultDeviceId, m_info);
+		capability.deviceId = m_params.deviceId;
+		capability.name = m_info.name;
+		capability.channels = m_info.channels;
+		capability.sampleRates = m_info.sampleRates;
+		capability.nativeFormats = m_info.nativeFormats;
+		manager->getDeviceCache().set(cacheKey, fingerprint, capability);
+		openStream();
+	}
+	m_process.updateInterAlgo();
+}
+
+bool audio::river::io::NodeOrchestra::openStream() {
+	const audio::drain::IOFormatInterface& hardwareFormat = getHarwareFormat();
+	m_rtaudioFrameSize = m_nbChunk;
+	RIVER_INFO("Open output stream nbChannels=" << m_params.nChannels);
+	enum audio::orchestra::error err = audio::orchestra::error_none;
+	if (m_isInput == true) {
 		err = m_interface.openStream(null,
-		                             &params,
+		                             &m_params,
 		                             hardwareFormat.getFormat(),
 		                             hardwareFormat.getFrequency(),
 		                             &m_rtaudioFrameSize,
@@ -211,12 +289,10 @@ audio::river::io::NodeOrchestra::NodeOrchestra(const etk::String& _name, const e
 		                                  const etk::Vector<audio::orchestra::status>& _status) {
 		                                  	return recordCallback(_inputBuffer, _timeInput, _nbChunk, _status);
 		                                  },
-		                             option
+		                             m_option
 		                             );
 	} else {
-		m_process.setInputConfig(interfaceFormat);
-		m_process.setOutputConfig(hardwareFormat);
-		err = m_interface.openStream(&params,
+		err = m_interface.openStream(&m_params,
 		                             null,
 		                             hardwareFormat.getFormat(),
 		                             hardwareFormat.getFrequency(),
@@ -229,13 +305,35 @@ audio::river::io::NodeOrchestra::NodeOrchestra(const etk::String& _name, const e
 		                                  const etk::Vector<audio::orchestra::status>& _status) {
 		                                  	return playbackCallback(_outputBuffer, _timeOutput, _nbChunk, _status);
 		                                  },
-		                             option
+		                             m_option
 		                             );
 	}
 	if (err != audio::orchestra::error_none) {
 		RIVER_ERROR("Create stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not create stream " << err);
+		return false;
 	}
-	m_process.updateInterAlgo();
+	return true;
+}
+
+bool audio::river::io::NodeOrchestra::isStreamOpen() {
+	ethread::UniqueLock lock(m_mutex);
+	return m_interface.isStreamOpen();
+}
+
+void audio::river::io::NodeOrchestra::streamRelease() {
+	ethread::UniqueLock lock(m_mutex);
+	RIVER_INFO("Release stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_interface.isStreamOpen() == true) {
+		m_interface.closeStream();
+	}
+}
+
+bool audio::river::io::NodeOrchestra::streamRestore() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_interface.isStreamOpen() == true) {
+		return true;
+	}
+	return openStream();
 }
 
 audio::river::io::NodeOrchestra::~NodeOrchestra() {
@@ -249,6 +347,8 @@ audio::river::io::NodeOrchestra::~NodeOrchestra() {
 void audio::river::io::NodeOrchestra::start() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	// the backend can create a new thread for the callback
+	m_threadPolicyApplied = false;
 	enum audio::orchestra::error err = m_interface.startStream();
 	if (err != audio::orchestra::error_none) {
 		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not start stream ... " << err);
@@ -38,13 +38,26 @@ namespace audio {
 					audio::orchestra::Interface m_interface; //!< Real airtaudio interface
 					audio::orchestra::DeviceInfo m_info; //!< information on the stream.
 					unsigned int m_rtaudioFrameSize; // DEPRECATED soon...
+					audio::orchestra::StreamParameters m_params; //!< Device and channels of the stream
+					audio::orchestra::StreamOptions m_option; //!< Options of the stream (timestamp mode)
+					uint32_t m_nbChunk; //!< Number of chunk requested at each callback
+					/**
+					 * @brief Open the stream with the parameters of the node.
+					 * @return true The stream is open.
+					 */
+					bool openStream();
+				public:
+					virtual bool isStreamOpen();
+				protected:
+					virtual void streamRelease();
+					virtual bool streamRestore();
 				public:
 					/**
 					 * @brief Input Callback . Have recaive new data to process.
 					 * @param[in] _inputBuffer Pointer on the data buffer.
 					 * @param[in] _timeInput Time on the fist sample has been recorded.
 					 * @param[in] _nbChunk Number of chunk in the buffer
-					 * @param[in] _status DEPRECATED soon
+					 * @param[in] _status Status reported by the backend (underflow and overflow are counted as xrun)
 					 * @return DEPRECATED soon
 					 */
 					int32_t recordCallback(const void* _inputBuffer,
@@ -56,7 +69,7 @@ namespace audio {
 					 * @param[in,out] _outputBuffer Pointer on the buffer to fill data.
 					 * @param[in] _timeOutput Time on wich the data might be played.
 					 * @param[in] _nbChunk Number of chunk in the buffer
-					 * @param[in] _status DEPRECATED soon
+					 * @param[in] _status Status reported by the backend (underflow and overflow are counted as xrun)
 					 * @return DEPRECATED soon
 					 */
 					int32_t playbackCallback(void* _outputBuffer,
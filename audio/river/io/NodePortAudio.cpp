@@ -11,6 +11,89 @@
 #include <ememory/memory.hpp>
 #include <audio/Time.hpp>
 #include <audio/Duration.hpp>
+#include <audio/river/io/Manager.hpp>
+
+/**
+ * @brief Get the portaudio sample format that match a river format (no conversion in portaudio).
+ * @param[in] _format River format.
+ * @param[out] _paFormat Portaudio format.
+ * @return true The format exist in portaudio.
+ */
+static bool getPortAudioFormat(enum audio::format _format, PaSampleFormat& _paFormat) {
+	switch (_format) {
+		case audio::format_int8:
+			_paFormat = paInt8;
+			return true;
+		case audio::format_int16:
+			_paFormat = paInt16;
+			return true;
+		case audio::format_int24:
+			// portaudio only know the packed 24 bits
+			if (audio::getFormatBytes(audio::format_int24) != 3) {
+				return false;
+			}
+			_paFormat = paInt24;
+			return true;
+		case audio::format_int32:
+			_paFormat = paInt32;
+			return true;
+		case audio::format_float:
+			_paFormat = paFloat32;
+			return true;
+		default:
+			return false;
+	}
+}
+
+/**
+ * @brief Search a device with its host API name and its name.
+ * @param[in] _interface Name of the host API ("alsa", "pulse", "core"...) or "auto"/"default" for all.
+ * @param[in] _name Name of the device or "default".
+ * @param[in] _input Search an input device.
+ * @return Id of the device (paNoDevice if not found).
+ */
+static PaDeviceIndex getPortAudioDevice(const etk::String& _interface, const etk::String& _name, bool _input) {
+	if (    _name == "default"
+	     || _name == "") {
+		if (    _interface == "auto"
+		     || _interface == "default") {
+			return _input == true ? Pa_GetDefaultInputDevice() : Pa_GetDefaultOutputDevice();
+		}
+	}
+	etk::String interface = _interface.toLower();
+	PaDeviceIndex nbDevice = Pa_GetDeviceCount();
+	for (PaDeviceIndex iii=0; iii<nbDevice; ++iii) {
+		const PaDeviceInfo* info = Pa_GetDeviceInfo(iii);
+		if (info == null) {
+			continue;
+		}
+		if (    (_input == true && info->maxInputChannels <= 0)
+		     || (_input == false && info->maxOutputChannels <= 0)) {
+			continue;
+		}
+		if (    interface != "auto"
+		     && interface != "default") {
+			const PaHostApiInfo* hostApi = Pa_GetHostApiInfo(info->hostApi);
+			if (    hostApi == null
+			     || etk::String(hostApi->name).toLower() != interface) {
+				continue;
+			}
+			if (    _name == "default"
+			     || _name == "") {
+				// default device of this host API
+				PaDeviceIndex defaultDevice = _input == true ? hostApi->defaultInputDevice : hostApi->defaultOutputDevice;
+				if (defaultDevice != paNoDevice) {
+					return defaultDevice;
+				}
+				return iii;
+			}
+		}
+		if (etk::String(info->name) == _name) {
+			return iii;
+		}
+	}
+	return paNoDevice;
+}
 
 static int portAudioStreamCallback(const void *_input,
                                    void *_output,
@@ -39,8 +122,32 @@ int32_t audio::river::io::NodePortAudio::duplexCallback(const void* _inputBuffer
                                                  const audio::Time& _timeOutput,
                                                  uint32_t _nbChunk,
                                                  PaStreamCallbackFlags _status) {
+	// the duration of the callback include the input of a duplex stream
+	processStart();
+	if (    _inputBuffer != null
+	     && m_duplexInput != null) {
+		// full duplex: the input node is processed first, the feedback of the output is aligned on the same sample
+		m_duplexInput->duplexCallback(_inputBuffer, _timeInput, null, _timeOutput, _nbChunk, _status);
+		_inputBuffer = null;
+	}
 	ethread::UniqueLock lock(m_mutex);
-	// TODO : Manage status ...
+	applyThreadPolicy();
+	// only the flags of the direction of this node (the flags of a duplex stream are given to the 2 nodes)
+	if (m_isInput == true) {
+		if ((_status & paInputUnderflow) != 0) {
+			xrun(true, _timeInput);
+		}
+		if ((_status & paInputOverflow) != 0) {
+			xrun(false, _timeInput);
+		}
+	} else {
+		if ((_status & paOutputUnderflow) != 0) {
+			xrun(true, _timeOutput);
+		}
+		if ((_status & paOutputOverflow) != 0) {
+			xrun(false, _timeOutput);
+		}
+	}
 	if (_inputBuffer != null) {
 		RIVER_VERBOSE("data Input size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size());
 		newInput(_inputBuffer, _nbChunk, _timeInput);
@@ -49,6 +156,7 @@ int32_t audio::river::io::NodePortAudio::duplexCallback(const void* _inputBuffer
 		RIVER_VERBOSE("data Output size request :" << _nbChunk << " [BEGIN] status=" << _status << " nbIO=" << m_list.size());
 		newOutput(_outputBuffer, _nbChunk, _timeOutput);
 	}
+	processStop(_nbChunk);
 	return 0;
 }
 
@@ -58,7 +166,10 @@ ememory::SharedPtr<audio::river::io::NodePortAudio> audio::river::io::NodePortAu
 }
 
 audio::river::io::NodePortAudio::NodePortAudio(const etk::String& _name, const ejson::Object& _config) :
-  Node(_name, _config) {
+  Node(_name, _config),
+  m_stream(null),
+  m_nbChunk(1024),
+  m_inDuplex(false) {
 	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
 	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
 	/**
@@ -68,45 +179,169 @@ audio::river::io::NodePortAudio::NodePortAudio(const etk::String& _name, const e
 		},
 		nb-chunk:1024 # number of chunk to open device (create the latency anf the frequency to call user)
 	*/
+	etk::String typeInterface = "auto";
 	etk::String streamName = "default";
 	const ejson::Object tmpObject = m_config["map-on"].toObject();
 	if (tmpObject.exist() == false) {
 		RIVER_WARNING("missing node : 'map-on' ==> auto map : 'auto:default'");
 	} else {
-		etk::String value = tmpObject.getStringValue("interface", "default");
+		typeInterface = tmpObject.getStringValue("interface", "auto");
 		streamName = tmpObject.getStringValue("name", "default");
 	}
-	int32_t nbChunk = m_config.getNumberValue("nb-chunk", 1024);
-	
-	PaError err = 0;
+	m_nbChunk = m_config.getNumberValue("nb-chunk", 1024);
+	// the backend is initialized only when the first node is created
+	if (audio::river::io::Manager::getInstance()->initPortAudio() == false) {
+		RIVER_ERROR("Can not create Stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " portaudio is not availlable");
+		return;
+	}
+	PaDeviceIndex deviceId = getPortAudioDevice(typeInterface, streamName, m_isInput);
+	if (deviceId == paNoDevice) {
+		RIVER_ERROR("Can not find the device '" << typeInterface << ":" << streamName << "' for '" << m_name << "' mode=" << (m_isInput?"input":"output"));
+		return;
+	}
+	const PaDeviceInfo* info = Pa_GetDeviceInfo(deviceId);
+	int32_t nbChannelMax = m_isInput == true ? info->maxInputChannels : info->maxOutputChannels;
+	RIVER_INFO("Device " << deviceId << " - '" << info->name << "' channels=" << nbChannelMax << " default-frequency=" << info->defaultSampleRate);
+	if (int32_t(hardwareFormat.getMap().size()) > nbChannelMax) {
+		RIVER_ERROR("Can not open '" << m_name << "' with " << hardwareFormat.getMap().size() << " channels: the device '" << info->name << "' has only " << nbChannelMax << " channels");
+		return;
+	}
+	if (hardwareFormat.getFrequency() <= 1) {
+		hardwareFormat.setFrequency(uint32_t(info->defaultSampleRate));
+		RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
+	}
+	// open the device with the format of the node: no conversion in portaudio
+	m_parameters.device = deviceId;
+	m_parameters.channelCount = hardwareFormat.getMap().size();
+	m_parameters.suggestedLatency = m_isInput == true ? info->defaultLowInputLatency : info->defaultLowOutputLatency;
+	m_parameters.hostApiSpecificStreamInfo = null;
+	if (getPortAudioFormat(hardwareFormat.getFormat(), m_parameters.sampleFormat) == false) {
+		RIVER_WARNING("Format " << hardwareFormat.getFormat() << " not availlable in portaudio ==> use int16");
+		hardwareFormat.setFormat(audio::format_int16);
+		m_parameters.sampleFormat = paInt16;
+	}
+	PaError err = Pa_IsFormatSupported(m_isInput == true ? &m_parameters : null,
+	                                   m_isInput == true ? null : &m_parameters,
+	                                   hardwareFormat.getFrequency());
+	if (    err != paFormatIsSupported
+	     && hardwareFormat.getFormat() != audio::format_int16) {
+		RIVER_WARNING("Format " << hardwareFormat.getFormat() << " not supported by '" << info->name << "' ==> use int16 (" << Pa_GetErrorText(err) << ")");
+		hardwareFormat.setFormat(audio::format_int16);
+		m_parameters.sampleFormat = paInt16;
+	}
+	interfaceFormat.setFrequency(hardwareFormat.getFrequency());
 	if (m_isInput == true) {
-		err = Pa_OpenDefaultStream(&m_stream,
-		                           hardwareFormat.getMap().size(),
-		                           0,
-		                           paInt16,
-		                           hardwareFormat.getFrequency(),
-		                           nbChunk,
-		                           &portAudioStreamCallback,
-		                           this);
+		m_process.setInputConfig(hardwareFormat);
+		m_process.setOutputConfig(interfaceFormat);
 	} else {
-		err = Pa_OpenDefaultStream(&m_stream,
-		                           0,
-		                           hardwareFormat.getMap().size(),
-		                           paInt16,
-		                           hardwareFormat.getFrequency(),
-		                           nbChunk,
-		                           &portAudioStreamCallback,
-		                           this);
+		m_process.setInputConfig(interfaceFormat);
+		m_process.setOutputConfig(hardwareFormat);
 	}
+	openStream();
+	m_process.updateInterAlgo();
+}
+
+bool audio::river::io::NodePortAudio::openStream() {
+	const PaStreamParameters* inputParameters = null;
+	if (m_isInput == true) {
+		inputParameters = &m_parameters;
+	} else if (m_duplexInput != null) {
+		inputParameters = &m_duplexInput->m_parameters;
+	}
+	PaError err = Pa_OpenStream(&m_stream,
+	                            inputParameters,
+	                            m_isInput == true ? null : &m_parameters,
+	                            getHarwareFormat().getFrequency(),
+	                            m_nbChunk,
+	                            paNoFlag,
+	                            &portAudioStreamCallback,
+	                            this);
 	if( err != paNoError ) {
 		RIVER_ERROR("Can not create Stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " err : " << Pa_GetErrorText(err));
+		m_stream = null;
+		return false;
 	}
-	m_process.updateInterAlgo();
+	return true;
+}
+
+bool audio::river::io::NodePortAudio::linkDuplex(const ememory::SharedPtr<audio::river::io::NodePortAudio>& _input) {
+	if (    _input == null
+	     || m_isInput == true
+	     || _input->m_isInput == false) {
+		RIVER_ERROR("Can not link '" << m_name << "' in duplex: need an output node and an input node");
+		return false;
+	}
+	if (    m_stream == null
+	     || _input->m_stream == null) {
+		return false;
+	}
+	if (getHarwareFormat().getFrequency() != _input->getHarwareFormat().getFrequency()) {
+		RIVER_WARNING("Can not link '" << m_name << "' and '" << _input->getName() << "' in duplex: not the same frequency");
+		return false;
+	}
+	// portaudio only open a duplex stream on 2 devices of the same host API
+	if (Pa_GetDeviceInfo(m_parameters.device)->hostApi != Pa_GetDeviceInfo(_input->m_parameters.device)->hostApi) {
+		RIVER_WARNING("Can not link '" << m_name << "' and '" << _input->getName() << "' in duplex: not the same host API");
+		return false;
+	}
+	PaError err = Pa_IsFormatSupported(&_input->m_parameters, &m_parameters, getHarwareFormat().getFrequency());
+	if (err != paFormatIsSupported) {
+		RIVER_WARNING("Can not link '" << m_name << "' and '" << _input->getName() << "' in duplex: " << Pa_GetErrorText(err));
+		return false;
+	}
+	// the 2 streams are closed before (a device can be opened only one time)
+	Pa_CloseStream(_input->m_stream);
+	_input->m_stream = null;
+	Pa_CloseStream(m_stream);
+	m_stream = null;
+	m_duplexInput = _input;
+	if (openStream() == false) {
+		RIVER_WARNING("Can not open '" << m_name << "' and '" << _input->getName() << "' in duplex ==> use 2 streams");
+		m_duplexInput.reset();
+		openStream();
+		_input->openStream();
+		return false;
+	}
+	_input->m_inDuplex = true;
+	RIVER_INFO("Link '" << _input->getName() << "' in the duplex stream of '" << m_name << "'");
+	return true;
+}
+
+bool audio::river::io::NodePortAudio::isStreamOpen() {
+	ethread::UniqueLock lock(m_mutex);
+	return    m_stream != null
+	       || m_inDuplex == true;
+}
+
+void audio::river::io::NodePortAudio::streamRelease() {
+	ethread::UniqueLock lock(m_mutex);
+	RIVER_INFO("Release stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_stream == null) {
+		return;
+	}
+	PaError err = Pa_CloseStream(m_stream);
+	if( err != paNoError ) {
+		RIVER_ERROR("Release stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not close stream ... " << Pa_GetErrorText(err));
+	}
+	m_stream = null;
+}
+
+bool audio::river::io::NodePortAudio::streamRestore() {
+	ethread::UniqueLock lock(m_mutex);
+	if (    m_stream != null
+	     || m_inDuplex == true) {
+		// the duplex stream is restored by the output node
+		return true;
+	}
+	return openStream();
 }
 
 audio::river::io::NodePortAudio::~NodePortAudio() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("close input stream");
+	if (m_stream == null) {
+		return;
+	}
 	PaError err = Pa_CloseStream( m_stream );
 	if( err != paNoError ) {
 		RIVER_ERROR("Remove stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not Remove stream ... " << Pa_GetErrorText(err));
@@ -116,6 +351,11 @@ audio::river::io::NodePortAudio::~NodePortAudio() {
 void audio::river::io::NodePortAudio::start() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_stream == null) {
+		return;
+	}
+	// the backend can create a new thread for the callback
+	m_threadPolicyApplied = false;
 	PaError err = Pa_StartStream(m_stream);
 	if( err != paNoError ) {
 		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not start stream ... " << Pa_GetErrorText(err));
@@ -125,6 +365,9 @@ void audio::river::io::NodePortAudio::start() {
 void audio::river::io::NodePortAudio::stop() {
 	ethread::UniqueLock lock(m_mutex);
 	RIVER_INFO("Stop stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_stream == null) {
+		return;
+	}
 	PaError err = Pa_StopStream(m_stream);
 	if( err != paNoError ) {
 		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " can not stop stream ... " << Pa_GetErrorText(err));
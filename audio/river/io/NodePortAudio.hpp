@@ -33,13 +33,34 @@ namespace audio {
 					};
 				protected:
 					PaStream* m_stream;
+					PaStreamParameters m_parameters; //!< Device, channels and native format of the stream
+					uint32_t m_nbChunk; //!< Number of chunk requested at each callback
+					ememory::SharedPtr<audio::river::io::NodePortAudio> m_duplexInput; //!< Input node processed in the stream of this output node (full duplex)
+					bool m_inDuplex; //!< This input node is processed in the stream of an output node (it has no stream)
+					/**
+					 * @brief Open the stream with the parameters of the node.
+					 * @return true The stream is open.
+					 */
+					bool openStream();
 				public:
+					/**
+					 * @brief Merge an input node of the same group in the stream of this output node: one full duplex stream, one callback and one clock
+					 * for the 2 nodes. The stream of the input node is closed (its start and stop do nothing).
+					 * @param[in] _input Input node to process in the stream.
+					 * @return true The 2 nodes use the same stream, false The 2 streams are kept.
+					 */
+					bool linkDuplex(const ememory::SharedPtr<audio::river::io::NodePortAudio>& _input);
 					int32_t duplexCallback(const void* _inputBuffer,
 					                       const audio::Time& _timeInput,
 					                       void* _outputBuffer,
 					                       const audio::Time& _timeOutput,
 					                       uint32_t _nbChunk,
 					                       PaStreamCallbackFlags _status);
+				public:
+					virtual bool isStreamOpen();
+				protected:
+					virtual void streamRelease();
+					virtual bool streamRestore();
 				protected:
 					virtual void start();
 					virtual void stop();
@@ -0,0 +1,176 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <audio/river/io/NodeShm.hpp>
+#include <audio/river/io/ShmServer.hpp>
+#include <audio/river/debug.hpp>
+#include <ememory/memory.hpp>
+
+extern "C" {
+	#include <unistd.h>
+	#include <errno.h>
+	#include <signal.h>
+}
+
+// Maximum waiting time of the server before checking if it is alive
+static const uint32_t serverTimeoutMs = 500;
+
+ememory::SharedPtr<audio::river::io::NodeShm> audio::river::io::NodeShm::create(const etk::String& _name, const ejson::Object& _config) {
+	return ememory::SharedPtr<audio::river::io::NodeShm>(ETK_NEW(audio::river::io::NodeShm, _name, _config));
+}
+
+audio::river::io::NodeShm::NodeShm(const etk::String& _name, const ejson::Object& _config) :
+  Node(_name, _config),
+  m_nbChunk(1024),
+  m_nbPeriod(3),
+  m_connectionId(-1),
+  m_serverPid(0),
+  m_alive(false) {
+	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
+	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
+	/**
+		map-on:{
+			server:"river", # name of the server
+			node:"speaker", # name of the node in the server
+			nb-period:3, # number of period in the ring
+		},
+		nb-chunk:1024 # number of chunk exchanged at each period
+	*/
+	const ejson::Object tmpObject = m_config["map-on"].toObject();
+	if (tmpObject.exist() == true) {
+		m_serverName = tmpObject["server"].toString().get("river");
+		m_nodeName = tmpObject["node"].toString().get(m_name);
+		m_nbPeriod = etk::avg(2, int32_t(tmpObject["nb-period"].toNumber().get(3)), 64);
+	} else {
+		m_serverName = "river";
+		m_nodeName = m_name;
+	}
+	m_nbChunk = m_config["nb-chunk"].toNumber().get(1024);
+	if (m_nbChunk <= 0) {
+		m_nbChunk = 1024;
+	}
+	if (hardwareFormat.getFrequency() <= 1) {
+		// the server convert the flow ==> no device to select a frequency
+		hardwareFormat.setFrequency(48000);
+		interfaceFormat.setFrequency(48000);
+		RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
+	}
+	RIVER_INFO("Open shared memory client :");
+	RIVER_INFO("    m_server=" << m_serverName << " node=" << m_nodeName);
+	RIVER_INFO("    m_freq=" << hardwareFormat.getFrequency());
+	RIVER_INFO("    m_map=" << hardwareFormat.getMap());
+	RIVER_INFO("    m_format=" << hardwareFormat.getFormat());
+	RIVER_INFO("    m_isInput=" << m_isInput);
+	if (m_isInput == true) {
+		m_process.setInputConfig(hardwareFormat);
+		m_process.setOutputConfig(interfaceFormat);
+	} else {
+		m_process.setInputConfig(interfaceFormat);
+		m_process.setOutputConfig(hardwareFormat);
+	}
+	m_process.updateInterAlgo();
+}
+
+audio::river::io::NodeShm::~NodeShm() {
+	stop();
+}
+
+void audio::river::io::NodeShm::start() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_ring.isOpen() == true) {
+		RIVER_ERROR("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " ==> already started ..." );
+		return;
+	}
+	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") << " on server '" << m_serverName << "'");
+	static uint32_t uid = 0;
+	etk::String ringName = audio::river::io::ShmServer::getSegmentName(m_serverName) + "-" + etk::toString(getpid()) + "-" + etk::toString(uid++);
+	const audio::drain::IOFormatInterface& hardwareFormat = getHarwareFormat();
+	// a multiple of the period: a period is always contiguous in the ring
+	if (m_ring.create(ringName,
+	                  hardwareFormat.getFormat(),
+	                  hardwareFormat.getFrequency(),
+	                  hardwareFormat.getMap(),
+	                  m_nbChunk*m_nbPeriod,
+	                  m_isInput == false) == false) {
+		return;
+	}
+	m_connectionId = audio::river::io::ShmServer::connect(m_serverName, m_nodeName, ringName, m_serverPid);
+	// the server has mapped the ring (or will never do it)
+	m_ring.unlink();
+	if (m_connectionId < 0) {
+		m_ring.close();
+		return;
+	}
+	m_alive = true;
+	m_threadPolicyApplied = false;
+	m_thread = ememory::makeShared<ethread::Thread>([=](){this->threadCallback();}, "RIVER shm");
+}
+
+void audio::river::io::NodeShm::stop() {
+	ememory::SharedPtr<ethread::Thread> thread;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		RIVER_INFO("Stop stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+		m_alive = false;
+		thread = m_thread;
+		m_thread.reset();
+	}
+	// join without the lock: the thread need it to finish the current period.
+	if (thread != null) {
+		thread->join();
+	}
+	ethread::UniqueLock lock(m_mutex);
+	if (m_connectionId >= 0) {
+		audio::river::io::ShmServer::disconnect(m_serverName, m_connectionId);
+		m_connectionId = -1;
+	}
+	// the server keep its mapping until it has stopped its interface
+	m_ring.close();
+}
+
+void audio::river::io::NodeShm::threadCallback() {
+	while (m_alive == true) {
+		bool ready = false;
+		if (m_isInput == true) {
+			ready = m_ring.waitRead(m_nbChunk, serverTimeoutMs);
+		} else {
+			ready = m_ring.waitWrite(m_nbChunk, serverTimeoutMs);
+		}
+		if (ready == false) {
+			if (    kill(m_serverPid, 0) != 0
+			     && errno == ESRCH) {
+				RIVER_ERROR("The river server '" << m_serverName << "' has stopped ==> stop '" << m_name << "'");
+				return;
+			}
+			continue;
+		}
+		ethread::UniqueLock lock(m_mutex);
+		applyThreadPolicy();
+		audio::Time time;
+		if (m_isInput == true) {
+			uint64_t position = m_ring.getReadPosition();
+			if (m_ring.getTime(position, time) == false) {
+				time = audio::Time::now();
+			}
+			// the period is demuxed in place
+			newInput(m_ring.getFrame(position), m_nbChunk, time);
+			m_ring.commitRead(m_nbChunk);
+		} else {
+			uint64_t position = m_ring.getWritePosition();
+			if (m_ring.getTime(position, time) == false) {
+				// nothing played yet: the ring is the latency
+				time = audio::Time::now() + audio::Duration(0, int64_t(m_ring.getFillSize())*1000000000LL/int64_t(getHarwareFormat().getFrequency()));
+			}
+			// the interfaces are mixed in place
+			newOutput(m_ring.getFrame(position), m_nbChunk, time);
+			m_ring.commitWrite(m_nbChunk);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,74 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <audio/river/io/Node.hpp>
+#include <audio/river/io/ShmRing.hpp>
+#include <ethread/Thread.hpp>
+#include <atomic>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			class Manager;
+			/**
+			 * @brief Client node of a river server (@ref ShmServer) that own the hardware in an other process.
+			 * The node mix (or demux) its interfaces directly in a shared memory ring, the server connect the ring on one of its nodes.
+			 * @code
+			 * speaker:{
+			 * 	io:"shm-output", # or "shm-input"
+			 * 	map-on:{
+			 * 		server:"river", # name of the server (audio::river::startServer())
+			 * 		node:"speaker", # name of the node in the server
+			 * 		nb-period:3, # size of the ring (latency) in number of "nb-chunk"
+			 * 	},
+			 * 	frequency:48000,
+			 * 	channel-map:["front-left", "front-right"],
+			 * 	type:"int16",
+			 * 	nb-chunk:256,
+			 * },
+			 * @endcode
+			 */
+			class NodeShm : public Node {
+				protected:
+					/**
+					 * @brief Constructor
+					 */
+					NodeShm(const etk::String& _name, const ejson::Object& _config);
+				public:
+					static ememory::SharedPtr<NodeShm> create(const etk::String& _name, const ejson::Object& _config);
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~NodeShm();
+					virtual bool isHarwareNode() {
+						return true;
+					};
+				protected:
+					etk::String m_serverName; //!< Name of the server
+					etk::String m_nodeName; //!< Name of the node in the server
+					uint32_t m_nbChunk; //!< Number of chunk processed at each period
+					uint32_t m_nbPeriod; //!< Number of period in the ring
+					audio::river::io::ShmRing m_ring; //!< Ring shared with the server
+					int32_t m_connectionId; //!< Id of the connection in the server
+					int32_t m_serverPid; //!< Process of the server
+					ememory::SharedPtr<ethread::Thread> m_thread; //!< Thread clocked by the ring
+					std::atomic<bool> m_alive; //!< Thread is active
+					/**
+					 * @brief Process the ring when the server has consumed (output) or produced (input) a period.
+					 */
+					void threadCallback();
+				protected:
+					virtual void start();
+					virtual void stop();
+			};
+		}
+	}
+}
+
+#endif
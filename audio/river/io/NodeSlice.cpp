@@ -0,0 +1,188 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/NodeSlice.hpp>
+#include <audio/river/debug.hpp>
+#include <etk/types.hpp>
+#include <ememory/memory.hpp>
+#include <etk/Function.hpp>
+
+ememory::SharedPtr<audio::river::io::NodeSlice> audio::river::io::NodeSlice::create(const etk::String& _name, const ejson::Object& _config) {
+	return ememory::SharedPtr<audio::river::io::NodeSlice>(ETK_NEW(audio::river::io::NodeSlice, _name, _config));
+}
+
+audio::river::io::NodeSlice::NodeSlice(const etk::String& _name, const ejson::Object& _config) :
+  Node(_name, _config),
+  m_nbChannelParent(0) {
+	/**
+		io:"slice",
+		map-on:"speaker16", # parent output node
+		channels:["rear-left", "rear-right"], # channels of the parent used by the slice
+		volume-name:"REAR", # (optionnal) volume of the slice
+	*/
+	etk::String streamName = m_config["map-on"].toString().get("error");
+	// get global hardware interface:
+	ememory::SharedPtr<audio::river::io::Manager> manager = audio::river::io::Manager::getInstance();
+	ememory::SharedPtr<audio::river::io::Node> node = manager->getNode(streamName);
+	if (node == null) {
+		RIVER_ERROR("can not open the parent node of the slice: '" << streamName << "'");
+		return;
+	}
+	if (node->isOutput() == false) {
+		RIVER_ERROR("can not slice an input node: '" << streamName << "'");
+		return;
+	}
+	// the slice work directly in the mux format of the parent:
+	audio::drain::IOFormatInterface parentFormat = node->getInterfaceFormat();
+	m_nbChannelParent = parentFormat.getMap().size();
+	etk::Vector<audio::channel> map;
+	const ejson::Array listChannel = m_config["channels"].toArray();
+	for (auto it : listChannel) {
+		audio::channel value = audio::getChannelFromString(it.toString().get());
+		bool find = false;
+		for (size_t iii=0; iii<parentFormat.getMap().size(); ++iii) {
+			if (parentFormat.getMap()[iii] == value) {
+				map.pushBack(value);
+				m_channelId.pushBack(iii);
+				find = true;
+				break;
+			}
+		}
+		if (find == false) {
+			RIVER_ERROR("channel '" << value << "' is not in the parent '" << streamName << "' map=" << parentFormat.getMap());
+		}
+	}
+	if (map.size() == 0) {
+		RIVER_ERROR("Can not create a slice without channel in " << _name);
+		return;
+	}
+	// no conversion in the node: the interfaces are converted in the slice format
+	audio::drain::IOFormatInterface sliceFormat(map, parentFormat.getFormat(), parentFormat.getFrequency());
+	m_process.setInputConfig(sliceFormat);
+	m_process.setOutputConfig(sliceFormat);
+	// create the interface of the slice with the format of the parent (no conversion in the parent)
+	ejson::Object tmpOption;
+	tmpOption.add("io", ejson::String("output"));
+	m_interfaceOutput = audio::river::Interface::create(parentFormat.getFrequency(),
+	                                                    parentFormat.getMap(),
+	                                                    parentFormat.getFormat(),
+	                                                    node,
+	                                                    tmpOption);
+	if (m_interfaceOutput == null) {
+		RIVER_ERROR("Can not opne the slice interface on '" << streamName << "' in " << _name);
+		return;
+	}
+	m_interfaceOutput->setName(_name + "-SLICE-output");
+	// set callback mode ...
+	m_interfaceOutput->setOutputCallback([=](void* _data,
+	                                         const audio::Time& _time,
+	                                         size_t _nbChunk,
+	                                         enum audio::format _format,
+	                                         uint32_t _frequency,
+	                                         const etk::Vector<audio::channel>& _map) {
+	                                         	onDataNeeded(_data, _time, _nbChunk, _format, _frequency, _map);
+	                                         });
+	// the parent request its period: the mix buffer is allocated here, never in the audio thread
+	uint32_t nbChunk = etk::max(getNbChunk(), node->getNbChunk());
+	m_data.resize(int64_t(nbChunk)*audio::getFormatBytes(parentFormat.getFormat())*map.size(), 0);
+	m_process.updateInterAlgo();
+}
+
+audio::river::io::NodeSlice::~NodeSlice() {
+	RIVER_INFO("close slice");
+	stop();
+	m_interfaceOutput.reset();
+};
+
+void audio::river::io::NodeSlice::start() {
+	ethread::UniqueLock lock(m_mutex);
+	RIVER_INFO("Start stream : '" << m_name << "' mode=" << (m_isInput?"input":"output") );
+	if (m_interfaceOutput != null) {
+		RIVER_INFO("Start SLICE OUTPUT : ");
+		m_interfaceOutput->start();
+	}
+}
+
+void audio::river::io::NodeSlice::stop() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_interfaceOutput != null) {
+		m_interfaceOutput->stop();
+	}
+}
+
+void audio::river::io::NodeSlice::onDataNeeded(void* _data,
+                                               const audio::Time& _time,
+                                               size_t _nbChunk,
+                                               enum audio::format _format,
+                                               uint32_t _frequency,
+                                               const etk::Vector<audio::channel>& _map) {
+	RIVER_VERBOSE("Slice Time=" << _time << " _nbChunk=" << _nbChunk << " _map=" << _map << " _format=" << _format << " freq=" << _frequency);
+	if (    _format != m_process.getOutputConfig().getFormat()
+	     || _map.size() != m_nbChannelParent) {
+		RIVER_ERROR("call wrong type ... (need " << m_process.getOutputConfig().getFormat() << " on " << m_nbChannelParent << " channels)");
+		return;
+	}
+	ethread::UniqueLock lock(m_mutex);
+	size_t sampleSize = audio::getFormatBytes(_format);
+	size_t nbChannel = m_channelId.size();
+	uint8_t* output = static_cast<uint8_t*>(_data);
+	memset(output, 0, _nbChunk*m_nbChannelParent*sampleSize);
+	// a period longer than the mix buffer (parent re-created with a new period) is processed in several parts
+	size_t maxChunk = m_data.size()/(nbChannel*sampleSize);
+	if (maxChunk == 0) {
+		return;
+	}
+	size_t offset = 0;
+	while (offset < _nbChunk) {
+		size_t nbChunk = etk::min(maxChunk, _nbChunk - offset);
+		// mix all the interfaces with the channels of the slice only
+		newOutput(&m_data[0], nbChunk, _time + audio::Duration(0, int64_t(offset)*1000000000LL/int64_t(_frequency)));
+		// scatter in the channels of the parent (the other channels are silent)
+		for (size_t iii=0; iii<nbChunk; ++iii) {
+			const uint8_t* input = &m_data[iii*nbChannel*sampleSize];
+			uint8_t* frame = &output[(offset+iii)*m_nbChannelParent*sampleSize];
+			for (size_t jjj=0; jjj<nbChannel; ++jjj) {
+				memcpy(&frame[m_channelId[jjj]*sampleSize], &input[jjj*sampleSize], sampleSize);
+			}
+		}
+		offset += nbChunk;
+	}
+}
+
+void audio::river::io::NodeSlice::generateDot(ememory::SharedPtr<etk::io::Interface>& _io) {
+	*_io << "	subgraph clusterNode_" << m_uid << " {\n";
+	*_io << "		color=blue;\n";
+	*_io << "		label=\"[" << m_uid << "] IO::Node : " << m_name << "\";\n";
+		*_io << "		node [shape=square];\n";
+		*_io << "			NODE_" << m_uid << "_muxer [ label=\"MUXER\\n format=" << etk::toString(m_process.getInputConfig().getFormat()) << "\" ];\n";
+		*_io << "			NODE_" << m_uid << "_HW_SLICE [ label=\"SLICE\\n channelMap=" << etk::toString(getHarwareFormat().getMap()) << "\" ];\n";
+		// Link all nodes :
+		*_io << "			NODE_" << m_uid << "_muxer -> NODE_" << m_uid << "_HW_SLICE;\n";
+	*_io << "	}\n";
+	if (m_interfaceOutput != null) {
+		*_io << "	NODE_" << m_uid << "_HW_SLICE -> " << m_interfaceOutput->getDotNodeName() << ";\n";
+	}
+	*_io << "	\n";
+	
+	for (size_t iii=0; iii< m_listAvaillable.size(); ++iii) {
+		if (m_listAvaillable[iii].expired() == true) {
+			continue;
+		}
+		ememory::SharedPtr<audio::river::Interface> element = m_listAvaillable[iii].lock();
+		if (element == null) {
+			continue;
+		}
+		bool isLink = false;
+		for (size_t jjj=0; jjj<m_list.size(); ++jjj) {
+			if (element == m_list[jjj]) {
+				isLink = true;
+			}
+		}
+		if (element->getMode() == modeInterface_output) {
+			element->generateDot(_io, "NODE_" + etk::toString(m_uid) + "_muxer", isLink);
+		}
+	}
+}
@@ -0,0 +1,54 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <audio/river/io/Node.hpp>
+#include <audio/river/Interface.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			class Manager;
+			/**
+			 * @brief Virtual output on a subset of the channels of a parent output node ("channels").
+			 * The interfaces connected on it are processed and mixed with the number of channel of the slice, the result is
+			 * scattered in the channels of the parent only at the end (one interface on the parent node for all the slice).
+			 */
+			class NodeSlice : public Node {
+				protected:
+					/**
+					 * @brief Constructor
+					 */
+					NodeSlice(const etk::String& _name, const ejson::Object& _config);
+				public:
+					static ememory::SharedPtr<NodeSlice> create(const etk::String& _name, const ejson::Object& _config);
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~NodeSlice();
+				protected:
+					virtual void start();
+					virtual void stop();
+					ememory::SharedPtr<audio::river::Interface> m_interfaceOutput; //!< Interface of the slice on the parent node
+					etk::Vector<uint32_t> m_channelId; //!< Id of the channel in the parent of each channel of the slice
+					uint32_t m_nbChannelParent; //!< Number of channel of the parent
+					etk::Vector<uint8_t> m_data; //!< Mix of the slice (before the scatter in the parent channels)
+					/**
+					 * @brief Stream data request callback of the parent node: mix the interfaces of the slice and scatter them.
+					 */
+					void onDataNeeded(void* _data,
+					                  const audio::Time& _time,
+					                  size_t _nbChunk,
+					                  enum audio::format _format,
+					                  uint32_t _frequency,
+					                  const etk::Vector<audio::channel>& _map);
+				public:
+					virtual void generateDot(ememory::SharedPtr<etk::io::Interface>& _io);
+			};
+		}
+	}
+}
+
@@ -0,0 +1,145 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#ifdef AUDIO_RIVER_BUILD_VIRTUAL
+
+#include <audio/river/io/NodeVirtual.hpp>
+#include <audio/river/io/Manager.hpp>
+#include <audio/river/debug.hpp>
+#include <ememory/memory.hpp>
+
+ememory::SharedPtr<audio::river::io::NodeVirtual> audio::river::io::NodeVirtual::create(const etk::String& _name, const ejson::Object& _config) {
+	return ememory::SharedPtr<audio::river::io::NodeVirtual>(ETK_NEW(audio::river::io::NodeVirtual, _name, _config));
+}
+
+audio::river::io::NodeVirtual::NodeVirtual(const etk::String& _name, const ejson::Object& _config) :
+  NodeClock(_name, _config) {
+	audio::drain::IOFormatInterface interfaceFormat = getInterfaceFormat();
+	audio::drain::IOFormatInterface hardwareFormat = getHarwareFormat();
+	/**
+		map-on:{
+			loopback:"speaker-null", # (input only) name of the virtual output that feed this input
+		},
+		nb-chunk:1024 # number of chunk send at each period
+	*/
+	const ejson::Object tmpObject = m_config["map-on"].toObject();
+	if (tmpObject.exist() == true) {
+		m_loopbackName = tmpObject["loopback"].toString().get();
+		if (    m_loopbackName != ""
+		     && m_isInput == false) {
+			RIVER_WARNING("'loopback' is only availlable on a 'virtual-input' ==> ignore it on '" << m_name << "'");
+			m_loopbackName = "";
+		}
+	}
+	if (hardwareFormat.getFrequency() <= 1) {
+		// no device to select a frequency
+		hardwareFormat.setFrequency(48000);
+		interfaceFormat.setFrequency(48000);
+		RIVER_INFO("auto set frequency: " << hardwareFormat.getFrequency());
+	}
+	RIVER_INFO("Open virtual :");
+	RIVER_INFO("    m_freq=" << hardwareFormat.getFrequency());
+	RIVER_INFO("    m_map=" << hardwareFormat.getMap());
+	RIVER_INFO("    m_format=" << hardwareFormat.getFormat());
+	RIVER_INFO("    m_isInput=" << m_isInput);
+	RIVER_INFO("    m_loopback=" << m_loopbackName);
+	if (m_isInput == true) {
+		m_process.setInputConfig(hardwareFormat);
+		m_process.setOutputConfig(interfaceFormat);
+	} else {
+		m_process.setInputConfig(interfaceFormat);
+		m_process.setOutputConfig(hardwareFormat);
+	}
+	m_buffer.resize(audio::getFormatBytes(hardwareFormat.getFormat())*hardwareFormat.getMap().size()*m_nbChunk, 0);
+	m_process.updateInterAlgo();
+}
+
+audio::river::io::NodeVirtual::~NodeVirtual() {
+	if (m_thread != null) {
+		NodeClock::stop();
+	}
+	m_loopbackSource.reset();
+}
+
+void audio::river::io::NodeVirtual::loopbackInput(const void* _data, uint32_t _nbChunk, const audio::Time& _time) {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_loopbackSource == null) {
+		return;
+	}
+	newInput(_data, _nbChunk, _time);
+}
+
+void audio::river::io::NodeVirtual::loopbackChangeSource(const ememory::SharedPtr<audio::river::io::Node>& _source) {
+	{
+		ethread::UniqueLock lock(m_mutex);
+		if (m_loopbackSource == null) {
+			// stopped: the source is searched at the next start
+			return;
+		}
+		m_loopbackSource = _source;
+	}
+	RIVER_INFO("Loopback '" << m_name << "' on the re-created node '" << m_loopbackName << "'");
+	// the lock of the output is taken without the lock of this input (same order as loopbackInput())
+	if (    _source == null
+	     || _source->loopbackAdd(sharedFromThis()) == false) {
+		RIVER_ERROR("Can not loopback '" << m_name << "' on the re-created node '" << m_loopbackName << "' ==> generate nothing");
+		ethread::UniqueLock lock(m_mutex);
+		m_loopbackSource.reset();
+	}
+}
+
+void audio::river::io::NodeVirtual::processPeriod(const audio::Time& _time) {
+	if (m_isInput == true) {
+		// nothing to capture ==> silence
+		newInput(&m_buffer[0], m_nbChunk, _time);
+		return;
+	}
+	// the loopback inputs are called by newOutput()
+	newOutput(&m_buffer[0], m_nbChunk, _time);
+}
+
+void audio::river::io::NodeVirtual::start() {
+	if (m_loopbackName == "") {
+		NodeClock::start();
+		return;
+	}
+	ememory::SharedPtr<audio::river::io::Node> source = audio::river::io::Manager::getInstance()->getNode(m_loopbackName);
+	if (    source == null
+	     || source->isOutput() == false) {
+		RIVER_ERROR("Can not loopback '" << m_name << "' on '" << m_loopbackName << "' ==> not an output node (generate silence)");
+		NodeClock::start();
+		return;
+	}
+	{
+		ethread::UniqueLock lock(m_mutex);
+		m_loopbackSource = source;
+	}
+	// the input is clocked by the output
+	if (source->loopbackAdd(sharedFromThis()) == false) {
+		ethread::UniqueLock lock(m_mutex);
+		m_loopbackSource.reset();
+		return;
+	}
+	RIVER_INFO("Start stream : '" << m_name << "' mode=input loopback on '" << m_loopbackName << "'");
+}
+
+void audio::river::io::NodeVirtual::stop() {
+	ememory::SharedPtr<audio::river::io::Node> source;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		source = m_loopbackSource;
+		m_loopbackSource.reset();
+	}
+	if (source == null) {
+		NodeClock::stop();
+		return;
+	}
+	RIVER_INFO("Stop stream : '" << m_name << "' mode=input loopback on '" << m_loopbackName << "'");
+	// do not lock this node: the output call loopbackInput() with his lock
+	source->loopbackRemove(sharedFromThis());
+}
+
+#endif
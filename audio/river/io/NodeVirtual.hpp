@@ -0,0 +1,72 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#ifdef AUDIO_RIVER_BUILD_VIRTUAL
+
+#include <audio/river/io/NodeClock.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			class Manager;
+			class Group;
+			/**
+			 * @brief Low level node that simulate an hardware without device (benchmark, test ...):
+			 *  - An output drop the data (or send it on the input that loopback on it).
+			 *  - An input generate silence, or the data of the output it loopback on (no own clock and no own thread in this case: it is processed in the thread of the output).
+			 *    The output can be any output node (virtual, hardware, file, mixer...): the input is paced by it and receive its played blocks without copy.
+			 * @code
+			 * speaker-null:{
+			 * 	io:"virtual-output",
+			 * 	frequency:48000,
+			 * 	channel-map:["front-left", "front-right"],
+			 * 	type:"int16",
+			 * 	nb-chunk:1024,
+			 * 	clock:"timer", # "timer" or "manual" (see @ref NodeClock::step)
+			 * },
+			 * microphone-null:{
+			 * 	io:"virtual-input",
+			 * 	map-on:{
+			 * 		loopback:"speaker-null", # (optionnal) receive the data played on this output node
+			 * 	},
+			 * 	frequency:48000,
+			 * 	channel-map:["front-left", "front-right"],
+			 * 	type:"int16",
+			 * 	nb-chunk:1024,
+			 * },
+			 * @endcode
+			 */
+			class NodeVirtual : public audio::river::io::NodeClock {
+				friend class audio::river::io::Group;
+				protected:
+					/**
+					 * @brief Constructor
+					 */
+					NodeVirtual(const etk::String& _name, const ejson::Object& _config);
+				public:
+					static ememory::SharedPtr<NodeVirtual> create(const etk::String& _name, const ejson::Object& _config);
+					/**
+					 * @brief Destructor
+					 */
+					virtual ~NodeVirtual();
+				protected:
+					etk::Vector<uint8_t> m_buffer; //!< Data of one period
+					etk::String m_loopbackName; //!< Name of the output node that feed this input
+					ememory::SharedPtr<audio::river::io::Node> m_loopbackSource; //!< Output node that feed this input (when started)
+				public:
+					virtual void loopbackInput(const void* _data, uint32_t _nbChunk, const audio::Time& _time);
+					virtual void loopbackChangeSource(const ememory::SharedPtr<audio::river::io::Node>& _source);
+				protected:
+					virtual void processPeriod(const audio::Time& _time);
+				protected:
+					virtual void start();
+					virtual void stop();
+			};
+		}
+	}
+}
+#endif
@@ -0,0 +1,67 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/NodeWorker.hpp>
+#include <audio/river/debug.hpp>
+
+audio::river::io::NodeWorker::NodeWorker() :
+  m_enable(false),
+  m_latency(0),
+  m_alive(false) {
+	
+}
+
+audio::river::io::NodeWorker::~NodeWorker() {
+	stop();
+}
+
+void audio::river::io::NodeWorker::configure(const ejson::Object& _config, uint32_t _frequency) {
+	const ejson::Object tmpObject = _config["worker"].toObject();
+	if (tmpObject.exist() == false) {
+		m_enable = false;
+		m_latency = 0;
+		return;
+	}
+	m_enable = true;
+	// the buffers of the nodes store 1 second
+	uint32_t latency = etk::avg(0, int32_t(tmpObject["latency"].toNumber().get(0)), 500);
+	m_latency = uint32_t(uint64_t(_frequency)*latency/1000);
+}
+
+void audio::river::io::NodeWorker::start(const etk::String& _name, etk::Function<void()> _process) {
+	if (    m_enable == false
+	     || m_thread != null) {
+		return;
+	}
+	m_process = _process;
+	m_alive = true;
+	m_thread = ememory::makeShared<ethread::Thread>([=](){this->threadCallback();}, _name);
+}
+
+void audio::river::io::NodeWorker::stop() {
+	if (m_thread == null) {
+		return;
+	}
+	m_alive = false;
+	m_semaphore.post();
+	m_thread->join();
+	m_thread.reset();
+}
+
+void audio::river::io::NodeWorker::notify() {
+	m_semaphore.post();
+}
+
+void audio::river::io::NodeWorker::threadCallback() {
+	while (m_alive == true) {
+		// timeout: check the stop request even if no data arrive
+		m_semaphore.wait(100000);
+		if (m_alive == false) {
+			break;
+		}
+		m_process();
+	}
+}
@@ -0,0 +1,87 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Function.hpp>
+#include <ejson/ejson.hpp>
+#include <ethread/Thread.hpp>
+#include <ethread/Semaphore.hpp>
+#include <ememory/memory.hpp>
+#include <atomic>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Processing thread of a virtual node (the callbacks of the inputs only store the data and wake up this thread).
+			 * @code
+			 * worker:{
+			 * 	latency:10, # ms: extra latency kept in the buffers to absorb the scheduling of the worker
+			 * },
+			 * @endcode
+			 */
+			class NodeWorker {
+				private:
+					bool m_enable; //!< A worker is requested in the configuration
+					uint32_t m_latency; //!< Extra latency (sample)
+					ethread::Semaphore m_semaphore; //!< Wake up of the worker
+					ememory::SharedPtr<ethread::Thread> m_thread; //!< Worker thread
+					std::atomic<bool> m_alive; //!< The worker is running
+					etk::Function<void()> m_process; //!< Process called in the worker thread
+				public:
+					/**
+					 * @brief Contructor (no worker)
+					 */
+					NodeWorker();
+					/**
+					 * @brief Destructor (stop the thread)
+					 */
+					~NodeWorker();
+					/**
+					 * @brief Configure the worker with the "worker" object of the node.
+					 * @param[in] _config Configuration of the node.
+					 * @param[in] _frequency Frequency of the node.
+					 */
+					void configure(const ejson::Object& _config, uint32_t _frequency);
+					/**
+					 * @brief Check if the processing is done in a worker thread.
+					 * @return true The callbacks must only call notify().
+					 */
+					bool isEnable() const {
+						return m_enable;
+					}
+					/**
+					 * @brief Get the extra latency of the worker.
+					 * @return Number of sample kept in the buffers (0 when the worker is disable).
+					 */
+					uint32_t getLatency() const {
+						return m_latency;
+					}
+					/**
+					 * @brief Start the worker thread.
+					 * @param[in] _name Name of the thread.
+					 * @param[in] _process Function called each time some data is availlable.
+					 */
+					void start(const etk::String& _name, etk::Function<void()> _process);
+					/**
+					 * @brief Stop the worker thread (must be called without the lock used by the process).
+					 */
+					void stop();
+					/**
+					 * @brief Wake up the worker (called by the input callbacks).
+					 */
+					void notify();
+				private:
+					/**
+					 * @brief Worker thread.
+					 */
+					void threadCallback();
+			};
+		}
+	}
+}
+
@@ -0,0 +1,154 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/PeriodAdapter.hpp>
+#include <audio/river/debug.hpp>
+
+audio::river::io::PeriodAdapter::PeriodAdapter() :
+  m_min(128),
+  m_max(4096),
+  m_lowLoad(20),
+  m_highLoad(70),
+  m_observationDefault(10000000000LL),
+  m_observation(10000000000LL),
+  m_decreased(false),
+  m_nbChunk(1024),
+  m_requested(false),
+  m_windowStarted(false),
+  m_windowMax(0),
+  m_maxReached(false),
+  m_event(eventNone),
+  m_eventDuration(0),
+  m_eventPeriod(0),
+  m_eventNbChunk(0) {
+	
+}
+
+void audio::river::io::PeriodAdapter::configure(const ejson::Object& _config, uint32_t _nbChunk) {
+	const ejson::Object tmpObject = _config["nb-chunk-adaptive"].toObject();
+	m_min = etk::max(int32_t(tmpObject["min"].toNumber().get(128)), 16);
+	m_max = etk::max(uint32_t(tmpObject["max"].toNumber().get(4096)), m_min);
+	m_highLoad = etk::avg(10, int32_t(tmpObject["high-load"].toNumber().get(70)), 100);
+	// a decrease double the load: the low load must stay under the half of the high load (no oscillation)
+	m_lowLoad = etk::avg(0, int32_t(tmpObject["low-load"].toNumber().get(20)), int32_t(m_highLoad/2));
+	uint64_t observation = uint64_t(etk::avg(1, int32_t(tmpObject["observation"].toNumber().get(10)), 3600))*1000000000LL;
+	if (observation != m_observationDefault) {
+		m_observationDefault = observation;
+		m_observation = observation;
+	}
+	m_nbChunk = _nbChunk;
+	m_requested = false;
+	m_windowStarted = false;
+	m_windowMax = 0;
+	m_maxReached = false;
+}
+
+void audio::river::io::PeriodAdapter::processStart() {
+	m_processStart = audio::Time::now();
+}
+
+uint32_t audio::river::io::PeriodAdapter::processStop(uint32_t _nbChunk, uint32_t _frequency) {
+	if (    m_requested == true
+	     || _frequency == 0) {
+		return 0;
+	}
+	audio::Time now = audio::Time::now();
+	uint64_t duration = (now - m_processStart).get();
+	uint64_t period = uint64_t(_nbChunk)*1000000000LL/uint64_t(_frequency);
+	if (duration*100 > period*m_highLoad) {
+		return increase(duration, period);
+	}
+	if (m_windowStarted == false) {
+		m_windowStarted = true;
+		m_windowStart = now;
+		m_windowMax = 0;
+	}
+	m_windowMax = etk::max(m_windowMax, duration);
+	if (uint64_t((now - m_windowStart).get()) < m_observation) {
+		return 0;
+	}
+	// end of the observation window:
+	m_windowStarted = false;
+	if (    m_windowMax*100 < period*m_lowLoad
+	     && m_nbChunk/2 >= m_min) {
+		m_eventDuration = m_windowMax;
+		m_eventPeriod = period;
+		m_eventNbChunk = m_nbChunk/2;
+		m_event = eventDecrease;
+		m_decreased = true;
+		m_requested = true;
+		return m_nbChunk/2;
+	}
+	// the current period is stable
+	m_decreased = false;
+	m_observation = m_observationDefault;
+	return 0;
+}
+
+uint32_t audio::river::io::PeriodAdapter::xrun() {
+	if (m_requested == true) {
+		return 0;
+	}
+	return increase(0, 0);
+}
+
+void audio::river::io::PeriodAdapter::cancelRequest() {
+	if (m_requested == false) {
+		return;
+	}
+	RIVER_VERBOSE("Request of a new period canceled ==> keep nb-chunk=" << m_nbChunk);
+	m_requested = false;
+}
+
+uint32_t audio::river::io::PeriodAdapter::increase(uint64_t _duration, uint64_t _period) {
+	m_windowStarted = false;
+	if (m_nbChunk*2 > m_max) {
+		if (m_maxReached == false) {
+			// reported one time: the callbacks can stay overloaded
+			m_maxReached = true;
+			m_eventDuration = _duration;
+			m_eventPeriod = _period;
+			m_eventNbChunk = m_nbChunk;
+			m_event = eventMax;
+		}
+		return 0;
+	}
+	if (m_decreased == true) {
+		// the previous decrease was too optimistic: wait longer before the next one
+		m_observation = etk::min(m_observation*2, uint64_t(3600000000000LL));
+		m_decreased = false;
+	}
+	m_eventDuration = _duration;
+	m_eventPeriod = _period;
+	m_eventNbChunk = m_nbChunk*2;
+	m_event = eventIncrease;
+	m_requested = true;
+	return m_nbChunk*2;
+}
+
+void audio::river::io::PeriodAdapter::report(const etk::String& _name) {
+	uint32_t event = m_event.exchange(eventNone);
+	if (event == eventNone) {
+		return;
+	}
+	etk::String origin = "xrun";
+	if (m_eventPeriod != 0) {
+		origin = "callback of " + etk::toString(m_eventDuration/1000) + " us for a period of " + etk::toString(m_eventPeriod/1000) + " us";
+	}
+	switch (event) {
+		case eventIncrease:
+			RIVER_INFO("Node '" << _name << "' deadline missed (" << origin << ") ==> nb-chunk=" << m_eventNbChunk << " (next decrease after " << m_observation/1000000000LL << " s)");
+			break;
+		case eventDecrease:
+			RIVER_INFO("Node '" << _name << "' low load (" << origin << ") ==> nb-chunk=" << m_eventNbChunk);
+			break;
+		case eventMax:
+			RIVER_WARNING("Node '" << _name << "' deadline missed (" << origin << ") with the maximum nb-chunk=" << m_eventNbChunk << " (reported one time)");
+			break;
+		default:
+			break;
+	}
+}
@@ -0,0 +1,108 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/String.hpp>
+#include <ejson/ejson.hpp>
+#include <audio/Time.hpp>
+#include <atomic>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Adaptation of the nb-chunk of a node on the load of its callback: the period is doubled as soon as a callback
+			 * miss its deadline (or a xrun happen), and divided by 2 only after a long time with a low load.
+			 * Configured in the node with:
+			 * @code
+			 * nb-chunk-adaptive:{
+			 * 	min:128, # minimum nb-chunk
+			 * 	max:4096, # maximum nb-chunk
+			 * 	low-load:20, # % of the period: the nb-chunk is divided by 2 when all the callbacks of the observation are below
+			 * 	high-load:70, # % of the period: the nb-chunk is doubled when a callback is above
+			 * 	observation:10, # time (s) of low load before a decrease (doubled each time a decrease has been followed by a miss)
+			 * },
+			 * @endcode
+			 * @note The adapter is kept by the manager when the node is re-created with its new period (it keep the history).
+			 */
+			class PeriodAdapter {
+				private:
+					uint32_t m_min; //!< Minimum nb-chunk
+					uint32_t m_max; //!< Maximum nb-chunk
+					uint32_t m_lowLoad; //!< Load (% of the period) under which the period can decrease
+					uint32_t m_highLoad; //!< Load (% of the period) over which the period increase
+					uint64_t m_observationDefault; //!< Configured time of low load before a decrease (ns)
+					uint64_t m_observation; //!< Current time of low load before a decrease (ns)
+					bool m_decreased; //!< The last change of the period is a decrease (not confirmed by a full observation)
+					uint32_t m_nbChunk; //!< Configured nb-chunk of the current node
+					std::atomic<bool> m_requested; //!< A new period has been requested (wait the re-creation of the node)
+					audio::Time m_processStart; //!< Start of the current callback
+					audio::Time m_windowStart; //!< Start of the current observation window
+					bool m_windowStarted; //!< The observation window is started
+					uint64_t m_windowMax; //!< Maximum duration of a callback in the observation window (ns)
+					bool m_maxReached; //!< A deadline has been missed with the maximum nb-chunk (latched until the next configuration: reported one time)
+					std::atomic<uint32_t> m_event; //!< Last change to log out of the audio thread (eventNone, eventIncrease, eventDecrease or eventMax)
+					uint64_t m_eventDuration; //!< Duration of the callback that generate the event (ns)
+					uint64_t m_eventPeriod; //!< Period of the node when the event is generated (ns, 0 for a xrun)
+					uint32_t m_eventNbChunk; //!< nb-chunk requested by the event (current one for eventMax)
+				public:
+					enum {
+						eventNone = 0,
+						eventIncrease,
+						eventDecrease,
+						eventMax
+					};
+				public:
+					/**
+					 * @brief Contructor (disable)
+					 */
+					PeriodAdapter();
+					/**
+					 * @brief Configure the adapter with the "nb-chunk-adaptive" object of a new node (the history is kept).
+					 * @param[in] _config Configuration of the node.
+					 * @param[in] _nbChunk Configured nb-chunk of the node.
+					 */
+					void configure(const ejson::Object& _config, uint32_t _nbChunk);
+					/**
+					 * @brief Call at the start of the callback.
+					 */
+					void processStart();
+					/**
+					 * @brief Call at the end of the callback.
+					 * @param[in] _nbChunk Number of chunk processed in the callback.
+					 * @param[in] _frequency Frequency of the node.
+					 * @return New nb-chunk to request, 0 to keep the current one.
+					 */
+					uint32_t processStop(uint32_t _nbChunk, uint32_t _frequency);
+					/**
+					 * @brief Call when the backend report a xrun.
+					 * @return New nb-chunk to request, 0 to keep the current one.
+					 */
+					uint32_t xrun();
+					/**
+					 * @brief Cancel the pending request: the node will not be re-created (request dropped or re-creation failed).
+					 * @note Can be called out of the audio thread.
+					 */
+					void cancelRequest();
+					/**
+					 * @brief Log the last change of the adapter (called out of the audio thread: processStop() and xrun() never log).
+					 * @param[in] _name Name of the node.
+					 */
+					void report(const etk::String& _name);
+				private:
+					/**
+					 * @brief Double the period (deadline missed).
+					 * @param[in] _duration Duration of the callback (ns), 0 for a xrun.
+					 * @param[in] _period Period of the node (ns), 0 for a xrun.
+					 * @return New nb-chunk to request, 0 if the maximum is reached.
+					 */
+					uint32_t increase(uint64_t _duration, uint64_t _period);
+			};
+		}
+	}
+}
+
@@ -0,0 +1,427 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <audio/river/io/ShmRing.hpp>
+#include <audio/river/debug.hpp>
+
+extern "C" {
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <string.h>
+	#include <time.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/syscall.h>
+	#include <linux/futex.h>
+}
+
+// "RVRG"
+static const uint32_t ringMagic = 0x47525652;
+static const uint32_t ringVersion = 1;
+static const uint32_t ringMaxChannel = 32;
+// Number of read of the time before to consider the writer dead during an update
+static const uint32_t timeMaxRetry = 1000;
+
+/**
+ * @brief Header of the segment (the frames follow it, aligned on a cache line).
+ * The fields after "map" are accessed with atomic operations only.
+ */
+struct ShmRingHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t format; //!< audio::format of the samples
+	uint32_t frequency; //!< Frequency of the flow
+	uint32_t capacity; //!< Number of frame of the ring
+	uint32_t frameSize; //!< Size of a frame in byte
+	uint32_t output; //!< 1: the client produce the data
+	uint32_t nbChannel; //!< Number of channel
+	uint8_t map[ringMaxChannel]; //!< audio::channel of each channel
+	uint64_t writePosition; //!< Counter of frame written
+	uint64_t readPosition; //!< Counter of frame read
+	uint32_t writeEvent; //!< Futex incremented at each write
+	uint32_t readEvent; //!< Futex incremented at each read
+	uint32_t writeWaiting; //!< The consumer wait a write
+	uint32_t readWaiting; //!< The producer wait a read
+	uint32_t timeSequence; //!< Sequence lock of the time (odd during an update)
+	uint32_t padding;
+	uint64_t timePosition; //!< Position of the frame that has the time
+	int64_t timeNs; //!< Time of the frame (ns)
+};
+
+/**
+ * @brief Check that a format read in a segment is a format of the samples.
+ * @param[in] _format Value of the header.
+ * @return true The format is valid.
+ */
+static bool isValidFormat(uint32_t _format) {
+	switch (audio::format(_format)) {
+		case audio::format_int8:
+		case audio::format_int16:
+		case audio::format_int16_on_int32:
+		case audio::format_int24:
+		case audio::format_int32:
+		case audio::format_int32_on_int64:
+		case audio::format_int64:
+		case audio::format_float:
+		case audio::format_double:
+			return true;
+		default:
+			return false;
+	}
+}
+
+static size_t getHeaderSize() {
+	return (sizeof(ShmRingHeader) + 63) & ~size_t(63);
+}
+
+static ShmRingHeader* getHeader(void* _memory) {
+	return static_cast<ShmRingHeader*>(_memory);
+}
+
+static int32_t futexWait(uint32_t* _address, uint32_t _value, uint32_t _timeoutMs) {
+	struct timespec timeout;
+	timeout.tv_sec = _timeoutMs/1000;
+	timeout.tv_nsec = (_timeoutMs%1000)*1000000;
+	return syscall(SYS_futex, _address, FUTEX_WAIT, _value, &timeout, null, 0);
+}
+
+/**
+ * @brief Get the time elapsed since a start time.
+ * @param[in] _start Start time (CLOCK_MONOTONIC).
+ * @return Number of millisecond.
+ */
+static uint32_t getElapsedMs(const struct timespec& _start) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	int64_t elapsed = (int64_t(now.tv_sec) - int64_t(_start.tv_sec))*1000LL + (int64_t(now.tv_nsec) - int64_t(_start.tv_nsec))/1000000LL;
+	return uint32_t(etk::max(int64_t(0), elapsed));
+}
+
+static void futexWake(uint32_t* _address) {
+	syscall(SYS_futex, _address, FUTEX_WAKE, 1, null, null, 0);
+}
+
+audio::river::io::ShmRing::ShmRing() :
+  m_memory(null),
+  m_memorySize(0),
+  m_owner(false),
+  m_data(null),
+  m_frameSize(0),
+  m_capacity(0),
+  m_format(audio::format_unknow),
+  m_frequency(0),
+  m_output(false) {
+	
+}
+
+audio::river::io::ShmRing::~ShmRing() {
+	close();
+}
+
+bool audio::river::io::ShmRing::create(const etk::String& _name,
+                                       audio::format _format,
+                                       uint32_t _frequency,
+                                       const etk::Vector<audio::channel>& _map,
+                                       uint32_t _capacity,
+                                       bool _output) {
+	close();
+	if (    _map.size() == 0
+	     || _map.size() > ringMaxChannel
+	     || _capacity == 0
+	     || _frequency == 0
+	     || isValidFormat(uint32_t(_format)) == false) {
+		RIVER_ERROR("Can not create the ring '" << _name << "' format=" << _format << " frequency=" << _frequency << " map=" << _map << " capacity=" << _capacity);
+		return false;
+	}
+	uint32_t frameSize = audio::getFormatBytes(_format)*_map.size();
+	size_t size = getHeaderSize() + size_t(frameSize)*_capacity;
+	int fd = shm_open(_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		RIVER_ERROR("Can not create the shared memory '" << _name << "' : " << strerror(errno));
+		return false;
+	}
+	if (ftruncate(fd, size) != 0) {
+		RIVER_ERROR("Can not resize the shared memory '" << _name << "' : " << strerror(errno));
+		::close(fd);
+		shm_unlink(_name.c_str());
+		return false;
+	}
+	void* memory = mmap(null, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED) {
+		RIVER_ERROR("Can not map the shared memory '" << _name << "' : " << strerror(errno));
+		shm_unlink(_name.c_str());
+		return false;
+	}
+	// the segment is created full of 0
+	ShmRingHeader* header = getHeader(memory);
+	header->version = ringVersion;
+	header->format = uint32_t(_format);
+	header->frequency = _frequency;
+	header->capacity = _capacity;
+	header->frameSize = frameSize;
+	header->output = _output == true ? 1 : 0;
+	header->nbChannel = _map.size();
+	for (size_t iii=0; iii<_map.size(); ++iii) {
+		header->map[iii] = uint8_t(_map[iii]);
+	}
+	__atomic_store_n(&header->magic, ringMagic, __ATOMIC_RELEASE);
+	m_name = _name;
+	m_memory = memory;
+	m_memorySize = size;
+	m_owner = true;
+	m_data = static_cast<uint8_t*>(memory) + getHeaderSize();
+	m_frameSize = frameSize;
+	m_capacity = _capacity;
+	m_format = _format;
+	m_frequency = _frequency;
+	m_map = _map;
+	m_output = _output;
+	return true;
+}
+
+bool audio::river::io::ShmRing::open(const etk::String& _name) {
+	close();
+	int fd = shm_open(_name.c_str(), O_RDWR, 0600);
+	if (fd < 0) {
+		RIVER_ERROR("Can not open the shared memory '" << _name << "' : " << strerror(errno));
+		return false;
+	}
+	struct stat info;
+	if (    fstat(fd, &info) != 0
+	     || size_t(info.st_size) < getHeaderSize()) {
+		RIVER_ERROR("Wrong size of the shared memory '" << _name << "'");
+		::close(fd);
+		return false;
+	}
+	size_t size = info.st_size;
+	void* memory = mmap(null, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (memory == MAP_FAILED) {
+		RIVER_ERROR("Can not map the shared memory '" << _name << "' : " << strerror(errno));
+		return false;
+	}
+	ShmRingHeader* header = getHeader(memory);
+	if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != ringMagic) {
+		RIVER_ERROR("Wrong header of the shared memory '" << _name << "'");
+		munmap(memory, size);
+		return false;
+	}
+	// the header is read once: the other process can modify it after the check
+	uint32_t version = __atomic_load_n(&header->version, __ATOMIC_RELAXED);
+	uint32_t format = __atomic_load_n(&header->format, __ATOMIC_RELAXED);
+	uint32_t frequency = __atomic_load_n(&header->frequency, __ATOMIC_RELAXED);
+	uint32_t capacity = __atomic_load_n(&header->capacity, __ATOMIC_RELAXED);
+	uint32_t frameSize = __atomic_load_n(&header->frameSize, __ATOMIC_RELAXED);
+	uint32_t output = __atomic_load_n(&header->output, __ATOMIC_RELAXED);
+	uint32_t nbChannel = __atomic_load_n(&header->nbChannel, __ATOMIC_RELAXED);
+	if (    version != ringVersion
+	     || isValidFormat(format) == false
+	     || frequency == 0
+	     || nbChannel == 0
+	     || nbChannel > ringMaxChannel
+	     || frameSize != audio::getFormatBytes(audio::format(format))*nbChannel
+	     || capacity == 0
+	     || getHeaderSize() + size_t(frameSize)*capacity > size) {
+		RIVER_ERROR("Wrong header of the shared memory '" << _name << "' format=" << format << " frequency=" << frequency << " nbChannel=" << nbChannel << " frameSize=" << frameSize << " capacity=" << capacity);
+		munmap(memory, size);
+		return false;
+	}
+	m_map.clear();
+	for (uint32_t iii=0; iii<nbChannel; ++iii) {
+		m_map.pushBack(audio::channel(__atomic_load_n(&header->map[iii], __ATOMIC_RELAXED)));
+	}
+	m_name = _name;
+	m_memory = memory;
+	m_memorySize = size;
+	m_owner = false;
+	m_data = static_cast<uint8_t*>(memory) + getHeaderSize();
+	m_frameSize = frameSize;
+	m_capacity = capacity;
+	m_format = audio::format(format);
+	m_frequency = frequency;
+	m_output = output == 1;
+	return true;
+}
+
+void audio::river::io::ShmRing::unlink() {
+	if (    m_owner == true
+	     && m_name != "") {
+		shm_unlink(m_name.c_str());
+		m_owner = false;
+	}
+}
+
+void audio::river::io::ShmRing::close() {
+	unlink();
+	if (m_memory != null) {
+		munmap(m_memory, m_memorySize);
+	}
+	m_memory = null;
+	m_memorySize = 0;
+	m_data = null;
+	m_frameSize = 0;
+	m_capacity = 0;
+	m_format = audio::format_unknow;
+	m_frequency = 0;
+	m_map.clear();
+	m_output = false;
+}
+
+uint64_t audio::river::io::ShmRing::getWritePosition() const {
+	return __atomic_load_n(&getHeader(m_memory)->writePosition, __ATOMIC_ACQUIRE);
+}
+
+uint64_t audio::river::io::ShmRing::getReadPosition() const {
+	return __atomic_load_n(&getHeader(m_memory)->readPosition, __ATOMIC_ACQUIRE);
+}
+
+uint32_t audio::river::io::ShmRing::getFillSize() const {
+	return uint32_t(getWritePosition() - getReadPosition());
+}
+
+uint32_t audio::river::io::ShmRing::write(const void* _data, uint32_t _nbFrame) {
+	uint64_t position = getWritePosition();
+	uint32_t nbFrame = etk::min(_nbFrame, getFreeSize());
+	const uint8_t* data = static_cast<const uint8_t*>(_data);
+	uint32_t offset = 0;
+	while (offset < nbFrame) {
+		uint32_t index = (position + offset) % m_capacity;
+		uint32_t size = etk::min(nbFrame - offset, m_capacity - index);
+		memcpy(m_data + index*m_frameSize, data + offset*m_frameSize, size*m_frameSize);
+		offset += size;
+	}
+	if (nbFrame != 0) {
+		commitWrite(nbFrame);
+	}
+	return nbFrame;
+}
+
+uint32_t audio::river::io::ShmRing::read(void* _data, uint32_t _nbFrame) {
+	uint64_t position = getReadPosition();
+	uint32_t nbFrame = etk::min(_nbFrame, getFillSize());
+	uint8_t* data = static_cast<uint8_t*>(_data);
+	uint32_t offset = 0;
+	while (offset < nbFrame) {
+		uint32_t index = (position + offset) % m_capacity;
+		uint32_t size = etk::min(nbFrame - offset, m_capacity - index);
+		memcpy(data + offset*m_frameSize, m_data + index*m_frameSize, size*m_frameSize);
+		offset += size;
+	}
+	if (nbFrame < _nbFrame) {
+		memset(data + nbFrame*m_frameSize, 0, (_nbFrame - nbFrame)*m_frameSize);
+	}
+	if (nbFrame != 0) {
+		commitRead(nbFrame);
+	}
+	return nbFrame;
+}
+
+void audio::river::io::ShmRing::commitWrite(uint32_t _nbFrame) {
+	ShmRingHeader* header = getHeader(m_memory);
+	__atomic_add_fetch(&header->writePosition, uint64_t(_nbFrame), __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&header->writeEvent, 1, __ATOMIC_SEQ_CST);
+	// the system call is done only when the consumer sleep
+	if (__atomic_load_n(&header->writeWaiting, __ATOMIC_SEQ_CST) != 0) {
+		futexWake(&header->writeEvent);
+	}
+}
+
+void audio::river::io::ShmRing::commitRead(uint32_t _nbFrame) {
+	ShmRingHeader* header = getHeader(m_memory);
+	__atomic_add_fetch(&header->readPosition, uint64_t(_nbFrame), __ATOMIC_SEQ_CST);
+	__atomic_add_fetch(&header->readEvent, 1, __ATOMIC_SEQ_CST);
+	if (__atomic_load_n(&header->readWaiting, __ATOMIC_SEQ_CST) != 0) {
+		futexWake(&header->readEvent);
+	}
+}
+
+bool audio::river::io::ShmRing::waitRead(uint32_t _nbFrame, uint32_t _timeoutMs) {
+	ShmRingHeader* header = getHeader(m_memory);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (true) {
+		uint32_t event = __atomic_load_n(&header->writeEvent, __ATOMIC_SEQ_CST);
+		if (getFillSize() >= _nbFrame) {
+			return true;
+		}
+		// a write smaller than the request wake up the consumer: wait again until the end of the timeout
+		uint32_t elapsed = getElapsedMs(start);
+		if (elapsed >= _timeoutMs) {
+			return false;
+		}
+		__atomic_store_n(&header->writeWaiting, 1, __ATOMIC_SEQ_CST);
+		// check again: the producer can have written before it see the flag
+		if (getFillSize() < _nbFrame) {
+			futexWait(&header->writeEvent, event, _timeoutMs - elapsed);
+		}
+		__atomic_store_n(&header->writeWaiting, 0, __ATOMIC_SEQ_CST);
+	}
+}
+
+bool audio::river::io::ShmRing::waitWrite(uint32_t _nbFrame, uint32_t _timeoutMs) {
+	ShmRingHeader* header = getHeader(m_memory);
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	while (true) {
+		uint32_t event = __atomic_load_n(&header->readEvent, __ATOMIC_SEQ_CST);
+		if (getFreeSize() >= _nbFrame) {
+			return true;
+		}
+		uint32_t elapsed = getElapsedMs(start);
+		if (elapsed >= _timeoutMs) {
+			return false;
+		}
+		__atomic_store_n(&header->readWaiting, 1, __ATOMIC_SEQ_CST);
+		if (getFreeSize() < _nbFrame) {
+			futexWait(&header->readEvent, event, _timeoutMs - elapsed);
+		}
+		__atomic_store_n(&header->readWaiting, 0, __ATOMIC_SEQ_CST);
+	}
+}
+
+void audio::river::io::ShmRing::setTime(uint64_t _position, const audio::Time& _time) {
+	ShmRingHeader* header = getHeader(m_memory);
+	__atomic_add_fetch(&header->timeSequence, 1, __ATOMIC_SEQ_CST);
+	__atomic_store_n(&header->timePosition, _position, __ATOMIC_RELAXED);
+	__atomic_store_n(&header->timeNs, (_time - audio::Time()).get(), __ATOMIC_RELAXED);
+	__atomic_add_fetch(&header->timeSequence, 1, __ATOMIC_SEQ_CST);
+}
+
+bool audio::river::io::ShmRing::getTime(uint64_t _position, audio::Time& _time) const {
+	const ShmRingHeader* header = getHeader(m_memory);
+	uint64_t position = 0;
+	int64_t timeNs = 0;
+	// the update is 2 stores: a sequence odd for longer than the retries is a writer dead during the update
+	bool valid = false;
+	for (uint32_t iii=0; iii<timeMaxRetry; ++iii) {
+		uint32_t sequence = __atomic_load_n(&header->timeSequence, __ATOMIC_SEQ_CST);
+		if (sequence == 0) {
+			// no time published
+			return false;
+		}
+		if ((sequence & 1) != 0) {
+			continue;
+		}
+		position = __atomic_load_n(&header->timePosition, __ATOMIC_RELAXED);
+		timeNs = __atomic_load_n(&header->timeNs, __ATOMIC_RELAXED);
+		if (__atomic_load_n(&header->timeSequence, __ATOMIC_SEQ_CST) == sequence) {
+			valid = true;
+			break;
+		}
+	}
+	if (valid == false) {
+		return false;
+	}
+	timeNs += (int64_t(_position) - int64_t(position))*1000000000LL/int64_t(m_frequency);
+	_time = audio::Time() + audio::Duration(timeNs/1000000000LL, timeNs%1000000000LL);
+	return true;
+}
+
+#endif
@@ -0,0 +1,213 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <etk/types.hpp>
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <audio/format.hpp>
+#include <audio/channel.hpp>
+#include <audio/Time.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Ring of frames in a POSIX shared memory segment, shared by 2 processes (one producer and one consumer, no lock).
+			 * The positions are counters of frames (never wrapped), the consumer and the producer are waked up with a futex.
+			 * The client create the segment, the server open it with its name (the name is removed when the 2 processes have it).
+			 */
+			class ShmRing {
+				private:
+					etk::String m_name; //!< Name of the segment
+					void* m_memory; //!< Mapping of the segment
+					size_t m_memorySize; //!< Size of the mapping
+					bool m_owner; //!< The segment has been created by this process
+					uint8_t* m_data; //!< First frame of the ring
+					uint32_t m_frameSize; //!< Size of a frame in byte
+					uint32_t m_capacity; //!< Number of frame in the ring
+					audio::format m_format; //!< Format of the samples (copied at the opening: the header can be modified by the other process)
+					uint32_t m_frequency; //!< Frequency of the flow
+					etk::Vector<audio::channel> m_map; //!< Channel map of the flow
+					bool m_output; //!< The client produce the data
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					ShmRing();
+					/**
+					 * @brief Destructor (unmap the segment)
+					 */
+					~ShmRing();
+					/**
+					 * @brief Create a new segment (client side).
+					 * @param[in] _name Name of the segment (start with '/').
+					 * @param[in] _format Format of the samples.
+					 * @param[in] _frequency Frequency of the flow.
+					 * @param[in] _map Channel map of the flow.
+					 * @param[in] _capacity Number of frame of the ring.
+					 * @param[in] _output true: the client produce the data (output), false: the server produce the data (input).
+					 * @return true The segment is created.
+					 */
+					bool create(const etk::String& _name,
+					            audio::format _format,
+					            uint32_t _frequency,
+					            const etk::Vector<audio::channel>& _map,
+					            uint32_t _capacity,
+					            bool _output);
+					/**
+					 * @brief Open a segment created by an other process (server side).
+					 * The description of the flow is checked (format, frequency, size of a frame) and copied: the other process is not trusted.
+					 * @param[in] _name Name of the segment.
+					 * @return true The segment is mapped.
+					 */
+					bool open(const etk::String& _name);
+					/**
+					 * @brief Remove the name of the segment (the mappings stay valid).
+					 */
+					void unlink();
+					/**
+					 * @brief Unmap the segment.
+					 */
+					void close();
+					/**
+					 * @brief Check if the segment is mapped.
+					 * @return true The ring can be used.
+					 */
+					bool isOpen() const {
+						return m_memory != null;
+					}
+					/**
+					 * @brief Get the name of the segment.
+					 * @return Name of the segment.
+					 */
+					const etk::String& getName() const {
+						return m_name;
+					}
+					/**
+					 * @brief Get the format of the samples.
+					 * @return Format of the samples.
+					 */
+					audio::format getFormat() const {
+						return m_format;
+					}
+					/**
+					 * @brief Get the frequency of the flow.
+					 * @return Frequency.
+					 */
+					uint32_t getFrequency() const {
+						return m_frequency;
+					}
+					/**
+					 * @brief Get the channel map of the flow.
+					 * @return Channel map.
+					 */
+					const etk::Vector<audio::channel>& getMap() const {
+						return m_map;
+					}
+					/**
+					 * @brief Get the number of frame of the ring.
+					 * @return Number of frame.
+					 */
+					uint32_t getCapacity() const {
+						return m_capacity;
+					}
+					/**
+					 * @brief Get the direction of the flow.
+					 * @return true The client produce the data.
+					 */
+					bool isOutput() const {
+						return m_output;
+					}
+					/**
+					 * @brief Get the number of frame that can be read.
+					 * @return Number of frame.
+					 */
+					uint32_t getFillSize() const;
+					/**
+					 * @brief Get the number of frame that can be written.
+					 * @return Number of frame.
+					 */
+					uint32_t getFreeSize() const {
+						return m_capacity - getFillSize();
+					}
+					/**
+					 * @brief Get the position of the next frame to write (producer).
+					 * @return Position (counter of frame).
+					 */
+					uint64_t getWritePosition() const;
+					/**
+					 * @brief Get the position of the next frame to read (consumer).
+					 * @return Position (counter of frame).
+					 */
+					uint64_t getReadPosition() const;
+					/**
+					 * @brief Get the frames at a position (in place access, the caller must not cross the end of the ring).
+					 * @param[in] _position Position of the frame.
+					 * @return Pointer on the frame.
+					 */
+					uint8_t* getFrame(uint64_t _position) {
+						return m_data + (_position % m_capacity) * m_frameSize;
+					}
+					/**
+					 * @brief Copy frames in the ring (producer), the frames that do not fit are dropped.
+					 * @param[in] _data Interleaved frames.
+					 * @param[in] _nbFrame Number of frame.
+					 * @return Number of frame written.
+					 */
+					uint32_t write(const void* _data, uint32_t _nbFrame);
+					/**
+					 * @brief Copy frames of the ring (consumer), the missing frames are set to 0.
+					 * @param[out] _data Interleaved frames.
+					 * @param[in] _nbFrame Number of frame.
+					 * @return Number of frame read.
+					 */
+					uint32_t read(void* _data, uint32_t _nbFrame);
+					/**
+					 * @brief Publish the frames written in place (producer) and wake up the consumer.
+					 * @param[in] _nbFrame Number of frame.
+					 */
+					void commitWrite(uint32_t _nbFrame);
+					/**
+					 * @brief Release the frames read in place (consumer) and wake up the producer.
+					 * @param[in] _nbFrame Number of frame.
+					 */
+					void commitRead(uint32_t _nbFrame);
+					/**
+					 * @brief Wait until some frames can be read (the smaller writes of the producer do not stop the wait before the timeout).
+					 * @param[in] _nbFrame Number of frame needed.
+					 * @param[in] _timeoutMs Maximum waiting time.
+					 * @return true The frames are availlable.
+					 */
+					bool waitRead(uint32_t _nbFrame, uint32_t _timeoutMs);
+					/**
+					 * @brief Wait until some frames can be written (the smaller reads of the consumer do not stop the wait before the timeout).
+					 * @param[in] _nbFrame Number of frame needed.
+					 * @param[in] _timeoutMs Maximum waiting time.
+					 * @return true The space is availlable.
+					 */
+					bool waitWrite(uint32_t _nbFrame, uint32_t _timeoutMs);
+					/**
+					 * @brief Set the time of a frame (the server publish the time of the device).
+					 * @param[in] _position Position of the frame.
+					 * @param[in] _time Time of the frame.
+					 */
+					void setTime(uint64_t _position, const audio::Time& _time);
+					/**
+					 * @brief Get the time of a frame, extrapolated from the last time published.
+					 * @param[in] _position Position of the frame.
+					 * @param[out] _time Time of the frame.
+					 * @return true A time has been published (false too if the peer died during an update).
+					 */
+					bool getTime(uint64_t _position, audio::Time& _time) const;
+			};
+		}
+	}
+}
+
+#endif
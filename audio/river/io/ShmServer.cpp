@@ -0,0 +1,403 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <audio/river/io/ShmServer.hpp>
+#include <audio/river/io/Manager.hpp>
+#include <audio/river/debug.hpp>
+#include <ejson/ejson.hpp>
+
+extern "C" {
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <errno.h>
+	#include <signal.h>
+	#include <string.h>
+	#include <time.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <sys/syscall.h>
+	#include <linux/futex.h>
+}
+
+// "RVCT"
+static const uint32_t controlMagic = 0x54435652;
+static const uint32_t controlVersion = 2;
+static const uint32_t controlNbSlot = 32;
+static const uint32_t controlNameSize = 64;
+// Maximum time to wait the answer of the server
+static const uint32_t connectTimeoutMs = 2000;
+
+enum controlState {
+	controlState_free = 0, //!< slot unused (or filled by the client that own it)
+	controlState_request, //!< wait the connection of the server
+	controlState_connected, //!< the ring is connected on the node
+	controlState_close, //!< the client request the disconnection
+	controlState_refused //!< the server can not connect the ring
+};
+
+/**
+ * @brief Request of a client (the state and the pid are accessed with atomic operations only, the state is a futex for the answer).
+ * A client own a slot when it set its pid in a slot without pid, all the changes of the state are then compare-and-swap: the
+ * server and the client never overwrite the transition of the other.
+ */
+struct ShmControlSlot {
+	uint32_t state; //!< @ref controlState
+	int32_t clientPid; //!< Process of the client that own the slot (0 if the slot is free)
+	char node[controlNameSize]; //!< Name of the requested node
+	char ring[controlNameSize]; //!< Name of the ring segment
+};
+
+/**
+ * @brief Control segment of the server.
+ */
+struct ShmControl {
+	uint32_t magic;
+	uint32_t version;
+	int32_t serverPid; //!< Process of the server
+	uint32_t event; //!< Futex incremented at each request of a client
+	ShmControlSlot slot[controlNbSlot];
+};
+
+static int32_t futexWait(uint32_t* _address, uint32_t _value, uint32_t _timeoutMs) {
+	struct timespec timeout;
+	timeout.tv_sec = _timeoutMs/1000;
+	timeout.tv_nsec = (_timeoutMs%1000)*1000000;
+	return syscall(SYS_futex, _address, FUTEX_WAIT, _value, &timeout, null, 0);
+}
+
+static void futexWake(uint32_t* _address) {
+	syscall(SYS_futex, _address, FUTEX_WAKE, 1, null, null, 0);
+}
+
+static void notifyServer(ShmControl* _control) {
+	__atomic_add_fetch(&_control->event, 1, __ATOMIC_SEQ_CST);
+	futexWake(&_control->event);
+}
+
+/**
+ * @brief Change the state of a slot if it has not been changed by the peer.
+ * @param[in] _slot Slot to update.
+ * @param[in] _expected Current state of the slot.
+ * @param[in] _state New state of the slot.
+ * @return true The state has changed.
+ */
+static bool changeState(ShmControlSlot& _slot, uint32_t _expected, uint32_t _state) {
+	if (__atomic_compare_exchange_n(&_slot.state, &_expected, _state, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) == false) {
+		return false;
+	}
+	futexWake(&_slot.state);
+	return true;
+}
+
+/**
+ * @brief Free a slot (the state first: a slot without pid is always in the free state).
+ * @param[in] _slot Slot to release.
+ */
+static void releaseSlot(ShmControlSlot& _slot) {
+	__atomic_store_n(&_slot.state, uint32_t(controlState_free), __ATOMIC_SEQ_CST);
+	futexWake(&_slot.state);
+	__atomic_store_n(&_slot.clientPid, 0, __ATOMIC_SEQ_CST);
+}
+
+static bool isProcessAlive(int32_t _pid) {
+	return    kill(_pid, 0) == 0
+	       || errno != ESRCH;
+}
+
+/**
+ * @brief Map the control segment of a server (client side).
+ * @param[in] _server Name of the server.
+ * @return Pointer on the control (null if the server is not started).
+ */
+static ShmControl* mapControl(const etk::String& _server) {
+	etk::String name = audio::river::io::ShmServer::getSegmentName(_server);
+	int fd = shm_open(name.c_str(), O_RDWR, 0600);
+	if (fd < 0) {
+		RIVER_ERROR("Can not open the river server '" << _server << "' : " << strerror(errno));
+		return null;
+	}
+	void* memory = mmap(null, sizeof(ShmControl), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		RIVER_ERROR("Can not map the river server '" << _server << "' : " << strerror(errno));
+		return null;
+	}
+	ShmControl* control = static_cast<ShmControl*>(memory);
+	if (    __atomic_load_n(&control->magic, __ATOMIC_ACQUIRE) != controlMagic
+	     || control->version != controlVersion) {
+		RIVER_ERROR("Wrong version of the river server '" << _server << "'");
+		munmap(memory, sizeof(ShmControl));
+		return null;
+	}
+	return control;
+}
+
+etk::String audio::river::io::ShmServer::getSegmentName(const etk::String& _name) {
+	return "/river-" + _name;
+}
+
+int32_t audio::river::io::ShmServer::connect(const etk::String& _server, const etk::String& _node, const etk::String& _ring, int32_t& _serverPid) {
+	if (    _node.size() >= controlNameSize
+	     || _ring.size() >= controlNameSize) {
+		RIVER_ERROR("Name too long to connect '" << _node << "' on the river server '" << _server << "'");
+		return -1;
+	}
+	ShmControl* control = mapControl(_server);
+	if (control == null) {
+		return -1;
+	}
+	_serverPid = control->serverPid;
+	int32_t out = -1;
+	int32_t pid = getpid();
+	for (uint32_t iii=0; iii<controlNbSlot; ++iii) {
+		// the pid is the reservation: the server reclaim the slot if the client die before the request
+		int32_t owner = 0;
+		if (__atomic_compare_exchange_n(&control->slot[iii].clientPid, &owner, pid, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) == true) {
+			out = iii;
+			break;
+		}
+	}
+	if (out < 0) {
+		RIVER_ERROR("No more connection availlable on the river server '" << _server << "'");
+		munmap(control, sizeof(ShmControl));
+		return -1;
+	}
+	ShmControlSlot& slot = control->slot[out];
+	strncpy(slot.node, _node.c_str(), controlNameSize);
+	strncpy(slot.ring, _ring.c_str(), controlNameSize);
+	if (changeState(slot, controlState_free, controlState_request) == false) {
+		RIVER_ERROR("The slot " << out << " of the river server '" << _server << "' is not free");
+		munmap(control, sizeof(ShmControl));
+		return -1;
+	}
+	notifyServer(control);
+	// wait the answer of the server
+	uint32_t waited = 0;
+	uint32_t state = controlState_request;
+	while (    (state = __atomic_load_n(&slot.state, __ATOMIC_SEQ_CST)) == controlState_request
+	        && waited < connectTimeoutMs) {
+		futexWait(&slot.state, controlState_request, 100);
+		waited += 100;
+	}
+	if (    state == controlState_request
+	     && changeState(slot, controlState_request, controlState_close) == true) {
+		// no answer: the server will release the slot when it process the request
+		RIVER_ERROR("The river server '" << _server << "' does not answer to the connection on '" << _node << "'");
+		notifyServer(control);
+		munmap(control, sizeof(ShmControl));
+		return -1;
+	}
+	// the server may have answered during the timeout
+	state = __atomic_load_n(&slot.state, __ATOMIC_SEQ_CST);
+	if (state != controlState_connected) {
+		RIVER_ERROR("The river server '" << _server << "' refuse the connection on '" << _node << "'");
+		if (state == controlState_refused) {
+			releaseSlot(slot);
+		}
+		out = -1;
+	}
+	munmap(control, sizeof(ShmControl));
+	return out;
+}
+
+void audio::river::io::ShmServer::disconnect(const etk::String& _server, int32_t _id) {
+	if (    _id < 0
+	     || _id >= int32_t(controlNbSlot)) {
+		return;
+	}
+	ShmControl* control = mapControl(_server);
+	if (control == null) {
+		return;
+	}
+	uint32_t state = controlState_connected;
+	if (__atomic_compare_exchange_n(&control->slot[_id].state, &state, uint32_t(controlState_close), false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) == true) {
+		notifyServer(control);
+	}
+	munmap(control, sizeof(ShmControl));
+}
+
+audio::river::io::ShmServer::ShmServer() :
+  m_memory(null),
+  m_alive(false) {
+	
+}
+
+audio::river::io::ShmServer::~ShmServer() {
+	unInit();
+}
+
+bool audio::river::io::ShmServer::init(const etk::String& _name) {
+	unInit();
+	etk::String name = getSegmentName(_name);
+	// remove the segment of a previous server that has crashed
+	shm_unlink(name.c_str());
+	int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		RIVER_ERROR("Can not create the river server '" << _name << "' : " << strerror(errno));
+		return false;
+	}
+	if (ftruncate(fd, sizeof(ShmControl)) != 0) {
+		RIVER_ERROR("Can not resize the river server '" << _name << "' : " << strerror(errno));
+		close(fd);
+		shm_unlink(name.c_str());
+		return false;
+	}
+	void* memory = mmap(null, sizeof(ShmControl), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (memory == MAP_FAILED) {
+		RIVER_ERROR("Can not map the river server '" << _name << "' : " << strerror(errno));
+		shm_unlink(name.c_str());
+		return false;
+	}
+	ShmControl* control = static_cast<ShmControl*>(memory);
+	control->version = controlVersion;
+	control->serverPid = getpid();
+	__atomic_store_n(&control->magic, controlMagic, __ATOMIC_RELEASE);
+	m_name = _name;
+	m_memory = memory;
+	m_alive = true;
+	m_thread = ememory::makeShared<ethread::Thread>([=](){this->threadCallback();}, "RIVER shm server");
+	RIVER_INFO("River server '" << m_name << "' started");
+	return true;
+}
+
+void audio::river::io::ShmServer::unInit() {
+	m_alive = false;
+	if (m_thread != null) {
+		m_thread->join();
+		m_thread.reset();
+	}
+	if (m_memory == null) {
+		return;
+	}
+	ShmControl* control = static_cast<ShmControl*>(m_memory);
+	// no new client
+	__atomic_store_n(&control->magic, 0, __ATOMIC_RELEASE);
+	shm_unlink(getSegmentName(m_name).c_str());
+	for (uint32_t iii=0; iii<controlNbSlot; ++iii) {
+		closeConnection(iii);
+		releaseSlot(control->slot[iii]);
+	}
+	munmap(m_memory, sizeof(ShmControl));
+	m_memory = null;
+	RIVER_INFO("River server '" << m_name << "' stopped");
+}
+
+void audio::river::io::ShmServer::threadCallback() {
+	ShmControl* control = static_cast<ShmControl*>(m_memory);
+	while (m_alive == true) {
+		uint32_t event = __atomic_load_n(&control->event, __ATOMIC_SEQ_CST);
+		for (uint32_t iii=0; iii<controlNbSlot; ++iii) {
+			ShmControlSlot& slot = control->slot[iii];
+			int32_t pid = __atomic_load_n(&slot.clientPid, __ATOMIC_SEQ_CST);
+			if (pid == 0) {
+				continue;
+			}
+			uint32_t state = __atomic_load_n(&slot.state, __ATOMIC_SEQ_CST);
+			if (state == controlState_request) {
+				bool connected = openConnection(iii);
+				if (changeState(slot, controlState_request, connected == true ? controlState_connected : controlState_refused) == false) {
+					// the client has given up during the connection
+					closeConnection(iii);
+					releaseSlot(slot);
+				}
+			} else if (state == controlState_close) {
+				closeConnection(iii);
+				releaseSlot(slot);
+			} else if (isProcessAlive(pid) == false) {
+				// a slot reserved, connected or refused by a dead client is never released by the client
+				RIVER_WARNING("River client " << pid << " has crashed ==> release its slot " << iii);
+				closeConnection(iii);
+				releaseSlot(slot);
+			}
+		}
+		// the timeout check the crash of the clients
+		futexWait(&control->event, event, 500);
+	}
+}
+
+bool audio::river::io::ShmServer::openConnection(uint32_t _slot) {
+	ShmControlSlot& slot = static_cast<ShmControl*>(m_memory)->slot[_slot];
+	etk::String nodeName(slot.node, strnlen(slot.node, controlNameSize));
+	etk::String ringName(slot.ring, strnlen(slot.ring, controlNameSize));
+	ememory::SharedPtr<Connection> connection = ememory::makeShared<Connection>();
+	connection->m_slot = _slot;
+	connection->m_pid = __atomic_load_n(&slot.clientPid, __ATOMIC_SEQ_CST);
+	if (connection->m_ring.open(ringName) == false) {
+		return false;
+	}
+	ememory::SharedPtr<audio::river::io::Node> node = audio::river::io::Manager::getInstance()->getNode(nodeName);
+	if (node == null) {
+		RIVER_ERROR("River client " << connection->m_pid << " request a node that does not exist: '" << nodeName << "'");
+		return false;
+	}
+	if (node->isOutput() != connection->m_ring.isOutput()) {
+		RIVER_ERROR("River client " << connection->m_pid << " request the node '" << nodeName << "' in the wrong direction");
+		return false;
+	}
+	// the conversion to the node is done by the interface, as for a local client
+	ejson::Object tmpOption;
+	tmpOption.add("io", ejson::String(connection->m_ring.isOutput() == true ? "output" : "input"));
+	connection->m_interface = audio::river::Interface::create(connection->m_ring.getFrequency(),
+	                                                          connection->m_ring.getMap(),
+	                                                          connection->m_ring.getFormat(),
+	                                                          node,
+	                                                          tmpOption);
+	if (connection->m_interface == null) {
+		RIVER_ERROR("River client " << connection->m_pid << " can not create an interface on '" << nodeName << "'");
+		return false;
+	}
+	connection->m_interface->setName("shm-" + etk::toString(connection->m_pid) + "-" + etk::toString(_slot));
+	audio::river::io::ShmRing* ring = &connection->m_ring;
+	if (ring->isOutput() == true) {
+		connection->m_interface->setOutputCallback([=](void* _data,
+		                                               const audio::Time& _time,
+		                                               size_t _nbChunk,
+		                                               enum audio::format _format,
+		                                               uint32_t _frequency,
+		                                               const etk::Vector<audio::channel>& _map) {
+		                                               	// publish the time where the next frame of the client is played
+		                                               	ring->setTime(ring->getReadPosition(), _time);
+		                                               	ring->read(_data, _nbChunk);
+		                                               });
+	} else {
+		connection->m_interface->setInputCallback([=](const void* _data,
+		                                              const audio::Time& _time,
+		                                              size_t _nbChunk,
+		                                              enum audio::format _format,
+		                                              uint32_t _frequency,
+		                                              const etk::Vector<audio::channel>& _map) {
+		                                              	ring->setTime(ring->getWritePosition(), _time);
+		                                              	if (ring->write(_data, _nbChunk) != _nbChunk) {
+		                                              		RIVER_VERBOSE("River client ring full ==> drop data");
+		                                              	}
+		                                              });
+	}
+	connection->m_interface->start();
+	m_connections.pushBack(connection);
+	RIVER_INFO("River client " << connection->m_pid << " connected on '" << nodeName << "' (" << connection->m_ring.getFormat() << " " << connection->m_ring.getFrequency() << "Hz " << connection->m_ring.getMap() << ")");
+	return true;
+}
+
+void audio::river::io::ShmServer::closeConnection(uint32_t _slot) {
+	auto it = m_connections.begin();
+	while (it != m_connections.end()) {
+		if ((*it)->m_slot != _slot) {
+			++it;
+			continue;
+		}
+		RIVER_INFO("River client " << (*it)->m_pid << " disconnected");
+		// stop the callbacks before unmapping the ring
+		(*it)->m_interface->stop();
+		(*it)->m_interface.reset();
+		(*it)->m_ring.close();
+		it = m_connections.erase(it);
+	}
+}
+
+#endif
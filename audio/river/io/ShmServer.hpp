@@ -0,0 +1,105 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#ifdef AUDIO_RIVER_BUILD_SHM
+
+#include <etk/types.hpp>
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <ethread/Thread.hpp>
+#include <atomic>
+#include <ememory/memory.hpp>
+#include <audio/river/Interface.hpp>
+#include <audio/river/io/ShmRing.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Daemon side of the multi-process sharing: the process that own the hardware nodes publish a control segment
+			 * ("/river-NAME"), the clients (@ref NodeShm) register their rings in it and the server connect each ring on a local
+			 * interface of the requested node. The data path is only the ring (no socket, no copy except the one of the interface).
+			 */
+			class ShmServer {
+				private:
+					/**
+					 * @brief One client ring connected on a local node.
+					 */
+					class Connection {
+						public:
+							uint32_t m_slot; //!< Id of the slot in the control segment
+							int32_t m_pid; //!< Process of the client
+							audio::river::io::ShmRing m_ring; //!< Ring shared with the client
+							ememory::SharedPtr<audio::river::Interface> m_interface; //!< Interface on the local node
+					};
+					etk::String m_name; //!< Name of the server
+					void* m_memory; //!< Mapping of the control segment
+					etk::Vector<ememory::SharedPtr<Connection>> m_connections; //!< All the clients connected
+					ememory::SharedPtr<ethread::Thread> m_thread; //!< Thread that process the requests of the clients
+					std::atomic<bool> m_alive; //!< Thread is active
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					ShmServer();
+					/**
+					 * @brief Destructor (disconnect all the clients)
+					 */
+					~ShmServer();
+					/**
+					 * @brief Publish the control segment and start to accept the clients.
+					 * @param[in] _name Name of the server (used by the clients in "map-on:{server:...}").
+					 * @return true The server is started.
+					 */
+					bool init(const etk::String& _name);
+					/**
+					 * @brief Disconnect all the clients and remove the control segment.
+					 */
+					void unInit();
+					/**
+					 * @brief Get the name of the control segment of a server.
+					 * @param[in] _name Name of the server.
+					 * @return Name of the shared memory.
+					 */
+					static etk::String getSegmentName(const etk::String& _name);
+					/**
+					 * @brief Request the connection of a ring on a node of the server (client side, wait the answer of the server).
+					 * @param[in] _server Name of the server.
+					 * @param[in] _node Name of the node in the server.
+					 * @param[in] _ring Name of the ring segment (already created).
+					 * @param[out] _serverPid Process of the server.
+					 * @return Id of the connection (-1 if refused).
+					 */
+					static int32_t connect(const etk::String& _server, const etk::String& _node, const etk::String& _ring, int32_t& _serverPid);
+					/**
+					 * @brief Request the disconnection of a ring (client side, does not wait).
+					 * @param[in] _server Name of the server.
+					 * @param[in] _id Id of the connection.
+					 */
+					static void disconnect(const etk::String& _server, int32_t _id);
+				private:
+					/**
+					 * @brief Process the requests of the clients.
+					 */
+					void threadCallback();
+					/**
+					 * @brief Connect the ring of a slot on its node.
+					 * @param[in] _slot Id of the slot.
+					 * @return true The connection is done.
+					 */
+					bool openConnection(uint32_t _slot);
+					/**
+					 * @brief Disconnect the ring of a slot.
+					 * @param[in] _slot Id of the slot.
+					 */
+					void closeConnection(uint32_t _slot);
+			};
+		}
+	}
+}
+
+#endif
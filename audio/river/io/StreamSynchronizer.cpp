@@ -0,0 +1,302 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/StreamSynchronizer.hpp>
+#include <audio/river/debug.hpp>
+
+static audio::Duration frameDuration(uint32_t _nbFrame, uint32_t _frequency) {
+	int64_t delay = int64_t(_nbFrame)*1000000000LL/int64_t(_frequency);
+	return audio::Duration(delay/1000000000LL, delay%1000000000LL);
+}
+
+audio::river::io::StreamSynchronizer::StreamSynchronizer() :
+  m_frequency(48000),
+  m_nbChunk(256),
+  m_capacity(0),
+  m_latency(0),
+  m_driftCompensation(false),
+  m_acquired(false),
+  m_clearRequested(false) {
+	
+}
+
+void audio::river::io::StreamSynchronizer::init(uint32_t _frequency, uint32_t _nbChunk, bool _driftCompensation) {
+	ethread::UniqueLock lock(m_mutex);
+	m_frequency = _frequency;
+	m_nbChunk = _nbChunk;
+	m_capacity = 0;
+	m_driftCompensation = _driftCompensation;
+	m_sources.clear();
+	m_acquired = false;
+	m_clearRequested = false;
+}
+
+size_t audio::river::io::StreamSynchronizer::addSource(audio::format _format, uint32_t _nbChannel, const audio::Duration& _capacity) {
+	ethread::UniqueLock lock(m_mutex);
+	ememory::SharedPtr<Source> source = ememory::makeShared<Source>();
+	source->m_frameSize = audio::getFormatBytes(_format)*_nbChannel;
+	uint32_t capacity = uint32_t((_capacity.get()*int64_t(m_frequency))/1000000000LL);
+	capacity = etk::max(capacity, m_nbChunk*2);
+	if (    m_capacity == 0
+	     || capacity < m_capacity) {
+		m_capacity = capacity;
+	}
+	// the first chunk is mirrored after the end: a chunk is always contiguous
+	source->m_ring.resize((capacity + m_nbChunk)*source->m_frameSize, 0);
+	source->m_readPosition = 0;
+	source->m_size = 0;
+	source->m_compensate = false;
+	if (    m_driftCompensation == true
+	     && m_sources.size() != 0) {
+		source->m_compensate = source->m_drift.init(_format, _nbChannel, m_frequency, m_nbChunk);
+		source->m_output.resize(m_nbChunk*source->m_frameSize, 0);
+	}
+	m_sources.pushBack(source);
+	return m_sources.size()-1;
+}
+
+void audio::river::io::StreamSynchronizer::setLatency(uint32_t _latency) {
+	ethread::UniqueLock lock(m_mutex);
+	m_latency = _latency;
+}
+
+void audio::river::io::StreamSynchronizer::setOffset(size_t _id, const audio::Duration& _offset) {
+	ethread::UniqueLock lock(m_mutex);
+	if (_id >= m_sources.size()) {
+		return;
+	}
+	m_sources[_id]->m_offset = _offset;
+}
+
+void audio::river::io::StreamSynchronizer::write(size_t _id, const void* _data, size_t _nbChunk, const audio::Time& _time) {
+	ethread::UniqueLock lock(m_mutex);
+	if (_id >= m_sources.size()) {
+		return;
+	}
+	Source& source = *m_sources[_id];
+	const uint8_t* data = static_cast<const uint8_t*>(_data);
+	uint32_t nbFrame = _nbChunk;
+	if (source.m_size + nbFrame > m_capacity) {
+		if (    m_acquired == false
+		     && nbFrame <= m_capacity) {
+			RIVER_WARNING("Synchronizer: source " << _id << " overflow, drop " << source.m_size + nbFrame - m_capacity << " old frames");
+			drop(source, source.m_size + nbFrame - m_capacity);
+		} else {
+			// the frames of the chunk in use can not be removed
+			RIVER_WARNING("Synchronizer: source " << _id << " overflow, drop " << nbFrame - (m_capacity - source.m_size) << " new frames");
+			nbFrame = m_capacity - source.m_size;
+		}
+	}
+	uint32_t writePosition = (source.m_readPosition + source.m_size) % m_capacity;
+	uint32_t nbFrameEnd = etk::min(nbFrame, m_capacity - writePosition);
+	memcpy(&source.m_ring[writePosition*source.m_frameSize], data, nbFrameEnd*source.m_frameSize);
+	if (nbFrameEnd < nbFrame) {
+		memcpy(&source.m_ring[0], data + nbFrameEnd*source.m_frameSize, (nbFrame-nbFrameEnd)*source.m_frameSize);
+	}
+	// update the mirror of the start of the ring
+	uint32_t mirrorStart = m_nbChunk;
+	uint32_t mirrorStop = 0;
+	if (writePosition < m_nbChunk) {
+		mirrorStart = writePosition;
+		mirrorStop = etk::min(writePosition + nbFrameEnd, m_nbChunk);
+	}
+	if (nbFrameEnd < nbFrame) {
+		mirrorStart = 0;
+		mirrorStop = etk::max(mirrorStop, etk::min(nbFrame - nbFrameEnd, m_nbChunk));
+	}
+	if (mirrorStart < mirrorStop) {
+		memcpy(&source.m_ring[(m_capacity + mirrorStart)*source.m_frameSize],
+		       &source.m_ring[mirrorStart*source.m_frameSize],
+		       (mirrorStop - mirrorStart)*source.m_frameSize);
+	}
+	source.m_size += nbFrame;
+	// the time of the ring is the one of its last frame: the new frames dropped are not in it
+	source.m_writeTime = _time + frameDuration(nbFrame, m_frequency);
+}
+
+audio::Time audio::river::io::StreamSynchronizer::getReadTimeStamp(const Source& _source) const {
+	audio::Time time = _source.m_writeTime - frameDuration(_source.m_size, m_frequency);
+	if (_source.m_compensate == true) {
+		time = _source.m_drift.getReadTimeStamp(time);
+	}
+	return time + _source.m_offset;
+}
+
+uint32_t audio::river::io::StreamSynchronizer::getInputSize(const Source& _source) const {
+	if (_source.m_compensate == true) {
+		return _source.m_drift.getInputSize();
+	}
+	return m_nbChunk;
+}
+
+void audio::river::io::StreamSynchronizer::drop(Source& _source, uint32_t _nbFrame) {
+	_nbFrame = etk::min(_nbFrame, _source.m_size);
+	_source.m_readPosition = (_source.m_readPosition + _nbFrame) % m_capacity;
+	_source.m_size -= _nbFrame;
+}
+
+void audio::river::io::StreamSynchronizer::read(Source& _source, void* _output, uint32_t _nbFrame) {
+	uint8_t* output = static_cast<uint8_t*>(_output);
+	uint32_t nbFrameEnd = etk::min(_nbFrame, m_capacity - _source.m_readPosition);
+	memcpy(output, &_source.m_ring[_source.m_readPosition*_source.m_frameSize], nbFrameEnd*_source.m_frameSize);
+	if (nbFrameEnd < _nbFrame) {
+		memcpy(output + nbFrameEnd*_source.m_frameSize, &_source.m_ring[0], (_nbFrame-nbFrameEnd)*_source.m_frameSize);
+	}
+	drop(_source, _nbFrame);
+}
+
+bool audio::river::io::StreamSynchronizer::acquire(audio::Time& _time) {
+	audio::Time nextTime;
+	{
+		ethread::UniqueLock lock(m_mutex);
+		if (acquireLocked(nextTime) == false) {
+			return false;
+		}
+		_time = m_time;
+	}
+	// The drift compensation (resampling) is done without the lock: the callbacks of the sources are not blocked.
+	// The compensators are only used by the consumer and the rings are not accessed.
+	for (size_t iii=1; iii<m_sources.size(); ++iii) {
+		Source& source = *m_sources[iii];
+		if (source.m_compensate == false) {
+			continue;
+		}
+		source.m_drift.resample(&source.m_output[0]);
+		audio::Time time = source.m_drift.getReadTimeStamp(source.m_readTime);
+		double error = 0.0;
+		if (time < nextTime) {
+			error = -double((nextTime - time).get());
+		} else {
+			error = double((time - nextTime).get());
+		}
+		source.m_drift.update(error*double(m_frequency)/1000000000.0);
+	}
+	return true;
+}
+
+bool audio::river::io::StreamSynchronizer::acquireLocked(audio::Time& _nextTime) {
+	if (m_acquired == true) {
+		RIVER_ERROR("Synchronizer: the previous chunk is not released");
+		return false;
+	}
+	if (m_sources.size() == 0) {
+		return false;
+	}
+	if (m_clearRequested == true) {
+		// no chunk is in use: the rings and the compensators can be reset
+		reset();
+		m_clearRequested = false;
+	}
+	// the latency keep some data in the rings to absorb the scheduling of the consumer
+	for (auto &it : m_sources) {
+		if (it->m_size <= getInputSize(*it) + m_latency) {
+			return false;
+		}
+	}
+	// small offset are corrected by the drift compensation without discontinuity
+	audio::Duration maxDelta = frameDuration(1, m_frequency);
+	if (    m_sources.size() > 1
+	     && m_sources[1]->m_compensate == true) {
+		maxDelta = m_sources[1]->m_drift.getMaximumOffset();
+	}
+	// the most recent flow is the reference: the other drop their older frames
+	audio::Time reference = getReadTimeStamp(*m_sources[0]);
+	for (size_t iii=1; iii<m_sources.size(); ++iii) {
+		audio::Time time = getReadTimeStamp(*m_sources[iii]);
+		if (time > reference) {
+			reference = time;
+		}
+	}
+	bool synchronize = false;
+	for (size_t iii=0; iii<m_sources.size(); ++iii) {
+		Source& source = *m_sources[iii];
+		audio::Time time = getReadTimeStamp(source);
+		RIVER_VERBOSE("check delta " << reference - time << " > " << maxDelta);
+		if (reference - time > maxDelta) {
+			uint32_t nbFrame = uint32_t(((reference - time).get()*int64_t(m_frequency))/1000000000LL);
+			RIVER_INFO("Synchronizer: source " << iii << " time=" << time << " ==> " << reference << " drop " << nbFrame << " frames");
+			drop(source, nbFrame);
+			if (source.m_compensate == true) {
+				source.m_drift.reset();
+			}
+			synchronize = true;
+		}
+	}
+	if (synchronize == true) {
+		// check if enought time after synchronisation ...
+		for (size_t iii=0; iii<m_sources.size(); ++iii) {
+			Source& source = *m_sources[iii];
+			if (source.m_size <= getInputSize(source)) {
+				return false;
+			}
+			audio::Time time = getReadTimeStamp(source);
+			if (reference - time > maxDelta) {
+				RIVER_ERROR("Can not synchronize flow ... : " << time << " != " << reference << "  delta = " << (reference - time));
+				return false;
+			}
+		}
+	}
+	Source& reference0 = *m_sources[0];
+	audio::Time referenceTime = getReadTimeStamp(reference0);
+	m_time = referenceTime - reference0.m_offset;
+	// time of the next chunk of the reference (the drift compensation align the sources on it)
+	_nextTime = referenceTime + frameDuration(m_nbChunk, m_frequency);
+	for (size_t iii=1; iii<m_sources.size(); ++iii) {
+		Source& source = *m_sources[iii];
+		if (source.m_compensate == false) {
+			continue;
+		}
+		// only the copy of the frames is done with the lock
+		uint32_t nbFrame = source.m_drift.getInputSize();
+		if (nbFrame != 0) {
+			read(source, source.m_drift.getInputBuffer(), nbFrame);
+			source.m_drift.addInput(nbFrame);
+		}
+		source.m_readTime = source.m_writeTime - frameDuration(source.m_size, m_frequency) + source.m_offset;
+	}
+	m_acquired = true;
+	return true;
+}
+
+void* audio::river::io::StreamSynchronizer::getData(size_t _id) {
+	if (_id >= m_sources.size()) {
+		return null;
+	}
+	Source& source = *m_sources[_id];
+	if (source.m_compensate == true) {
+		return &source.m_output[0];
+	}
+	return &source.m_ring[source.m_readPosition*source.m_frameSize];
+}
+
+void audio::river::io::StreamSynchronizer::release() {
+	ethread::UniqueLock lock(m_mutex);
+	if (m_acquired == false) {
+		return;
+	}
+	for (auto &it : m_sources) {
+		if (it->m_compensate == false) {
+			drop(*it, m_nbChunk);
+		}
+	}
+	m_acquired = false;
+}
+
+void audio::river::io::StreamSynchronizer::clear() {
+	ethread::UniqueLock lock(m_mutex);
+	// the chunk in use (and the compensators used without the lock) must not be modified: the consumer apply the reset
+	m_clearRequested = true;
+}
+
+void audio::river::io::StreamSynchronizer::reset() {
+	for (auto &it : m_sources) {
+		it->m_readPosition = 0;
+		it->m_size = 0;
+		if (it->m_compensate == true) {
+			it->m_drift.reset();
+		}
+	}
+}
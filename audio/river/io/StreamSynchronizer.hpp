@@ -0,0 +1,178 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/types.hpp>
+#include <etk/Vector.hpp>
+#include <ethread/Mutex.hpp>
+#include <ememory/memory.hpp>
+#include <audio/format.hpp>
+#include <audio/Time.hpp>
+#include <audio/river/io/DriftCompensator.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Synchronization of N timestamped flows: the sources write blocks of any size, the consumer get groups of chunk aligned on the same time.
+			 * The first source is the reference, the other are aligned on it (jump of the read position, or resampling with the drift compensation).
+			 * The data of a chunk is availlable without copy in the rings (the end of each ring is mirrored at its start).
+			 * @code
+			 * // in the callback of the source N:
+			 * synchronizer.write(N, data, nbChunk, time);
+			 * // in the process:
+			 * audio::Time time;
+			 * while (synchronizer.acquire(time) == true) {
+			 * 	process(synchronizer.getData(0), synchronizer.getData(1), time);
+			 * 	synchronizer.release();
+			 * }
+			 * @endcode
+			 * @note The rings are allocated when the sources are added: write(), acquire() and release() do not allocate.
+			 * @note The resampling of the drift compensation is done in acquire() without the lock: write() is never blocked by it.
+			 * @note clear() can be called from any thread (xrun of a source): the reset is applied by the consumer at its next acquire(), never on the chunk in use.
+			 */
+			class StreamSynchronizer {
+				private:
+					/**
+					 * @brief One flow to synchronize.
+					 */
+					class Source {
+						public:
+							uint32_t m_frameSize; //!< Size of a frame in byte
+							etk::Vector<uint8_t> m_ring; //!< Ring of frames (capacity + mirror of the first chunk)
+							uint32_t m_readPosition; //!< Position of the first frame to read
+							uint32_t m_size; //!< Number of frame in the ring
+							audio::Time m_writeTime; //!< Time of the next frame to write
+							audio::Duration m_offset; //!< Offset added to the time of the flow (delay of the source)
+							bool m_compensate; //!< The flow is resampled on the clock of the reference
+							audio::river::io::DriftCompensator m_drift; //!< Compensation of the drift against the reference
+							etk::Vector<uint8_t> m_output; //!< Chunk resampled (drift compensation only)
+							audio::Time m_readTime; //!< Time of the first frame of the ring (offset included) when the chunk has been acquired (drift compensation only)
+					};
+					mutable ethread::Mutex m_mutex; //!< Protect the rings (write in the callbacks, read in the process)
+					uint32_t m_frequency; //!< Frequency of all the flows
+					uint32_t m_nbChunk; //!< Number of frame of a chunk
+					uint32_t m_capacity; //!< Capacity of the rings (frame)
+					uint32_t m_latency; //!< Number of frame kept in the rings after a chunk
+					bool m_driftCompensation; //!< The sources (except the reference) are resampled
+					etk::Vector<ememory::SharedPtr<Source>> m_sources; //!< All the flows
+					bool m_acquired; //!< A chunk is in use (between acquire() and release())
+					bool m_clearRequested; //!< A clear() is pending: applied by the consumer at the next acquire()
+					audio::Time m_time; //!< Time of the chunk acquired
+				public:
+					/**
+					 * @brief Contructor
+					 */
+					StreamSynchronizer();
+					/**
+					 * @brief Initialize the synchronizer (remove all the sources).
+					 * @param[in] _frequency Frequency of all the flows.
+					 * @param[in] _nbChunk Number of frame of a chunk.
+					 * @param[in] _driftCompensation Resample the sources on the clock of the first one instead of jumping in the flows.
+					 */
+					void init(uint32_t _frequency, uint32_t _nbChunk, bool _driftCompensation);
+					/**
+					 * @brief Add a source to synchronize.
+					 * @param[in] _format Format of the samples.
+					 * @param[in] _nbChannel Number of channel of the source.
+					 * @param[in] _capacity Duration stored in the ring.
+					 * @return Id of the source (the first one is the reference).
+					 */
+					size_t addSource(audio::format _format, uint32_t _nbChannel, const audio::Duration& _capacity);
+					/**
+					 * @brief Get the number of source.
+					 * @return Number of source.
+					 */
+					size_t getNbSource() const {
+						return m_sources.size();
+					}
+					/**
+					 * @brief Get the number of frame of a chunk.
+					 * @return Number of frame.
+					 */
+					uint32_t getChunkSize() const {
+						return m_nbChunk;
+					}
+					/**
+					 * @brief Set the number of frame kept in the rings (latency to absorb the scheduling of the consumer).
+					 * @param[in] _latency Number of frame.
+					 */
+					void setLatency(uint32_t _latency);
+					/**
+					 * @brief Set the offset of a source: the frame written at the time T is aligned with the frames of the reference at T+offset.
+					 * @param[in] _id Id of the source.
+					 * @param[in] _offset Offset of the source.
+					 */
+					void setOffset(size_t _id, const audio::Duration& _offset);
+					/**
+					 * @brief Write a block of a source (called in the callback of the source).
+					 * @param[in] _id Id of the source.
+					 * @param[in] _data Interleaved frames.
+					 * @param[in] _nbChunk Number of frame.
+					 * @param[in] _time Time of the first frame.
+					 */
+					void write(size_t _id, const void* _data, size_t _nbChunk, const audio::Time& _time);
+					/**
+					 * @brief Align all the sources and get the next chunk.
+					 * @param[out] _time Time of the first frame of the reference.
+					 * @return true A chunk is availlable with getData() until release().
+					 */
+					bool acquire(audio::Time& _time);
+					/**
+					 * @brief Get the chunk of a source (after acquire()).
+					 * @param[in] _id Id of the source.
+					 * @return Pointer on the interleaved frames (can be modified in place).
+					 */
+					void* getData(size_t _id);
+					/**
+					 * @brief Remove the chunk acquired from the rings.
+					 */
+					void release();
+					/**
+					 * @brief Request to remove all the frames of the rings. The reset is applied at the next acquire() (the chunk in use stays valid until release()).
+					 */
+					void clear();
+				private:
+					/**
+					 * @brief Get the time of the next frame of a source (offset and drift compensation taken into account).
+					 * @param[in] _source Source.
+					 * @return Time of the next frame.
+					 */
+					audio::Time getReadTimeStamp(const Source& _source) const;
+					/**
+					 * @brief Get the number of frame of the ring needed to generate the next chunk.
+					 * @param[in] _source Source.
+					 * @return Number of frame.
+					 */
+					uint32_t getInputSize(const Source& _source) const;
+					/**
+					 * @brief Remove frames of a ring.
+					 * @param[in] _source Source.
+					 * @param[in] _nbFrame Number of frame.
+					 */
+					void drop(Source& _source, uint32_t _nbFrame);
+					/**
+					 * @brief Copy frames of a ring.
+					 * @param[in] _source Source.
+					 * @param[out] _output Output buffer.
+					 * @param[in] _nbFrame Number of frame (removed of the ring).
+					 */
+					void read(Source& _source, void* _output, uint32_t _nbFrame);
+					/**
+					 * @brief Align all the sources and get the next chunk (m_mutex locked). The frames needed by the drift compensation are copied from the rings.
+					 * @param[out] _nextTime Time of the next chunk of the reference.
+					 * @return true A chunk is availlable.
+					 */
+					bool acquireLocked(audio::Time& _nextTime);
+					/**
+					 * @brief Remove all the frames of the rings and reset the drift compensation (m_mutex locked, no chunk in use).
+					 */
+					void reset();
+			};
+		}
+	}
+}
+
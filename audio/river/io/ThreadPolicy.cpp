@@ -0,0 +1,186 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <audio/river/io/ThreadPolicy.hpp>
+#include <audio/river/debug.hpp>
+#include <atomic>
+
+#if defined(__TARGET_OS__Linux)
+	extern "C" {
+		#include <pthread.h>
+		#include <sched.h>
+		#include <errno.h>
+		#include <string.h>
+		#include <unistd.h>
+		#include <sys/mman.h>
+		#include <sys/syscall.h>
+	}
+	#ifndef SCHED_DEADLINE
+		#define SCHED_DEADLINE 6
+	#endif
+	/**
+	 * @brief Linux scheduling attribute (not availlable in all libc)
+	 */
+	struct riverSchedAttr {
+		uint32_t size;
+		uint32_t schedPolicy;
+		uint64_t schedFlags;
+		int32_t schedNice;
+		uint32_t schedPriority;
+		uint64_t schedRuntime;
+		uint64_t schedDeadline;
+		uint64_t schedPeriod;
+	};
+#endif
+
+audio::river::io::ThreadPolicy::ThreadPolicy() :
+  m_policy(audio::river::io::ThreadPolicy::policy_none),
+  m_priority(0),
+  m_runtime(0),
+  m_period(0),
+  m_memoryLock(false) {
+
+}
+
+void audio::river::io::ThreadPolicy::configure(const ejson::Object& _config, uint64_t _periodNs) {
+	const ejson::Object tmpObject = _config["thread"].toObject();
+	if (tmpObject.exist() == false) {
+		return;
+	}
+	etk::String policy = tmpObject["policy"].toString().get("none");
+	if (policy == "other") {
+		m_policy = audio::river::io::ThreadPolicy::policy_other;
+	} else if (policy == "fifo") {
+		m_policy = audio::river::io::ThreadPolicy::policy_fifo;
+	} else if (policy == "rr") {
+		m_policy = audio::river::io::ThreadPolicy::policy_roundRobin;
+	} else if (policy == "deadline") {
+		m_policy = audio::river::io::ThreadPolicy::policy_deadline;
+	} else if (policy == "none") {
+		m_policy = audio::river::io::ThreadPolicy::policy_none;
+	} else {
+		RIVER_ERROR("Unknow thread policy: '" << policy << "' availlable: [other,fifo,rr,deadline]");
+		m_policy = audio::river::io::ThreadPolicy::policy_none;
+	}
+	m_priority = etk::avg(1, int32_t(tmpObject["priority"].toNumber().get(50)), 99);
+	m_period = uint64_t(tmpObject["period-us"].toNumber().get(0))*1000;
+	if (m_period == 0) {
+		m_period = _periodNs;
+	}
+	m_runtime = uint64_t(tmpObject["runtime-us"].toNumber().get(0))*1000;
+	if (m_runtime == 0) {
+		// reserve the half of the period by default
+		m_runtime = m_period/2;
+	}
+	m_cpu.clear();
+	for (auto it : tmpObject["cpu"].toArray()) {
+		m_cpu.pushBack(it.toNumber().get(0));
+	}
+	m_memoryLock = tmpObject["mlock"].toBoolean().get(false);
+	if (m_memoryLock == true) {
+		lockMemory();
+	}
+}
+
+void audio::river::io::ThreadPolicy::lockMemory() {
+	#if defined(__TARGET_OS__Linux)
+		// one time for the process, at the creation of the node (mlockall can take a long time: never in the audio callback)
+		static std::atomic<bool> memoryLocked(false);
+		if (memoryLocked.exchange(true) == true) {
+			return;
+		}
+		if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+			RIVER_WARNING("Can not lock the memory: " << strerror(errno) << " (check RLIMIT_MEMLOCK)");
+		}
+	#else
+		RIVER_WARNING("Memory lock is not availlable on this platform");
+	#endif
+}
+
+bool audio::river::io::ThreadPolicy::isRequested() const {
+	return    m_policy != audio::river::io::ThreadPolicy::policy_none
+	       || m_cpu.size() != 0;
+}
+
+void audio::river::io::ThreadPolicy::apply(const etk::String& _name) const {
+	#if defined(__TARGET_OS__Linux)
+		// the scheduling is set before the affinity: SCHED_DEADLINE is refused (EPERM) on a thread with a restricted affinity
+		bool deadline = false;
+		switch (m_policy) {
+			case audio::river::io::ThreadPolicy::policy_none:
+				break;
+			case audio::river::io::ThreadPolicy::policy_deadline:
+				#ifdef SYS_sched_setattr
+				{
+					struct riverSchedAttr attr;
+					memset(&attr, 0, sizeof(attr));
+					attr.size = sizeof(attr);
+					attr.schedPolicy = SCHED_DEADLINE;
+					attr.schedRuntime = m_runtime;
+					attr.schedDeadline = m_period;
+					attr.schedPeriod = m_period;
+					if (syscall(SYS_sched_setattr, 0, &attr, 0) == 0) {
+						RIVER_INFO("[" << _name << "] thread in SCHED_DEADLINE runtime=" << m_runtime << "ns period=" << m_period << "ns");
+						deadline = true;
+						break;
+					}
+					RIVER_WARNING("[" << _name << "] Can not set SCHED_DEADLINE: " << strerror(errno) << " ==> fallback on SCHED_FIFO");
+				}
+				#else
+					RIVER_WARNING("[" << _name << "] SCHED_DEADLINE is not availlable (no sched_setattr syscall) ==> fallback on SCHED_FIFO");
+				#endif
+				// fallback on FIFO ...
+				[[fallthrough]];
+			case audio::river::io::ThreadPolicy::policy_fifo:
+			case audio::river::io::ThreadPolicy::policy_roundRobin:
+				{
+					struct sched_param param;
+					memset(&param, 0, sizeof(param));
+					param.sched_priority = m_priority;
+					int policy = SCHED_FIFO;
+					if (m_policy == audio::river::io::ThreadPolicy::policy_roundRobin) {
+						policy = SCHED_RR;
+					}
+					int ret = pthread_setschedparam(pthread_self(), policy, &param);
+					if (ret != 0) {
+						RIVER_WARNING("[" << _name << "] Can not set real-time scheduling (priority=" << m_priority << "): " << strerror(ret) << " ==> keep the current scheduling (check RLIMIT_RTPRIO or CAP_SYS_NICE)");
+					} else {
+						RIVER_INFO("[" << _name << "] thread in " << (policy==SCHED_FIFO?"SCHED_FIFO":"SCHED_RR") << " priority=" << m_priority);
+					}
+				}
+				break;
+			case audio::river::io::ThreadPolicy::policy_other:
+				{
+					struct sched_param param;
+					memset(&param, 0, sizeof(param));
+					int ret = pthread_setschedparam(pthread_self(), SCHED_OTHER, &param);
+					if (ret != 0) {
+						RIVER_WARNING("[" << _name << "] Can not set SCHED_OTHER: " << strerror(ret));
+					}
+				}
+				break;
+		}
+		if (m_cpu.size() != 0) {
+			if (deadline == true) {
+				RIVER_WARNING("[" << _name << "] CPU affinity " << m_cpu << " ignored: not compatible with SCHED_DEADLINE");
+			} else {
+				cpu_set_t cpuSet;
+				CPU_ZERO(&cpuSet);
+				for (auto &it : m_cpu) {
+					CPU_SET(it, &cpuSet);
+				}
+				int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuSet);
+				if (ret != 0) {
+					RIVER_WARNING("[" << _name << "] Can not set CPU affinity " << m_cpu << ": " << strerror(ret));
+				}
+			}
+		}
+	#else
+		if (isRequested() == true) {
+			RIVER_WARNING("[" << _name << "] thread scheduling configuration is not availlable on this platform");
+		}
+	#endif
+}
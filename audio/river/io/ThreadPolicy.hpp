@@ -0,0 +1,76 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#pragma once
+
+#include <etk/String.hpp>
+#include <etk/Vector.hpp>
+#include <ejson/ejson.hpp>
+
+namespace audio {
+	namespace river {
+		namespace io {
+			/**
+			 * @brief Scheduling configuration of the thread that call the node (callback of the hardware).
+			 * Configured in the node with:
+			 * @code
+			 * thread:{
+			 * 	policy:"fifo", # "other", "fifo", "rr" or "deadline"
+			 * 	priority:80, # priority for "fifo" and "rr" [1..99]
+			 * 	runtime-us:2000, # for "deadline": execution time reserved in each period
+			 * 	period-us:21333, # for "deadline": period of the callback (default: nb-chunk / frequency)
+			 * 	cpu:[2, 3], # list of CPU where the thread can run (ignored with "deadline")
+			 * 	mlock:true, # lock all the memory of the process in RAM (no page fault in the callback), done at the creation of the node
+			 * },
+			 * @endcode
+			 */
+			class ThreadPolicy {
+				public:
+					enum policy {
+						policy_none, //!< do not change the current scheduling
+						policy_other, //!< standard sheduling
+						policy_fifo, //!< real-time FIFO
+						policy_roundRobin, //!< real-time round robin
+						policy_deadline, //!< Earliest deadline first (linux only)
+					};
+				private:
+					enum policy m_policy; //!< Requested policy
+					int32_t m_priority; //!< Requested priority (fifo/rr)
+					uint64_t m_runtime; //!< Deadline runtime in ns
+					uint64_t m_period; //!< Deadline period in ns
+					etk::Vector<int32_t> m_cpu; //!< CPU affinity
+					bool m_memoryLock; //!< Lock the memory of the process
+				public:
+					/**
+					 * @brief Contructor (no change of the scheduling)
+					 */
+					ThreadPolicy();
+					/**
+					 * @brief Configure the policy with the "thread" object of the node.
+					 * @param[in] _config Configuration of the node.
+					 * @param[in] _periodNs Default period of the node (used by the deadline policy).
+					 */
+					void configure(const ejson::Object& _config, uint64_t _periodNs);
+					/**
+					 * @brief Check if something need to be done.
+					 * @return true A policy is requested.
+					 */
+					bool isRequested() const;
+					/**
+					 * @brief Apply the policy on the current thread.
+					 * @note if the process has not the right to change the scheduling, a warning is displayed and the thread stay in his current policy.
+					 * @param[in] _name Name of the node (for debug).
+					 */
+					void apply(const etk::String& _name) const;
+				private:
+					/**
+					 * @brief Lock all the memory of the process (only one time for the process).
+					 */
+					static void lockMemory();
+			};
+		}
+	}
+}
+
@@ -7,9 +7,13 @@
 #include <audio/river/river.hpp>
 #include <audio/river/debug.hpp>
 #include <audio/river/io/Manager.hpp>
+#include <audio/river/io/ShmServer.hpp>
 
 static bool river_isInit = false;
 static etk::String river_configFile = "";
+#ifdef AUDIO_RIVER_BUILD_SHM
+	static ememory::SharedPtr<audio::river::io::ShmServer> river_server;
+#endif
 
 
 
@@ -41,7 +45,104 @@ void audio::river::initString(const etk::String& _config) {
 	}
 }
 
+bool audio::river::reload(const etk::String& _filename) {
+	if (river_isInit == false) {
+		RIVER_ERROR("River is not init ==> can not reload : " << _filename);
+		return false;
+	}
+	RIVER_DEBUG("reload RIVER :" << _filename);
+	ememory::SharedPtr<audio::river::io::Manager> mng = audio::river::io::Manager::getInstance();
+	if (mng == null) {
+		return false;
+	}
+	if (mng->reload(_filename) == false) {
+		return false;
+	}
+	river_configFile = _filename;
+	return true;
+}
+
+bool audio::river::reloadString(const etk::String& _config) {
+	if (river_isInit == false) {
+		RIVER_ERROR("River is not init ==> can not reload Data ...");
+		return false;
+	}
+	RIVER_DEBUG("reload RIVER with config.");
+	ememory::SharedPtr<audio::river::io::Manager> mng = audio::river::io::Manager::getInstance();
+	if (mng == null) {
+		return false;
+	}
+	if (mng->reloadString(_config) == false) {
+		return false;
+	}
+	river_configFile = _config;
+	return true;
+}
+
+bool audio::river::setOfflineMode(bool _offline) {
+	ememory::SharedPtr<audio::river::io::Manager> mng = audio::river::io::Manager::getInstance();
+	if (mng == null) {
+		return false;
+	}
+	return mng->setOfflineMode(_offline);
+}
+
+bool audio::river::renderOffline(const audio::Duration& _duration) {
+	if (river_isInit == false) {
+		RIVER_ERROR("River is not init ==> can not render");
+		return false;
+	}
+	ememory::SharedPtr<audio::river::io::Manager> mng = audio::river::io::Manager::getInstance();
+	if (mng == null) {
+		return false;
+	}
+	return mng->renderOffline(_duration);
+}
+
+bool audio::river::getXrun(const etk::String& _nodeName, uint32_t& _underflow, uint32_t& _overflow) {
+	_underflow = 0;
+	_overflow = 0;
+	if (river_isInit == false) {
+		RIVER_ERROR("River is not init ==> can not get the xrun of : " << _nodeName);
+		return false;
+	}
+	ememory::SharedPtr<audio::river::io::Manager> mng = audio::river::io::Manager::getInstance();
+	if (mng == null) {
+		return false;
+	}
+	return mng->getXrun(_nodeName, _underflow, _overflow);
+}
+
+bool audio::river::startServer(const etk::String& _name) {
+	if (river_isInit == false) {
+		RIVER_ERROR("River is not init ==> can not start the server");
+		return false;
+	}
+	#ifdef AUDIO_RIVER_BUILD_SHM
+		stopServer();
+		river_server = ememory::makeShared<audio::river::io::ShmServer>();
+		if (river_server->init(_name) == false) {
+			river_server.reset();
+			return false;
+		}
+		return true;
+	#else
+		RIVER_ERROR("The server mode is not availlable on this platform");
+		return false;
+	#endif
+}
+
+void audio::river::stopServer() {
+	#ifdef AUDIO_RIVER_BUILD_SHM
+		if (river_server != null) {
+			river_server->unInit();
+			river_server.reset();
+		}
+	#endif
+}
+
 void audio::river::unInit() {
+	stopServer();
 	if (river_isInit == true) {
 		river_isInit = false;
 		RIVER_DEBUG("un-init RIVER.");
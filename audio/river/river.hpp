@@ -7,6 +7,7 @@
 
 #include <etk/types.hpp>
 #include <etk/String.hpp>
+#include <audio/Time.hpp>
 /**
  * @brief Audio library namespace
  */
@@ -25,6 +26,53 @@ namespace audio {
 		 * @param[in] _config json sting data
 		 */
 		void initString(const etk::String& _config);
+		/**
+		 * @brief Reload the configuration of the River Library without stopping the running streams
+		 * @note Only the nodes that change are re-created (the streams connected on them have a small glitch).
+		 * @param[in] _filename Name of the configuration file
+		 * @return true The new configuration is applied
+		 * @return false An error occured (the previous configuration is kept)
+		 */
+		bool reload(const etk::String& _filename);
+		/**
+		 * @brief Reload the configuration of the River Library with a json data string without stopping the running streams
+		 * @param[in] _config json sting data
+		 * @return true The new configuration is applied
+		 * @return false An error occured (the previous configuration is kept)
+		 */
+		bool reloadString(const etk::String& _config);
+		/**
+		 * @brief Select the offline rendering mode: no hardware, the flows are rendered as fast as possible with renderOffline()
+		 * @note Must be called before opening the first stream.
+		 * @param[in] _offline true to enable the offline mode
+		 * @return true The mode is changed
+		 */
+		bool setOfflineMode(bool _offline);
+		/**
+		 * @brief Render a duration of all the started streams (offline mode only)
+		 * @param[in] _duration Duration to render
+		 * @return true The duration has been rendered
+		 */
+		bool renderOffline(const audio::Duration& _duration);
+		/**
+		 * @brief Get the number of xrun (underflow and overflow reported by the backend) of a node
+		 * @param[in] _nodeName Name of the node in the configuration
+		 * @param[out] _underflow Number of underflow
+		 * @param[out] _overflow Number of overflow
+		 * @return true The node is open
+		 */
+		bool getXrun(const etk::String& _nodeName, uint32_t& _underflow, uint32_t& _overflow);
+		/**
+		 * @brief Start the daemon mode: the other processes can use the nodes of this process with the "shm-output"/"shm-input" nodes
+		 * @note Availlable on Linux only (POSIX shared memory).
+		 * @param[in] _name Name of the server (used by the clients in "map-on:{server:...}")
+		 * @return true The server is started
+		 */
+		bool startServer(const etk::String& _name = "river");
+		/**
+		 * @brief Stop the daemon mode (disconnect all the clients)
+		 */
+		void stopServer();
 		/**
 		 * @brief Un-initialize the River Library
 		 * @note this close all stream of all interfaces.
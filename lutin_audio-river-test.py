@@ -28,15 +28,41 @@ def configure(target, my_module):
 	my_module.add_src_file([
 	    'test/main.cpp',
 	    'test/testAEC.cpp',
+	    'test/testDelayEstimator.cpp',
+	    'test/testDriftCompensator.cpp',
+	    'test/testEchoCanceller.cpp',
 	    'test/testEchoDelay.cpp',
 	    'test/testFormat.cpp',
 	    'test/testMuxer.cpp',
+	    'test/testPeriodAdapter.cpp',
 	    'test/testPlaybackCallback.cpp',
 	    'test/testPlaybackWrite.cpp',
 	    'test/testRecordCallback.cpp',
 	    'test/testRecordRead.cpp',
+	    'test/testStreamSynchronizer.cpp',
 	    'test/testVolume.cpp',
 	    ])
+	if    "Linux" in target.get_type() \
+	   or "MacOs" in target.get_type() \
+	   or "Android" in target.get_type():
+		# clocked nodes (virtual, file, offline rendering)
+		my_module.add_src_file([
+		    'test/testClock.cpp',
+		    'test/testFile.cpp',
+		    'test/testReload.cpp',
+		    'test/testRouting.cpp',
+		    ])
+	if "Linux" in target.get_type():
+		# shared memory rings and server (fork a producer process)
+		my_module.add_src_file([
+		    'test/testShm.cpp',
+		    ])
+		my_module.add_flag('c++', [
+		    "-DAUDIO_RIVER_BUILD_SHM"
+		    ])
+		my_module.add_flag('link', [
+		    "-lrt"
+		    ])
 	my_module.add_depend([
 	    'audio-river',
 	    'etest',
@@ -31,11 +31,22 @@ def configure(target, my_module):
 	    'audio/river/Manager.cpp',
 	    'audio/river/Interface.cpp',
 	    'audio/river/io/Group.cpp',
+	    'audio/river/io/DeviceCache.cpp',
+	    'audio/river/io/ThreadPolicy.cpp',
+	    'audio/river/io/PeriodAdapter.cpp',
 	    'audio/river/io/Node.cpp',
 	    'audio/river/io/NodeOrchestra.cpp',
 	    'audio/river/io/NodePortAudio.cpp',
 	    'audio/river/io/NodeAEC.cpp',
+	    'audio/river/io/Fft.cpp',
+	    'audio/river/io/EchoCanceller.cpp',
+	    'audio/river/io/DelayEstimator.cpp',
+	    'audio/river/io/NodeWorker.cpp',
+	    'audio/river/io/DriftCompensator.cpp',
+	    'audio/river/io/StreamSynchronizer.cpp',
 	    'audio/river/io/NodeMuxer.cpp',
+	    'audio/river/io/NodeMixer.cpp',
+	    'audio/river/io/NodeSlice.cpp',
 	    'audio/river/io/Manager.cpp'
 	    ])
 	my_module.add_header_file([
@@ -43,11 +54,53 @@ def configure(target, my_module):
 	    'audio/river/Manager.hpp',
 	    'audio/river/Interface.hpp',
 	    'audio/river/io/Group.hpp',
+	    'audio/river/io/DeviceCache.hpp',
+	    'audio/river/io/ThreadPolicy.hpp',
+	    'audio/river/io/PeriodAdapter.hpp',
+	    'audio/river/io/Fft.hpp',
+	    'audio/river/io/EchoCanceller.hpp',
+	    'audio/river/io/DelayEstimator.hpp',
+	    'audio/river/io/DriftCompensator.hpp',
+	    'audio/river/io/StreamSynchronizer.hpp',
 	    'audio/river/io/Node.hpp',
 	    'audio/river/io/Manager.hpp'
 	    ])
 	my_module.add_optionnal_depend('audio-orchestra', ["c++", "-DAUDIO_RIVER_BUILD_ORCHESTRA"])
 	my_module.add_optionnal_depend('portaudio', ["c++", "-DAUDIO_RIVER_BUILD_PORTAUDIO"])
+	if    "Linux" in target.get_type() \
+	   or "MacOs" in target.get_type() \
+	   or "Android" in target.get_type():
+		# clocked nodes use POSIX timer and memory map
+		my_module.add_src_file([
+		    'audio/river/io/NodeClock.cpp',
+		    'audio/river/io/NodeFile.cpp',
+		    'audio/river/io/NodeVirtual.cpp'
+		    ])
+		my_module.add_header_file([
+		    'audio/river/io/NodeClock.hpp',
+		    'audio/river/io/NodeVirtual.hpp'
+		    ])
+		my_module.add_flag('c++', [
+		    "-DAUDIO_RIVER_BUILD_FILE",
+		    "-DAUDIO_RIVER_BUILD_VIRTUAL"
+		    ])
+	if "Linux" in target.get_type():
+		# multi-process sharing use POSIX shared memory and futex
+		my_module.add_src_file([
+		    'audio/river/io/ShmRing.cpp',
+		    'audio/river/io/ShmServer.cpp',
+		    'audio/river/io/NodeShm.cpp'
+		    ])
+		my_module.add_header_file([
+		    'audio/river/io/ShmRing.hpp',
+		    'audio/river/io/ShmServer.hpp'
+		    ])
+		my_module.add_flag('c++', [
+		    "-DAUDIO_RIVER_BUILD_SHM"
+		    ])
+		my_module.add_flag('link', [
+		    "-lrt"
+		    ])
 	my_module.add_depend([
 	    'audio',
 	    'audio-drain',
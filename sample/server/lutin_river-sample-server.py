@@ -0,0 +1,45 @@
+#!/usr/bin/python
+import realog.debug as debug
+import lutin.tools as tools
+
+
+def get_type():
+	return "BINARY"
+
+def get_sub_type():
+	return "SAMPLE"
+
+def get_desc():
+	return "River server: share the nodes of this process with the other processes"
+
+def get_licence():
+	return "MPL-2"
+
+def get_compagny_type():
+	return "com"
+
+def get_compagny_name():
+	return "atria-soft"
+
+def get_maintainer():
+	return ["Mr DUPIN Edouard <yui.heero@gmail.com>"]
+
+def configure(target, my_module):
+	my_module.add_src_file([
+	    'server.cpp',
+	    ])
+	my_module.add_depend([
+	    'audio-river',
+	    'test-debug',
+	    'etk'
+	    ])
+	return True
+
+
+
+
+
+
+
+
+
@@ -0,0 +1,59 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+//! [audio_river_sample_server_all]
+
+#include <audio/river/river.hpp>
+#include <etk/etk.hpp>
+#include <ethread/tools.hpp>
+#include <test-debug/debug.hpp>
+
+int main(int _argc, const char **_argv) {
+	// the only one init for etk:
+	etk::init(_argc, _argv);
+	etk::String configFile;
+	etk::String serverName = "river";
+	int32_t duration = 0;
+	for (int32_t iii=0; iii<_argc ; ++iii) {
+		etk::String data = _argv[iii];
+		if (data.startWith("--config=") == true) {
+			configFile = etk::String(data.begin()+9, data.end());
+		} else if (data.startWith("--name=") == true) {
+			serverName = etk::String(data.begin()+7, data.end());
+		} else if (data.startWith("--time=") == true) {
+			duration = atoi(etk::String(data.begin()+7, data.end()).c_str());
+		} else if (    data == "-h"
+		            || data == "--help") {
+			TEST_PRINT("Help:");
+			TEST_PRINT("    ./xxx --config=river.json --name=river --time=60");
+			TEST_PRINT("        --config=XXX  configuration of the nodes of the server (default config if not set)");
+			TEST_PRINT("        --name=XXX    name of the server (map-on:{server:'XXX'} in the clients)");
+			TEST_PRINT("        --time=XXX    time in second before stopping (0: never)");
+			exit(0);
+		}
+	}
+	//! [audio_river_sample_server_start]
+	// initialize river with the nodes that the server own
+	audio::river::init(configFile);
+	// publish the nodes for the other processes
+	if (audio::river::startServer(serverName) == false) {
+		TEST_ERROR("Can not start the river server '" << serverName << "'");
+		return -1;
+	}
+	//! [audio_river_sample_server_start]
+	TEST_PRINT("River server '" << serverName << "' started");
+	int32_t elapsed = 0;
+	while (    duration == 0
+	        || elapsed < duration) {
+		ethread::sleepMilliSeconds(1000);
+		elapsed++;
+	}
+	audio::river::stopServer();
+	audio::river::unInit();
+	return 0;
+}
+
+//! [audio_river_sample_server_all]
@@ -0,0 +1,186 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#include <test-debug/debug.hpp>
+#include <audio/river/river.hpp>
+#include <audio/river/Manager.hpp>
+#include <audio/river/Interface.hpp>
+#include <audio/river/io/Manager.hpp>
+#include <audio/river/io/NodeClock.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+
+namespace river_test_clock {
+	TEST(TestClock, sampleDuration) {
+		EXPECT_EQ(audio::river::io::NodeClock::getSampleDuration(0, 48000).get(), 0);
+		EXPECT_EQ(audio::river::io::NodeClock::getSampleDuration(48000, 48000).get(), 1000000000LL);
+		EXPECT_EQ(audio::river::io::NodeClock::getSampleDuration(24000, 48000).get(), 500000000LL);
+		EXPECT_EQ(audio::river::io::NodeClock::getSampleDuration(1, 44100).get(), 22675LL);
+	}
+	
+	TEST(TestClock, sampleDurationLongRun) {
+		// nbSample*1000000000 overflow a 64 bits integer after ~106 hours at 48kHz
+		uint64_t nbSample = uint64_t(48000)*3600*200 + 12000;
+		audio::Duration duration = audio::river::io::NodeClock::getSampleDuration(nbSample, 48000);
+		EXPECT_EQ(duration.get(), (3600LL*200)*1000000000LL + 250000000LL);
+		// one year of flow
+		nbSample = uint64_t(48000)*3600*24*365;
+		duration = audio::river::io::NodeClock::getSampleDuration(nbSample, 48000);
+		EXPECT_EQ(duration.get(), (3600LL*24*365)*1000000000LL);
+	}
+	
+	class OutputCounter {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+		public:
+			uint64_t m_nbSample; //!< Number of frame requested by the node
+			etk::Vector<audio::Time> m_listTime; //!< Time of each callback
+		public:
+			OutputCounter(ememory::SharedPtr<audio::river::Manager> _manager, const etk::String& _streamName) :
+			  m_nbSample(0) {
+				etk::Vector<audio::channel> channelMap;
+				channelMap.pushBack(audio::channel_frontLeft);
+				channelMap.pushBack(audio::channel_frontRight);
+				m_interface = _manager->createOutput(48000,
+				                                     channelMap,
+				                                     audio::format_int16,
+				                                     _streamName);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setOutputCallback([=](void* _data,
+				                                   const audio::Time& _time,
+				                                   size_t _nbChunk,
+				                                   enum audio::format _format,
+				                                   uint32_t _frequency,
+				                                   const etk::Vector<audio::channel>& _map) {
+				                                   	memset(_data, 0, _nbChunk*_map.size()*audio::getFormatBytes(_format));
+				                                   	m_listTime.pushBack(_time);
+				                                   	m_nbSample += _nbChunk;
+				                                   });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+	};
+	
+	static const etk::String configurationManual =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"		clock:'manual',\n"
+		"	}\n"
+		"}\n";
+	
+	TEST(TestClock, virtualManualStep) {
+		audio::river::initString(configurationManual);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<OutputCounter> process = ememory::makeShared<OutputCounter>(manager, "speaker");
+		ASSERT_EQ(process->isValid(), true);
+		ememory::SharedPtr<audio::river::io::NodeClock> node = ememory::dynamicPointerCast<audio::river::io::NodeClock>(audio::river::io::Manager::getInstance()->getNode("speaker"));
+		ASSERT_NE(node, null);
+		EXPECT_EQ(node->isManualClock(), true);
+		// the flow is stopped: nothing to process
+		EXPECT_EQ(node->step(1), false);
+		process->start();
+		EXPECT_EQ(node->isRunning(), true);
+		// no thread: nothing happen without step()
+		EXPECT_EQ(process->m_nbSample, 0);
+		audio::Time startTime = node->getClockTime();
+		EXPECT_EQ(node->step(4), true);
+		EXPECT_EQ(process->m_nbSample, 4*256);
+		EXPECT_EQ((node->getClockTime() - startTime).get(), audio::river::io::NodeClock::getSampleDuration(4*256, 48000).get());
+		ASSERT_EQ(process->m_listTime.size(), 4);
+		for (size_t iii=0; iii<process->m_listTime.size(); ++iii) {
+			// the time is computed from the sample counter: no drift between the periods
+			EXPECT_EQ((process->m_listTime[iii] - process->m_listTime[0]).get(), audio::river::io::NodeClock::getSampleDuration(iii*256, 48000).get());
+		}
+		process->stop();
+		EXPECT_EQ(node->isRunning(), false);
+		EXPECT_EQ(node->step(1), false);
+		EXPECT_EQ(process->m_nbSample, 4*256);
+		node.reset();
+		process.reset();
+		manager.reset();
+		audio::river::unInit();
+	}
+	
+	static const etk::String configurationOffline =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'output',\n"
+		"		map-on:{\n"
+		"			interface:'auto',\n"
+		"			name:'default',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-second:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:480,\n"
+		"	}\n"
+		"}\n";
+	
+	TEST(TestClock, offlineRender) {
+		audio::river::initString(configurationOffline);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(1,0)), false);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<OutputCounter> process = ememory::makeShared<OutputCounter>(manager, "speaker");
+		ASSERT_EQ(process->isValid(), true);
+		ememory::SharedPtr<OutputCounter> processSecond = ememory::makeShared<OutputCounter>(manager, "speaker-second");
+		ASSERT_EQ(processSecond->isValid(), true);
+		// the mode can not change when a node is open
+		EXPECT_EQ(audio::river::setOfflineMode(false), false);
+		// the hardware node is replaced by a virtual node driven by the master clock
+		ememory::SharedPtr<audio::river::io::NodeClock> node = ememory::dynamicPointerCast<audio::river::io::NodeClock>(audio::river::io::Manager::getInstance()->getNode("speaker"));
+		ASSERT_NE(node, null);
+		EXPECT_EQ(node->isManualClock(), true);
+		node.reset();
+		audio::Time startTime = audio::river::io::Manager::getInstance()->getOfflineTime();
+		process->start();
+		processSecond->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(1,0)), true);
+		// each node render its periods until the end of the duration (no wait of the real time)
+		EXPECT_EQ(process->m_nbSample, 188*256);
+		EXPECT_EQ(processSecond->m_nbSample, 100*480);
+		EXPECT_EQ((audio::river::io::Manager::getInstance()->getOfflineTime() - startTime).get(), 1000000000LL);
+		ASSERT_NE(process->m_listTime.size(), 0);
+		ASSERT_NE(processSecond->m_listTime.size(), 0);
+		// all the flows are aligned on the master clock
+		EXPECT_EQ((process->m_listTime[0] - startTime).get(), 0);
+		EXPECT_EQ((processSecond->m_listTime[0] - startTime).get(), 0);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,500000000)), true);
+		EXPECT_EQ(process->m_nbSample, 282*256);
+		EXPECT_EQ(processSecond->m_nbSample, 150*480);
+		process->stop();
+		processSecond->stop();
+		process.reset();
+		processSecond.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+};
+
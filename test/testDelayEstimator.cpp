@@ -0,0 +1,152 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/io/Fft.hpp>
+#include <audio/river/io/DelayEstimator.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+#include <ethread/tools.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+namespace river_test_delay_estimator {
+	/**
+	 * @brief Deterministic white noise in [-1..1].
+	 */
+	class Noise {
+		private:
+			uint32_t m_seed;
+		public:
+			Noise(uint32_t _seed) :
+			  m_seed(_seed) {
+
+			}
+			float get() {
+				m_seed = m_seed*1664525 + 1013904223;
+				return float(int32_t(m_seed>>8) - (1<<23)) / float(1<<23);
+			}
+	};
+
+	TEST(TestFft, knownBin) {
+		audio::river::io::Fft fft;
+		ASSERT_EQ(fft.init(64), true);
+		etk::Vector<float> input;
+		etk::Vector<float> real;
+		etk::Vector<float> imag;
+		input.resize(64, 0.0f);
+		real.resize(33, 0.0f);
+		imag.resize(33, 0.0f);
+		// cos on the bin 5 and sin on the bin 12
+		for (size_t iii=0; iii<64; ++iii) {
+			input[iii] = cosf(2.0*M_PI*5.0*iii/64.0) + 0.5f*sinf(2.0*M_PI*12.0*iii/64.0);
+		}
+		fft.forward(&input[0], &real[0], &imag[0]);
+		uint32_t nbError = 0;
+		for (size_t iii=0; iii<33; ++iii) {
+			float expectedReal = iii == 5 ? 32.0f : 0.0f;
+			float expectedImag = iii == 12 ? -16.0f : 0.0f;
+			if (    fabsf(real[iii] - expectedReal) > 1.0e-3f
+			     || fabsf(imag[iii] - expectedImag) > 1.0e-3f) {
+				TEST_ERROR("bin " << iii << " = " << real[iii] << " + i*" << imag[iii]);
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+	}
+
+	TEST(TestFft, roundTrip) {
+		audio::river::io::Fft fft;
+		ASSERT_EQ(fft.init(512), true);
+		etk::Vector<float> input;
+		etk::Vector<float> output;
+		etk::Vector<float> real;
+		etk::Vector<float> imag;
+		input.resize(512, 0.0f);
+		output.resize(512, 0.0f);
+		real.resize(257, 0.0f);
+		imag.resize(257, 0.0f);
+		Noise noise(1234);
+		for (auto &it : input) {
+			it = noise.get();
+		}
+		fft.forward(&input[0], &real[0], &imag[0]);
+		fft.inverse(&real[0], &imag[0], &output[0]);
+		float maxError = 0.0f;
+		for (size_t iii=0; iii<512; ++iii) {
+			maxError = etk::max(maxError, fabsf(output[iii] - input[iii]));
+		}
+		EXPECT_EQ(maxError < 1.0e-5f, true);
+	}
+
+	TEST(TestFft, wrongSize) {
+		audio::river::io::Fft fft;
+		EXPECT_EQ(fft.init(0), false);
+		EXPECT_EQ(fft.init(1), false);
+		EXPECT_EQ(fft.init(384), false);
+	}
+
+	/**
+	 * @brief Push a noise and its echo (attenuated and delayed) in the estimator and wait the estimation.
+	 * @param[in] _delay Delay of the microphone after the feedback (can be negative).
+	 * @param[in] _gain Gain of the echo (0 to play nothing).
+	 * @param[out] _result Estimated delay.
+	 * @return true An estimation is availlable.
+	 */
+	static bool estimate(int32_t _delay, float _gain, int32_t& _result) {
+		audio::river::io::DelayEstimator estimator;
+		if (estimator.init(48000, 200, 100) == false) {
+			return false;
+		}
+		const int32_t nbChunk = 256;
+		const int32_t margin = 48000;
+		Noise noise(4242);
+		etk::Vector<float> signal;
+		signal.resize(48000 + margin*2, 0.0f);
+		for (auto &it : signal) {
+			it = _gain*noise.get();
+		}
+		Noise noiseMicrophone(42);
+		etk::Vector<int16_t> microphone;
+		etk::Vector<int16_t> feedback;
+		microphone.resize(nbChunk, 0);
+		feedback.resize(nbChunk, 0);
+		for (int32_t pos=0; pos+nbChunk<=48000; pos+=nbChunk) {
+			for (int32_t iii=0; iii<nbChunk; ++iii) {
+				feedback[iii] = int16_t(signal[margin+pos+iii]*16000.0f);
+				// echo at -6 dB and a small noise of the room
+				microphone[iii] = int16_t(signal[margin+pos+iii-_delay]*8000.0f + noiseMicrophone.get()*200.0f);
+			}
+			estimator.push(&microphone[0], 1, &feedback[0], nbChunk);
+		}
+		for (int32_t iii=0; iii<40; ++iii) {
+			ethread::sleepMilliSeconds(50);
+			if (estimator.getDelay(_result) == true) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	TEST(TestDelayEstimator, positiveDelay) {
+		int32_t delay = 0;
+		ASSERT_EQ(estimate(1200, 1.0f, delay), true);
+		EXPECT_EQ(delay, 1200);
+	}
+
+	TEST(TestDelayEstimator, negativeDelay) {
+		int32_t delay = 0;
+		ASSERT_EQ(estimate(-600, 1.0f, delay), true);
+		EXPECT_EQ(delay, -600);
+	}
+
+	TEST(TestDelayEstimator, silence) {
+		int32_t delay = 0;
+		EXPECT_EQ(estimate(1200, 0.0f, delay), false);
+	}
+};
+
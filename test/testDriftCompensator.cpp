@@ -0,0 +1,106 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/io/StreamSynchronizer.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+namespace river_test_drift_compensator {
+	static const uint32_t frequency = 48000;
+	static const uint32_t nbChunk = 256;
+
+	static audio::Time getTime(double _second) {
+		int64_t time = int64_t(_second*1000000000.0);
+		return audio::Time() + audio::Duration(time/1000000000LL, time%1000000000LL);
+	}
+
+	/**
+	 * @brief Synchronize a reference flow and a secondary flow generated by a crystal with a drift.
+	 * Each frame of the 2 flows contain the time where it has been recorded: after the compensation the 2 chunks must contain the same values.
+	 * @param[in] _drift Drift of the secondary clock (ratio - 1).
+	 * @param[in] _duration Duration of the simulation (second).
+	 * @param[out] _maxError Maximum error between the 2 flows on the last 10 seconds (sample).
+	 * @param[out] _maxStepError Maximum error on the step between 2 frames of the secondary flow after the first second (sample).
+	 * @return Number of chunk generated.
+	 */
+	static uint32_t simulate(double _drift, double _duration, double& _maxError, double& _maxStepError) {
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, nbChunk, true);
+		synchronizer.addSource(audio::format_double, 1, audio::Duration(1, 0));
+		synchronizer.addSource(audio::format_double, 1, audio::Duration(1, 0));
+		const double frequencySecondary = double(frequency)*(1.0+_drift);
+		etk::Vector<double> block;
+		block.resize(nbChunk, 0.0);
+		uint64_t positionReference = 0;
+		uint64_t positionSecondary = 0;
+		uint32_t nbChunkOut = 0;
+		double lastValue = -1.0;
+		_maxError = 0.0;
+		_maxStepError = 0.0;
+		while (double(positionReference)/double(frequency) < _duration) {
+			// the reference flow write one block, the secondary flow write all the blocks recorded before
+			for (uint32_t iii=0; iii<nbChunk; ++iii) {
+				block[iii] = double(positionReference+iii)/double(frequency);
+			}
+			synchronizer.write(0, &block[0], nbChunk, getTime(block[0]));
+			positionReference += nbChunk;
+			while (double(positionSecondary+nbChunk)/frequencySecondary <= double(positionReference)/double(frequency)) {
+				for (uint32_t iii=0; iii<nbChunk; ++iii) {
+					block[iii] = double(positionSecondary+iii)/frequencySecondary;
+				}
+				synchronizer.write(1, &block[0], nbChunk, getTime(block[0]));
+				positionSecondary += nbChunk;
+			}
+			audio::Time time;
+			while (synchronizer.acquire(time) == true) {
+				const double* reference = static_cast<const double*>(synchronizer.getData(0));
+				const double* secondary = static_cast<const double*>(synchronizer.getData(1));
+				for (uint32_t iii=0; iii<nbChunk; ++iii) {
+					if (reference[iii] > _duration - 10.0) {
+						_maxError = etk::max(_maxError, fabs(secondary[iii] - reference[iii])*double(frequency));
+					}
+					if (    reference[iii] > 1.0
+					     && lastValue >= 0.0) {
+						_maxStepError = etk::max(_maxStepError, fabs((secondary[iii] - lastValue)*double(frequency) - 1.0));
+					}
+					lastValue = secondary[iii];
+				}
+				synchronizer.release();
+				nbChunkOut++;
+			}
+		}
+		return nbChunkOut;
+	}
+
+	TEST(TestDriftCompensator, followDrift) {
+		// crystals with a difference of 200 ppm
+		double maxError = 0.0;
+		double maxStepError = 0.0;
+		uint32_t nbChunkOut = simulate(200.0e-6, 60.0, maxError, maxStepError);
+		TEST_INFO("drift: chunk=" << nbChunkOut << " error=" << maxError << " step error=" << maxStepError);
+		// all the chunk of the reference are generated (except the latency of the start)
+		EXPECT_EQ(nbChunkOut + 4 >= uint32_t(60.0*frequency/nbChunk), true);
+		// the flows stay aligned ...
+		EXPECT_EQ(maxError < 1.0, true);
+		// ... without drop or repeat of data
+		EXPECT_EQ(maxStepError < 0.1, true);
+	}
+
+	TEST(TestDriftCompensator, followNegativeDrift) {
+		double maxError = 0.0;
+		double maxStepError = 0.0;
+		uint32_t nbChunkOut = simulate(-200.0e-6, 60.0, maxError, maxStepError);
+		TEST_INFO("drift: chunk=" << nbChunkOut << " error=" << maxError << " step error=" << maxStepError);
+		EXPECT_EQ(nbChunkOut + 4 >= uint32_t(60.0*frequency/nbChunk), true);
+		EXPECT_EQ(maxError < 1.0, true);
+		EXPECT_EQ(maxStepError < 0.1, true);
+	}
+};
+
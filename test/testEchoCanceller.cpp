@@ -0,0 +1,147 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/io/EchoCanceller.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+extern "C" {
+	#include <math.h>
+}
+
+namespace river_test_echo_canceller {
+	static const uint32_t blockSize = 256;
+	static const uint32_t nbPartition = 8;
+	static const uint32_t impulseSize = 1024;
+	static const uint32_t nbBlock = 600;
+	static const uint32_t nbBlockMeasure = 50;
+
+	/**
+	 * @brief Deterministic white noise in [-1..1].
+	 */
+	class Noise {
+		private:
+			uint32_t m_seed;
+		public:
+			Noise(uint32_t _seed) :
+			  m_seed(_seed) {
+
+			}
+			float get() {
+				m_seed = m_seed*1664525 + 1013904223;
+				return float(int32_t(m_seed>>8) - (1<<23)) / float(1<<23);
+			}
+	};
+
+	/**
+	 * @brief Create a room impulse response: a direct path delayed and an exponential decay (-10 dB of gain).
+	 */
+	static etk::Vector<float> createImpulse(uint32_t _seed, uint32_t _delay) {
+		Noise noise(_seed);
+		etk::Vector<float> out;
+		out.resize(impulseSize, 0.0f);
+		for (uint32_t iii=_delay; iii<impulseSize; ++iii) {
+			out[iii] = 0.05f*noise.get()*expf(-float(iii-_delay)/150.0f);
+		}
+		return out;
+	}
+
+	/**
+	 * @brief Play a white noise in 2 rooms and measure the echo return loss enhancement of each microphone channel at the end of the convergence.
+	 */
+	static bool runCanceller(float _step, float& _erleLeft, float& _erleRight) {
+		audio::river::io::EchoCanceller canceller;
+		if (canceller.init(blockSize, nbPartition, 2, _step) == false) {
+			return false;
+		}
+		etk::Vector<float> impulseLeft = createImpulse(42, 100);
+		etk::Vector<float> impulseRight = createImpulse(4242, 180);
+		etk::Vector<float> history;
+		history.resize(impulseSize + blockSize*nbBlock, 0.0f);
+		etk::Vector<int16_t> reference;
+		reference.resize(blockSize, 0);
+		etk::Vector<int16_t> microphone;
+		microphone.resize(blockSize*2, 0);
+		Noise noise(1234);
+		double energyMicrophone[2] = {0.0, 0.0};
+		double energyError[2] = {0.0, 0.0};
+		for (uint32_t bbb=0; bbb<nbBlock; ++bbb) {
+			bool measure = bbb >= nbBlock-nbBlockMeasure;
+			for (uint32_t iii=0; iii<blockSize; ++iii) {
+				reference[iii] = int16_t(0.25f*noise.get()*32768.0f);
+				size_t pos = impulseSize + bbb*blockSize + iii;
+				history[pos] = float(reference[iii])/32768.0f;
+				float left = 0.0f;
+				float right = 0.0f;
+				for (size_t kkk=0; kkk<impulseSize; ++kkk) {
+					left += impulseLeft[kkk]*history[pos-kkk];
+					right += impulseRight[kkk]*history[pos-kkk];
+				}
+				microphone[iii*2] = int16_t(lrintf(left*32768.0f));
+				microphone[iii*2+1] = int16_t(lrintf(right*32768.0f));
+				if (measure == true) {
+					energyMicrophone[0] += double(microphone[iii*2])*double(microphone[iii*2]);
+					energyMicrophone[1] += double(microphone[iii*2+1])*double(microphone[iii*2+1]);
+				}
+			}
+			canceller.process(&microphone[0], &reference[0]);
+			if (measure == true) {
+				for (uint32_t iii=0; iii<blockSize; ++iii) {
+					energyError[0] += double(microphone[iii*2])*double(microphone[iii*2]);
+					energyError[1] += double(microphone[iii*2+1])*double(microphone[iii*2+1]);
+				}
+			}
+		}
+		// the residual can be exactly 0 after the quantification on 16 bits
+		_erleLeft = 10.0*log10(energyMicrophone[0]/(energyError[0]+1.0));
+		_erleRight = 10.0*log10(energyMicrophone[1]/(energyError[1]+1.0));
+		TEST_INFO("ERLE step=" << _step << " left=" << _erleLeft << " dB right=" << _erleRight << " dB");
+		return true;
+	}
+
+	TEST(TestEchoCanceller, erle) {
+		float erleLeft = 0.0f;
+		float erleRight = 0.0f;
+		ASSERT_EQ(runCanceller(0.5f, erleLeft, erleRight), true);
+		EXPECT_EQ(erleLeft >= 40.0f, true);
+		EXPECT_EQ(erleRight >= 40.0f, true);
+	}
+
+	TEST(TestEchoCanceller, nearEndOnly) {
+		audio::river::io::EchoCanceller canceller;
+		ASSERT_EQ(canceller.init(blockSize, nbPartition, 1, 0.5f), true);
+		etk::Vector<int16_t> reference;
+		reference.resize(blockSize, 0);
+		etk::Vector<int16_t> microphone;
+		microphone.resize(blockSize, 0);
+		Noise noise(1234);
+		// near-end speech only: the microphone must not be modified
+		uint32_t nbError = 0;
+		for (uint32_t bbb=0; bbb<20; ++bbb) {
+			etk::Vector<int16_t> input;
+			input.resize(blockSize, 0);
+			for (uint32_t iii=0; iii<blockSize; ++iii) {
+				input[iii] = int16_t(0.25f*noise.get()*32768.0f);
+				microphone[iii] = input[iii];
+			}
+			canceller.process(&microphone[0], &reference[0]);
+			for (uint32_t iii=0; iii<blockSize; ++iii) {
+				if (microphone[iii] != input[iii]) {
+					nbError++;
+				}
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+	}
+
+	TEST(TestEchoCanceller, wrongBlockSize) {
+		audio::river::io::EchoCanceller canceller;
+		EXPECT_EQ(canceller.init(250, nbPartition, 1, 0.5f), false);
+		EXPECT_EQ(canceller.init(256, 0, 1, 0.5f), false);
+		EXPECT_EQ(canceller.init(256, nbPartition, 0, 0.5f), false);
+	}
+};
+
@@ -0,0 +1,344 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#include <test-debug/debug.hpp>
+#include <audio/river/river.hpp>
+#include <audio/river/Manager.hpp>
+#include <audio/river/Interface.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+extern "C" {
+	#include <stdio.h>
+	#include <string.h>
+	#include <unistd.h>
+}
+
+namespace river_test_file {
+	static const char* fileNameOutput = "river-test-file-output.wav";
+	static const char* fileNameExtensible = "river-test-file-extensible.wav";
+
+	/**
+	 * @brief Generate a ramp on the 2 channels (right = -left).
+	 */
+	class Generator {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+		public:
+			int16_t m_value; //!< Next value of the ramp
+			uint64_t m_nbSample; //!< Number of frame generated
+		public:
+			Generator(ememory::SharedPtr<audio::river::Manager> _manager, const etk::String& _streamName) :
+			  m_value(0),
+			  m_nbSample(0) {
+				etk::Vector<audio::channel> channelMap;
+				channelMap.pushBack(audio::channel_frontLeft);
+				channelMap.pushBack(audio::channel_frontRight);
+				m_interface = _manager->createOutput(48000,
+				                                     channelMap,
+				                                     audio::format_int16,
+				                                     _streamName);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setOutputCallback([=](void* _data,
+				                                   const audio::Time& _time,
+				                                   size_t _nbChunk,
+				                                   enum audio::format _format,
+				                                   uint32_t _frequency,
+				                                   const etk::Vector<audio::channel>& _map) {
+				                                   	int16_t* data = static_cast<int16_t*>(_data);
+				                                   	for (size_t iii=0; iii<_nbChunk; ++iii) {
+				                                   		data[iii*2] = m_value;
+				                                   		data[iii*2+1] = -m_value;
+				                                   		m_value++;
+				                                   	}
+				                                   	m_nbSample += _nbChunk;
+				                                   });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+	};
+
+	/**
+	 * @brief Store all the frames received.
+	 */
+	class Recorder {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+		public:
+			etk::Vector<int16_t> m_data; //!< Interleaved frames received
+		public:
+			Recorder(ememory::SharedPtr<audio::river::Manager> _manager, const etk::String& _streamName) {
+				etk::Vector<audio::channel> channelMap;
+				channelMap.pushBack(audio::channel_frontLeft);
+				channelMap.pushBack(audio::channel_frontRight);
+				m_interface = _manager->createInput(48000,
+				                                    channelMap,
+				                                    audio::format_int16,
+				                                    _streamName);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setInputCallback([=](const void* _data,
+				                                  const audio::Time& _time,
+				                                  size_t _nbChunk,
+				                                  enum audio::format _format,
+				                                  uint32_t _frequency,
+				                                  const etk::Vector<audio::channel>& _map) {
+				                                  	const int16_t* data = static_cast<const int16_t*>(_data);
+				                                  	for (size_t iii=0; iii<_nbChunk*_map.size(); ++iii) {
+				                                  		m_data.pushBack(data[iii]);
+				                                  	}
+				                                  });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+	};
+
+	static uint32_t getLE32(const uint8_t* _data) {
+		return uint32_t(_data[0]) | (uint32_t(_data[1]) << 8) | (uint32_t(_data[2]) << 16) | (uint32_t(_data[3]) << 24);
+	}
+
+	static uint16_t getLE16(const uint8_t* _data) {
+		return uint16_t(_data[0]) | (uint16_t(_data[1]) << 8);
+	}
+
+	static void setLE32(uint8_t* _data, uint32_t _value) {
+		_data[0] = _value & 0xFF;
+		_data[1] = (_value >> 8) & 0xFF;
+		_data[2] = (_value >> 16) & 0xFF;
+		_data[3] = (_value >> 24) & 0xFF;
+	}
+
+	static void setLE16(uint8_t* _data, uint16_t _value) {
+		_data[0] = _value & 0xFF;
+		_data[1] = (_value >> 8) & 0xFF;
+	}
+
+	static etk::Vector<uint8_t> readFile(const char* _fileName) {
+		etk::Vector<uint8_t> out;
+		FILE* file = fopen(_fileName, "rb");
+		if (file == null) {
+			return out;
+		}
+		uint8_t buffer[4096];
+		size_t size = 0;
+		while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+			for (size_t iii=0; iii<size; ++iii) {
+				out.pushBack(buffer[iii]);
+			}
+		}
+		fclose(file);
+		return out;
+	}
+
+	/**
+	 * @brief Write a stereo int16 48kHz wav file with a 'fmt ' chunk WAVE_FORMAT_EXTENSIBLE.
+	 * @param[in] _fmtSize Size of the 'fmt ' chunk (40 for a valid file).
+	 * @param[in] _nbFrame Number of frame of the ramp.
+	 */
+	static void writeExtensibleFile(uint32_t _fmtSize, uint32_t _nbFrame) {
+		etk::Vector<uint8_t> data;
+		data.resize(12 + 8 + _fmtSize + 8 + _nbFrame*4, 0);
+		uint8_t* pointer = &data[0];
+		memcpy(pointer, "RIFF", 4);
+		setLE32(pointer+4, data.size()-8);
+		memcpy(pointer+8, "WAVE", 4);
+		memcpy(pointer+12, "fmt ", 4);
+		setLE32(pointer+16, _fmtSize);
+		setLE16(pointer+20, 0xFFFE);
+		setLE16(pointer+22, 2);
+		setLE32(pointer+24, 48000);
+		setLE32(pointer+28, 48000*4);
+		setLE16(pointer+32, 4);
+		setLE16(pointer+34, 16);
+		if (_fmtSize >= 40) {
+			setLE16(pointer+36, 22);
+			setLE16(pointer+38, 16);
+			setLE32(pointer+40, 0x3);
+			// sub-format GUID: KSDATAFORMAT_SUBTYPE_PCM
+			setLE16(pointer+44, 1);
+		}
+		pointer += 20 + _fmtSize;
+		memcpy(pointer, "data", 4);
+		setLE32(pointer+4, _nbFrame*4);
+		int16_t* samples = reinterpret_cast<int16_t*>(pointer+8);
+		for (uint32_t iii=0; iii<_nbFrame; ++iii) {
+			samples[iii*2] = int16_t(iii);
+			samples[iii*2+1] = -int16_t(iii);
+		}
+		FILE* file = fopen(fileNameExtensible, "wb");
+		if (file == null) {
+			TEST_ERROR("Can not create the file: " << fileNameExtensible);
+			return;
+		}
+		fwrite(&data[0], 1, data.size(), file);
+		fclose(file);
+	}
+
+	static etk::String getConfiguration(const etk::String& _io, const etk::String& _path) {
+		return   etk::String("{\n")
+		       + "	file:{\n"
+		       + "		io:'" + _io + "',\n"
+		       + "		map-on:{\n"
+		       + "			path:'" + _path + "',\n"
+		       + "		},\n"
+		       + "		frequency:48000,\n"
+		       + "		channel-map:['front-left', 'front-right'],\n"
+		       + "		type:'int16',\n"
+		       + "		nb-chunk:256,\n"
+		       + "	}\n"
+		       + "}\n";
+	}
+
+	TEST(TestFile, writeWav) {
+		// write 100 ms in the file:
+		audio::river::initString(getConfiguration("file-output", fileNameOutput));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Generator> generator = ememory::makeShared<Generator>(manager, "file");
+		ASSERT_EQ(generator->isValid(), true);
+		generator->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		generator->stop();
+		// the header is written when the node is closed
+		generator.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+		const uint32_t nbFrame = 19*256;
+		etk::Vector<uint8_t> file = readFile(fileNameOutput);
+		ASSERT_EQ(file.size(), 44 + nbFrame*4);
+		EXPECT_EQ(memcmp(&file[0], "RIFF", 4), 0);
+		EXPECT_EQ(getLE32(&file[4]), 36 + nbFrame*4);
+		EXPECT_EQ(memcmp(&file[8], "WAVE", 4), 0);
+		EXPECT_EQ(memcmp(&file[12], "fmt ", 4), 0);
+		EXPECT_EQ(getLE32(&file[16]), 16);
+		EXPECT_EQ(getLE16(&file[20]), 1);
+		EXPECT_EQ(getLE16(&file[22]), 2);
+		EXPECT_EQ(getLE32(&file[24]), 48000);
+		EXPECT_EQ(getLE16(&file[34]), 16);
+		EXPECT_EQ(memcmp(&file[36], "data", 4), 0);
+		EXPECT_EQ(getLE32(&file[40]), nbFrame*4);
+		const int16_t* samples = reinterpret_cast<const int16_t*>(&file[44]);
+		uint32_t nbError = 0;
+		for (uint32_t iii=0; iii<nbFrame; ++iii) {
+			if (    samples[iii*2] != int16_t(iii)
+			     || samples[iii*2+1] != -int16_t(iii)) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		unlink(fileNameOutput);
+	}
+
+	TEST(TestFile, readWav) {
+		audio::river::initString(getConfiguration("file-output", fileNameOutput));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Generator> generator = ememory::makeShared<Generator>(manager, "file");
+		ASSERT_EQ(generator->isValid(), true);
+		generator->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		generator->stop();
+		generator.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+		// the file is read with a direct access in the memory map, the end of the file is followed by silence
+		audio::river::initString(getConfiguration("file-input", fileNameOutput));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager, "file");
+		ASSERT_EQ(recorder->isValid(), true);
+		recorder->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,200000000)), true);
+		recorder->stop();
+		const uint32_t nbFrame = 19*256;
+		ASSERT_EQ(recorder->m_data.size(), 38*256*2);
+		uint32_t nbError = 0;
+		for (uint32_t iii=0; iii<38*256; ++iii) {
+			int16_t value = iii < nbFrame ? int16_t(iii) : 0;
+			if (    recorder->m_data[iii*2] != value
+			     || recorder->m_data[iii*2+1] != -value) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		recorder.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+		unlink(fileNameOutput);
+	}
+
+	TEST(TestFile, readWavExtensible) {
+		writeExtensibleFile(40, 1000);
+		audio::river::initString(getConfiguration("file-input", fileNameExtensible));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager, "file");
+		ASSERT_EQ(recorder->isValid(), true);
+		recorder->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,10000000)), true);
+		recorder->stop();
+		// 480 frames ==> 2 periods
+		ASSERT_EQ(recorder->m_data.size(), 2*256*2);
+		uint32_t nbError = 0;
+		for (uint32_t iii=0; iii<2*256; ++iii) {
+			if (    recorder->m_data[iii*2] != int16_t(iii)
+			     || recorder->m_data[iii*2+1] != -int16_t(iii)) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		recorder.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+		unlink(fileNameExtensible);
+	}
+
+	TEST(TestFile, rejectWavExtensibleTooShort) {
+		// a WAVE_FORMAT_EXTENSIBLE 'fmt ' chunk without the sub-format: the file is not read
+		writeExtensibleFile(18, 1000);
+		audio::river::initString(getConfiguration("file-input", fileNameExtensible));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager, "file");
+		if (recorder->isValid() == true) {
+			recorder->start();
+			EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,10000000)), true);
+			recorder->stop();
+		}
+		EXPECT_EQ(recorder->m_data.size(), 0);
+		recorder.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+		unlink(fileNameExtensible);
+	}
+};
+
@@ -0,0 +1,96 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/io/PeriodAdapter.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+#include <ethread/tools.hpp>
+
+namespace river_test_period_adapter {
+	/**
+	 * @brief Generate the configuration of a node with an adaptive nb-chunk.
+	 * @param[in] _max Maximum nb-chunk.
+	 * @param[in] _observation Time of low load before a decrease (s).
+	 * @return The configuration of the node.
+	 */
+	static ejson::Object getConfiguration(uint32_t _max, uint32_t _observation) {
+		ejson::Object adaptive;
+		adaptive.add("min", ejson::Number(128));
+		adaptive.add("max", ejson::Number(_max));
+		adaptive.add("observation", ejson::Number(_observation));
+		ejson::Object out;
+		out.add("nb-chunk-adaptive", adaptive);
+		return out;
+	}
+
+	/**
+	 * @brief Simulate the callbacks of a node with a very low load during a time.
+	 * @param[in] _adapter Adapter of the node.
+	 * @param[in] _nbChunk Period of the node.
+	 * @param[in] _durationMs Duration of the simulation.
+	 * @return The first new period requested, 0 if none.
+	 */
+	static uint32_t lowLoad(audio::river::io::PeriodAdapter& _adapter, uint32_t _nbChunk, uint32_t _durationMs) {
+		for (uint32_t iii=0; iii<_durationMs; iii+=50) {
+			_adapter.processStart();
+			uint32_t out = _adapter.processStop(_nbChunk, 48000);
+			if (out != 0) {
+				return out;
+			}
+			ethread::sleepMilliSeconds(50);
+		}
+		return 0;
+	}
+
+	TEST(TestPeriodAdapter, xrun) {
+		audio::river::io::PeriodAdapter adapter;
+		adapter.configure(getConfiguration(1024, 10), 256);
+		EXPECT_EQ(adapter.xrun(), 512);
+		// the request is pending until the node is re-created
+		EXPECT_EQ(adapter.xrun(), 0);
+		adapter.configure(getConfiguration(1024, 10), 512);
+		EXPECT_EQ(adapter.xrun(), 1024);
+		// the maximum is reached
+		adapter.configure(getConfiguration(1024, 10), 1024);
+		EXPECT_EQ(adapter.xrun(), 0);
+	}
+
+	TEST(TestPeriodAdapter, cancelRequest) {
+		audio::river::io::PeriodAdapter adapter;
+		adapter.configure(getConfiguration(4096, 10), 256);
+		EXPECT_EQ(adapter.xrun(), 512);
+		EXPECT_EQ(adapter.xrun(), 0);
+		adapter.processStart();
+		EXPECT_EQ(adapter.processStop(256, 48000), 0);
+		// the node has not been re-created: the adapter can request again
+		adapter.cancelRequest();
+		EXPECT_EQ(adapter.xrun(), 512);
+	}
+
+	TEST(TestPeriodAdapter, deadlineMissed) {
+		audio::river::io::PeriodAdapter adapter;
+		adapter.configure(getConfiguration(4096, 10), 256);
+		// a callback of 10 ms for a period of 1 ms
+		adapter.processStart();
+		ethread::sleepMilliSeconds(10);
+		EXPECT_EQ(adapter.processStop(48, 48000), 512);
+	}
+
+	TEST(TestPeriodAdapter, decrease) {
+		audio::river::io::PeriodAdapter adapter;
+		adapter.configure(getConfiguration(4096, 1), 1024);
+		// the period is divided by 2 after 1 s of low load
+		EXPECT_EQ(lowLoad(adapter, 1024, 2000), 512);
+		adapter.configure(getConfiguration(4096, 1), 512);
+		// the decrease is followed by a xrun: the next observation is doubled
+		EXPECT_EQ(adapter.xrun(), 1024);
+		adapter.configure(getConfiguration(4096, 1), 1024);
+		EXPECT_EQ(lowLoad(adapter, 1024, 1200), 0);
+		EXPECT_EQ(lowLoad(adapter, 1024, 1500), 512);
+	}
+};
+
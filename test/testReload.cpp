@@ -0,0 +1,334 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/river.hpp>
+#include <audio/river/Manager.hpp>
+#include <audio/river/Interface.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+#include <ethread/tools.hpp>
+
+namespace river_test_reload {
+	/**
+	 * @brief Generate the configuration of the test.
+	 * @param[in] _nbChunkSpeaker Period of the node "speaker".
+	 * @param[in] _speakerIo Type of the node "speaker".
+	 * @return The json configuration.
+	 */
+	static etk::String getConfiguration(uint32_t _nbChunkSpeaker, const etk::String& _speakerIo = "virtual-output") {
+		return   "{\n"
+		         "	speaker:{\n"
+		         "		io:'" + _speakerIo + "',\n"
+		         "		frequency:48000,\n"
+		         "		channel-map:['front-left', 'front-right'],\n"
+		         "		type:'int16',\n"
+		         "		nb-chunk:" + etk::toString(_nbChunkSpeaker) + ",\n"
+		         "	},\n"
+		         "	headset:{\n"
+		         "		io:'virtual-output',\n"
+		         "		frequency:48000,\n"
+		         "		channel-map:['front-left', 'front-right'],\n"
+		         "		type:'int16',\n"
+		         "		nb-chunk:256,\n"
+		         "	},\n"
+		         "}\n";
+	}
+
+	/**
+	 * @brief Count the frames requested by a node and the size of the last periods.
+	 */
+	class Counter {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+		public:
+			uint32_t m_nbFrame; //!< Number of frame requested
+			uint32_t m_nbCall; //!< Number of call of the callback
+			etk::Vector<size_t> m_listChunk; //!< Size of each period requested
+		public:
+			Counter(ememory::SharedPtr<audio::river::Manager> _manager,
+			        const etk::String& _streamName,
+			        const etk::String& _options = "") :
+			  m_nbFrame(0),
+			  m_nbCall(0) {
+				etk::Vector<audio::channel> channelMap;
+				channelMap.pushBack(audio::channel_frontLeft);
+				channelMap.pushBack(audio::channel_frontRight);
+				m_interface = _manager->createOutput(48000,
+				                                     channelMap,
+				                                     audio::format_int16,
+				                                     _streamName,
+				                                     _options);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setOutputCallback([=](void* _data,
+				                                   const audio::Time& _time,
+				                                   size_t _nbChunk,
+				                                   enum audio::format _format,
+				                                   uint32_t _frequency,
+				                                   const etk::Vector<audio::channel>& _map) {
+				                                   	memset(_data, 0, _nbChunk*_map.size()*sizeof(int16_t));
+				                                   	m_nbFrame += _nbChunk;
+				                                   	m_nbCall++;
+				                                   	m_listChunk.pushBack(_nbChunk);
+				                                   });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+			/**
+			 * @brief Check the size of the periods requested since a call.
+			 * @param[in] _firstCall First call to check.
+			 * @param[in] _nbChunk Expected period.
+			 * @return Number of period with an other size.
+			 */
+			uint32_t countWrongChunk(uint32_t _firstCall, size_t _nbChunk) const {
+				uint32_t out = 0;
+				for (size_t iii=_firstCall; iii<m_listChunk.size(); ++iii) {
+					if (m_listChunk[iii] != _nbChunk) {
+						out++;
+					}
+				}
+				return out;
+			}
+			/**
+			 * @brief Get the size of the last period requested.
+			 * @return Number of frame (0 if no period).
+			 */
+			size_t getLastChunk() const {
+				if (m_listChunk.size() == 0) {
+					return 0;
+				}
+				return m_listChunk[m_listChunk.size()-1];
+			}
+	};
+
+	/**
+	 * @brief Render until the node is re-created with a new period by the period thread.
+	 * @param[in] _probe Stream without latency request on the node (called one time per period).
+	 * @param[in] _nbChunk Expected period.
+	 * @return true The node use the period.
+	 */
+	static bool waitPeriod(const ememory::SharedPtr<Counter>& _probe, size_t _nbChunk) {
+		for (uint32_t iii=0; iii<100; ++iii) {
+			ethread::sleepMilliSeconds(20);
+			audio::river::renderOffline(audio::Duration(0,50000000));
+			if (_probe->getLastChunk() == _nbChunk) {
+				return true;
+			}
+		}
+		TEST_ERROR("the period is still " << _probe->getLastChunk() << " (wait " << _nbChunk << ")");
+		return false;
+	}
+
+	TEST(TestReload, changePeriod) {
+		audio::river::initString(getConfiguration(256));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Counter> speaker = ememory::makeShared<Counter>(manager, "speaker");
+		ememory::SharedPtr<Counter> headset = ememory::makeShared<Counter>(manager, "headset");
+		ASSERT_EQ(speaker->isValid(), true);
+		ASSERT_EQ(headset->isValid(), true);
+		speaker->start();
+		headset->start();
+		// 10 periods of 256 frames in 50 ms
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(speaker->m_nbFrame, 10*256);
+		EXPECT_EQ(headset->m_nbFrame, 10*256);
+		// the period of the speaker is reduced: its interface is migrated on the new node
+		EXPECT_EQ(audio::river::reloadString(getConfiguration(128)), true);
+		uint32_t firstCall = speaker->m_nbCall;
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		// the stream continue to play without restart ...
+		TEST_INFO("speaker: " << speaker->m_nbCall - firstCall << " periods after the reload");
+		EXPECT_EQ(speaker->m_nbCall - firstCall >= 17, true);
+		// ... with the new period
+		EXPECT_EQ(speaker->countWrongChunk(firstCall, 128), 0);
+		// the node that does not change is not re-created (its clock continue)
+		EXPECT_EQ(headset->m_nbFrame, 19*256);
+		EXPECT_EQ(headset->countWrongChunk(0, 256), 0);
+		speaker->stop();
+		headset->stop();
+		speaker.reset();
+		headset.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	TEST(TestReload, rejectInvalid) {
+		audio::river::initString(getConfiguration(256));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Counter> speaker = ememory::makeShared<Counter>(manager, "speaker");
+		ASSERT_EQ(speaker->isValid(), true);
+		speaker->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(speaker->m_nbFrame, 10*256);
+		// not a json data
+		EXPECT_EQ(audio::river::reloadString("{ speaker:{ io:'virtual-output',"), false);
+		// the new node can not be created: the previous configuration is restored
+		EXPECT_EQ(audio::river::reloadString(getConfiguration(128, "unknown-io")), false);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		// the old node is resumed on the offline clock: 10 new periods of 256 frames
+		EXPECT_EQ(speaker->m_nbFrame, 20*256);
+		EXPECT_EQ(speaker->countWrongChunk(0, 256), 0);
+		// a valid configuration is still accepted after the errors
+		uint32_t firstCall = speaker->m_nbCall;
+		EXPECT_EQ(audio::river::reloadString(getConfiguration(512)), true);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_NE(speaker->m_nbCall, firstCall);
+		EXPECT_EQ(speaker->countWrongChunk(firstCall, 512), 0);
+		speaker->stop();
+		speaker.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	/**
+	 * @brief Generate a configuration with a loopback input on the output "speaker".
+	 * @param[in] _nbChunkSpeaker Period of the node "speaker".
+	 * @return The json configuration.
+	 */
+	static etk::String getConfigurationLoopback(uint32_t _nbChunkSpeaker) {
+		return   "{\n"
+		         "	speaker:{\n"
+		         "		io:'virtual-output',\n"
+		         "		frequency:48000,\n"
+		         "		channel-map:['front-left', 'front-right'],\n"
+		         "		type:'int16',\n"
+		         "		nb-chunk:" + etk::toString(_nbChunkSpeaker) + ",\n"
+		         "	},\n"
+		         "	speaker-loop:{\n"
+		         "		io:'virtual-input',\n"
+		         "		map-on:{\n"
+		         "			loopback:'speaker',\n"
+		         "		},\n"
+		         "		frequency:48000,\n"
+		         "		channel-map:['front-left', 'front-right'],\n"
+		         "		type:'int16',\n"
+		         "		nb-chunk:256,\n"
+		         "	},\n"
+		         "}\n";
+	}
+
+	TEST(TestReload, migrateLoopback) {
+		audio::river::initString(getConfigurationLoopback(256));
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Counter> speaker = ememory::makeShared<Counter>(manager, "speaker");
+		ASSERT_EQ(speaker->isValid(), true);
+		etk::Vector<audio::channel> channelMap;
+		channelMap.pushBack(audio::channel_frontLeft);
+		channelMap.pushBack(audio::channel_frontRight);
+		ememory::SharedPtr<audio::river::Interface> recorder;
+		recorder = manager->createInput(48000, channelMap, audio::format_int16, "speaker-loop");
+		ASSERT_NE(recorder, null);
+		uint32_t nbFrameRecorded = 0;
+		recorder->setInputCallback([&](const void* _data,
+		                               const audio::Time& _time,
+		                               size_t _nbChunk,
+		                               enum audio::format _format,
+		                               uint32_t _frequency,
+		                               const etk::Vector<audio::channel>& _map) {
+		                               	nbFrameRecorded += _nbChunk;
+		                               });
+		speaker->start();
+		recorder->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(nbFrameRecorded, 10*256);
+		// the output is re-created: the loopback input follow the new node
+		EXPECT_EQ(audio::river::reloadString(getConfigurationLoopback(128)), true);
+		uint32_t firstCall = speaker->m_nbCall;
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(nbFrameRecorded, 10*256 + (speaker->m_nbCall - firstCall)*128);
+		EXPECT_EQ(speaker->m_nbCall - firstCall >= 17, true);
+		recorder->stop();
+		speaker->stop();
+		recorder.reset();
+		speaker.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	static const etk::String configurationLatency =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:1024,\n"
+		"		nb-chunk-latency:{\n"
+		"			min:100,\n"
+		"			max:3000,\n"
+		"		},\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestReload, latencyNegotiation) {
+		audio::river::initString(configurationLatency);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Counter> probe = ememory::makeShared<Counter>(manager, "speaker");
+		ememory::SharedPtr<Counter> music = ememory::makeShared<Counter>(manager, "speaker", "{latency:10}");
+		ememory::SharedPtr<Counter> voice = ememory::makeShared<Counter>(manager, "speaker", "{latency:3}");
+		ASSERT_EQ(probe->isValid(), true);
+		ASSERT_EQ(music->isValid(), true);
+		ASSERT_EQ(voice->isValid(), true);
+		// no latency requested: the maximum (2048: rounded down to a power of 2) is less than 4 times the period ==> kept
+		probe->start();
+		ethread::sleepMilliSeconds(100);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(probe->getLastChunk(), 1024);
+		// 10 ms = 480 frames ==> 256
+		music->start();
+		ASSERT_EQ(waitPeriod(probe, 256), true);
+		uint32_t firstCall = music->m_nbCall;
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(music->countWrongChunk(firstCall, 256), 0);
+		// 3 ms = 144 frames ==> the minimum (128: rounded up to a power of 2)
+		voice->start();
+		ASSERT_EQ(waitPeriod(probe, 128), true);
+		// the music tolerate 3 periods: it is called one time for 3 periods of the node
+		firstCall = music->m_nbCall;
+		uint32_t firstCallVoice = voice->m_nbCall;
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(music->getLastChunk(), 3*128);
+		EXPECT_EQ(voice->countWrongChunk(firstCallVoice, 128), 0);
+		EXPECT_EQ((voice->m_nbCall - firstCallVoice) + 3 >= 3*(music->m_nbCall - firstCall), true);
+		// hysteresis: 256 is less than 4 times the current period ==> the node is not re-created
+		voice->stop();
+		ethread::sleepMilliSeconds(100);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(probe->getLastChunk(), 128);
+		// no latency requested: 2048 is more than 4 times the current period
+		music->stop();
+		ASSERT_EQ(waitPeriod(probe, 2048), true);
+		probe->stop();
+		probe.reset();
+		music.reset();
+		voice.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+};
+
@@ -0,0 +1,505 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+#include <test-debug/debug.hpp>
+#include <audio/river/river.hpp>
+#include <audio/river/Manager.hpp>
+#include <audio/river/Interface.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+
+namespace river_test_routing {
+	/**
+	 * @brief Play a constant level on each channel (plus a ramp common to all the channels if requested).
+	 */
+	class Player {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+			etk::Vector<int16_t> m_level;
+			bool m_ramp;
+			int16_t m_value;
+		public:
+			Player(ememory::SharedPtr<audio::river::Manager> _manager,
+			       const etk::String& _streamName,
+			       const etk::Vector<audio::channel>& _map,
+			       const etk::Vector<int16_t>& _level,
+			       bool _ramp = false) :
+			  m_level(_level),
+			  m_ramp(_ramp),
+			  m_value(0) {
+				m_interface = _manager->createOutput(48000,
+				                                     _map,
+				                                     audio::format_int16,
+				                                     _streamName);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setOutputCallback([=](void* _data,
+				                                   const audio::Time& _time,
+				                                   size_t _nbChunk,
+				                                   enum audio::format _format,
+				                                   uint32_t _frequency,
+				                                   const etk::Vector<audio::channel>& _map) {
+				                                   	int16_t* data = static_cast<int16_t*>(_data);
+				                                   	for (size_t iii=0; iii<_nbChunk; ++iii) {
+				                                   		for (size_t ccc=0; ccc<_map.size(); ++ccc) {
+				                                   			data[iii*_map.size()+ccc] = m_level[ccc] + (m_ramp == true ? m_value : 0);
+				                                   		}
+				                                   		m_value++;
+				                                   	}
+				                                   });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+	};
+
+	/**
+	 * @brief Store all the frames received.
+	 */
+	class Recorder {
+		private:
+			ememory::SharedPtr<audio::river::Interface> m_interface;
+		public:
+			size_t m_nbChannel; //!< Number of channel of the stream
+			etk::Vector<int16_t> m_data; //!< Interleaved frames received
+		public:
+			Recorder(ememory::SharedPtr<audio::river::Manager> _manager,
+			         const etk::String& _streamName,
+			         const etk::Vector<audio::channel>& _map) :
+			  m_nbChannel(_map.size()) {
+				m_interface = _manager->createInput(48000,
+				                                    _map,
+				                                    audio::format_int16,
+				                                    _streamName);
+				if(m_interface == null) {
+					TEST_ERROR("null interface");
+					return;
+				}
+				m_interface->setInputCallback([=](const void* _data,
+				                                  const audio::Time& _time,
+				                                  size_t _nbChunk,
+				                                  enum audio::format _format,
+				                                  uint32_t _frequency,
+				                                  const etk::Vector<audio::channel>& _map) {
+				                                  	const int16_t* data = static_cast<const int16_t*>(_data);
+				                                  	for (size_t iii=0; iii<_nbChunk*_map.size(); ++iii) {
+				                                  		m_data.pushBack(data[iii]);
+				                                  	}
+				                                  });
+			}
+			bool isValid() const {
+				return m_interface != null;
+			}
+			void start() {
+				m_interface->start();
+			}
+			void stop() {
+				m_interface->stop();
+			}
+			/**
+			 * @brief Count the frames that are not the expected levels (the first frames are skipped: start of the flows).
+			 * @param[in] _level Expected level of each channel.
+			 * @param[in] _skip Number of frame skipped.
+			 * @param[in] _tolerance Maximum difference with the expected levels.
+			 * @return Number of wrong frame.
+			 */
+			size_t countError(const etk::Vector<int16_t>& _level, size_t _skip, int32_t _tolerance = 0) const {
+				size_t nbError = 0;
+				for (size_t iii=_skip; iii<m_data.size()/m_nbChannel; ++iii) {
+					for (size_t ccc=0; ccc<m_nbChannel; ++ccc) {
+						int32_t delta = int32_t(m_data[iii*m_nbChannel+ccc]) - int32_t(_level[ccc]);
+						if (    delta > _tolerance
+						     || delta < -_tolerance) {
+							nbError++;
+							break;
+						}
+					}
+				}
+				return nbError;
+			}
+	};
+
+	static etk::Vector<audio::channel> getMap(audio::channel _channel0,
+	                                          audio::channel _channel1 = audio::channel_unknow,
+	                                          audio::channel _channel2 = audio::channel_unknow,
+	                                          audio::channel _channel3 = audio::channel_unknow) {
+		etk::Vector<audio::channel> out;
+		out.pushBack(_channel0);
+		if (_channel1 != audio::channel_unknow) {
+			out.pushBack(_channel1);
+		}
+		if (_channel2 != audio::channel_unknow) {
+			out.pushBack(_channel2);
+		}
+		if (_channel3 != audio::channel_unknow) {
+			out.pushBack(_channel3);
+		}
+		return out;
+	}
+
+	static etk::Vector<int16_t> getLevel(int16_t _level0, int16_t _level1 = 0, int16_t _level2 = 0, int16_t _level3 = 0) {
+		etk::Vector<int16_t> out;
+		out.pushBack(_level0);
+		out.pushBack(_level1);
+		out.pushBack(_level2);
+		out.pushBack(_level3);
+		return out;
+	}
+
+	static const etk::String configurationMuxer =
+		"{\n"
+		"	speaker-1:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-2:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-3:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-center'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	microphone-1:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker-1',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	microphone-2:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker-2',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	microphone-3:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker-3',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-center'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	microphone-muxed:{\n"
+		"		io:'muxer',\n"
+		"		map-on-input-1:{\n"
+		"			io:'input',\n"
+		"			map-on:'microphone-1',\n"
+		"		},\n"
+		"		map-on-input-2:{\n"
+		"			io:'input',\n"
+		"			map-on:'microphone-2',\n"
+		"		},\n"
+		"		input-2-remap:['rear-left', 'rear-right'],\n"
+		"		map-on-input-3:{\n"
+		"			io:'input',\n"
+		"			map-on:'microphone-3',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right', 'rear-left', 'rear-right'],\n"
+		"		type:'int16',\n"
+		"		mux-demux-type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	microphone-mono:{\n"
+		"		io:'muxer',\n"
+		"		map-on-input-1:{\n"
+		"			io:'input',\n"
+		"			map-on:'microphone-1',\n"
+		"		},\n"
+		"		map-on-input-2:{\n"
+		"			io:'input',\n"
+		"			map-on:'microphone-2',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-center'],\n"
+		"		type:'int16',\n"
+		"		mux-demux-type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestRouting, muxer) {
+		audio::river::initString(configurationMuxer);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Player> player1 = ememory::makeShared<Player>(manager, "speaker-1", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(1000, 2000));
+		ememory::SharedPtr<Player> player2 = ememory::makeShared<Player>(manager, "speaker-2", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(3000, 4000));
+		ememory::SharedPtr<Player> player3 = ememory::makeShared<Player>(manager, "speaker-3", getMap(audio::channel_frontCenter), getLevel(600));
+		ASSERT_EQ(player1->isValid(), true);
+		ASSERT_EQ(player2->isValid(), true);
+		ASSERT_EQ(player3->isValid(), true);
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager,
+		                                                                      "microphone-muxed",
+		                                                                      getMap(audio::channel_frontLeft, audio::channel_frontRight, audio::channel_rearLeft, audio::channel_rearRight));
+		ememory::SharedPtr<Recorder> recorderMono = ememory::makeShared<Recorder>(manager, "microphone-mono", getMap(audio::channel_frontCenter));
+		ASSERT_EQ(recorder->isValid(), true);
+		ASSERT_EQ(recorderMono->isValid(), true);
+		player1->start();
+		player2->start();
+		player3->start();
+		recorder->start();
+		recorderMono->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		recorder->stop();
+		recorderMono->stop();
+		player1->stop();
+		player2->stop();
+		player3->stop();
+		// the 3 inputs are muxed: the channels are routed by name (input 2 is remapped on the rear), the front-center
+		// input is sent on all the channels and the channels with 2 sources are averaged
+		EXPECT_EQ(recorder->m_data.size() >= 10*256*4, true);
+		EXPECT_EQ(recorder->countError(getLevel(800, 1300, 1800, 2300), 1024), 0);
+		// mono output: mean of all the channels of the inputs
+		EXPECT_EQ(recorderMono->m_data.size() >= 10*256, true);
+		EXPECT_EQ(recorderMono->countError(getLevel(2500), 1024), 0);
+		recorder.reset();
+		recorderMono.reset();
+		player1.reset();
+		player2.reset();
+		player3.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	static const etk::String configurationMixer =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-loop:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	sfx:{\n"
+		"		io:'mixer',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"		mux-demux-type:'int16-on-int32',\n"
+		"		bus-volume:'SFX',\n"
+		"		map-on-output:{\n"
+		"			io:'output',\n"
+		"			map-on:'speaker',\n"
+		"		},\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestRouting, mixer) {
+		audio::river::initString(configurationMixer);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		// 2 streams on the bus and one stream directly on the parent
+		ememory::SharedPtr<Player> player1 = ememory::makeShared<Player>(manager, "sfx", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(1000, 2000));
+		ememory::SharedPtr<Player> player2 = ememory::makeShared<Player>(manager, "sfx", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(300, 400));
+		ememory::SharedPtr<Player> player3 = ememory::makeShared<Player>(manager, "speaker", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(10, 20));
+		ASSERT_EQ(player1->isValid(), true);
+		ASSERT_EQ(player2->isValid(), true);
+		ASSERT_EQ(player3->isValid(), true);
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager, "speaker-loop", getMap(audio::channel_frontLeft, audio::channel_frontRight));
+		ASSERT_EQ(recorder->isValid(), true);
+		recorder->start();
+		player1->start();
+		player2->start();
+		player3->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		// the streams of the bus are mixed once, then with the other streams of the parent
+		EXPECT_EQ(recorder->m_data.size() >= 10*256*2, true);
+		EXPECT_EQ(recorder->countError(getLevel(1310, 2420), 1024), 0);
+		// the volume of the bus is applied on its 2 streams only
+		recorder->m_data.clear();
+		EXPECT_EQ(manager->setVolume("SFX", -6.0f), true);
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(recorder->m_data.size() >= 10*256*2, true);
+		EXPECT_EQ(recorder->countError(getLevel(10+651, 20+1203), 1024, 2), 0);
+		// a stopped stream is removed of the bus
+		recorder->m_data.clear();
+		EXPECT_EQ(manager->setVolume("SFX", 0.0f), true);
+		player1->stop();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(recorder->countError(getLevel(310, 420), 1024), 0);
+		recorder->stop();
+		player2->stop();
+		player3->stop();
+		recorder.reset();
+		player1.reset();
+		player2.reset();
+		player3.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	static const etk::String configurationSlice =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right', 'rear-left', 'rear-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-loop:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right', 'rear-left', 'rear-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	front:{\n"
+		"		io:'slice',\n"
+		"		map-on:'speaker',\n"
+		"		channels:['front-left', 'front-right'],\n"
+		"	},\n"
+		"	rear:{\n"
+		"		io:'slice',\n"
+		"		map-on:'speaker',\n"
+		"		channels:['rear-left', 'rear-right'],\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestRouting, slice) {
+		audio::river::initString(configurationSlice);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Player> playerFront = ememory::makeShared<Player>(manager, "front", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(100, 200));
+		ememory::SharedPtr<Player> playerRear = ememory::makeShared<Player>(manager, "rear", getMap(audio::channel_rearLeft, audio::channel_rearRight), getLevel(500, 600));
+		ASSERT_EQ(playerFront->isValid(), true);
+		ASSERT_EQ(playerRear->isValid(), true);
+		ememory::SharedPtr<Recorder> recorder = ememory::makeShared<Recorder>(manager,
+		                                                                      "speaker-loop",
+		                                                                      getMap(audio::channel_frontLeft, audio::channel_frontRight, audio::channel_rearLeft, audio::channel_rearRight));
+		ASSERT_EQ(recorder->isValid(), true);
+		recorder->start();
+		playerFront->start();
+		playerRear->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		// each slice is scattered in its channels of the parent
+		EXPECT_EQ(recorder->m_data.size() >= 10*256*4, true);
+		EXPECT_EQ(recorder->countError(getLevel(100, 200, 500, 600), 1024), 0);
+		// the channels of a slice without stream are silent
+		recorder->m_data.clear();
+		playerFront->stop();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		EXPECT_EQ(recorder->m_data.size() >= 10*256*4, true);
+		EXPECT_EQ(recorder->countError(getLevel(0, 0, 500, 600), 1024), 0);
+		recorder->stop();
+		playerRear->stop();
+		recorder.reset();
+		playerFront.reset();
+		playerRear.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+
+	static const etk::String configurationLoopback =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-loop:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestRouting, loopback) {
+		audio::river::initString(configurationLoopback);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		ememory::SharedPtr<Player> player = ememory::makeShared<Player>(manager, "speaker", getMap(audio::channel_frontLeft, audio::channel_frontRight), getLevel(0, 1000), true);
+		ASSERT_EQ(player->isValid(), true);
+		// 2 applications record what is played
+		ememory::SharedPtr<Recorder> recorder1 = ememory::makeShared<Recorder>(manager, "speaker-loop", getMap(audio::channel_frontLeft, audio::channel_frontRight));
+		ememory::SharedPtr<Recorder> recorder2 = ememory::makeShared<Recorder>(manager, "speaker-loop", getMap(audio::channel_frontLeft, audio::channel_frontRight));
+		ASSERT_EQ(recorder1->isValid(), true);
+		ASSERT_EQ(recorder2->isValid(), true);
+		recorder1->start();
+		recorder2->start();
+		player->start();
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,100000000)), true);
+		recorder1->stop();
+		recorder2->stop();
+		player->stop();
+		// the input is clocked by the output: all the periods are received
+		ASSERT_EQ(recorder1->m_data.size(), 19*256*2);
+		EXPECT_EQ(recorder1->m_data.size(), recorder2->m_data.size());
+		// the ramp is continuous (no drop or repeat of block) and the 2 inputs receive the same block
+		size_t nbError = 0;
+		for (size_t iii=0; iii<recorder1->m_data.size()/2; ++iii) {
+			if (    recorder1->m_data[iii*2] != int16_t(iii)
+			     || recorder1->m_data[iii*2+1] != int16_t(1000+iii)
+			     || recorder2->m_data[iii*2] != recorder1->m_data[iii*2]
+			     || recorder2->m_data[iii*2+1] != recorder1->m_data[iii*2+1]) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		recorder1.reset();
+		recorder2.reset();
+		player.reset();
+		manager.reset();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+};
+
@@ -0,0 +1,276 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/river.hpp>
+#include <audio/river/Manager.hpp>
+#include <audio/river/Interface.hpp>
+#include <audio/river/io/ShmRing.hpp>
+#include <audio/river/io/ShmServer.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+extern "C" {
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/wait.h>
+}
+
+namespace river_test_shm {
+	static etk::String getRingName(const etk::String& _name) {
+		return "/river-test-" + _name + "-" + etk::toString(getpid());
+	}
+
+	static etk::Vector<audio::channel> getStereo() {
+		etk::Vector<audio::channel> out;
+		out.pushBack(audio::channel_frontLeft);
+		out.pushBack(audio::channel_frontRight);
+		return out;
+	}
+
+	TEST(TestShm, ringWriteRead) {
+		etk::String name = getRingName("ring");
+		audio::river::io::ShmRing ringClient;
+		ASSERT_EQ(ringClient.create(name, audio::format_int16, 48000, getStereo(), 100, true), true);
+		// the name is unique
+		audio::river::io::ShmRing ringOther;
+		EXPECT_EQ(ringOther.create(name, audio::format_int16, 48000, getStereo(), 100, true), false);
+		audio::river::io::ShmRing ringServer;
+		ASSERT_EQ(ringServer.open(name), true);
+		EXPECT_EQ(ringServer.getFormat(), audio::format_int16);
+		EXPECT_EQ(ringServer.getFrequency(), 48000);
+		EXPECT_EQ(ringServer.getMap().size(), 2);
+		EXPECT_EQ(ringServer.getCapacity(), 100);
+		EXPECT_EQ(ringServer.isOutput(), true);
+		// blocks of 70 frames in a ring of 100 frames: the copies wrap at each block
+		int16_t value = 0;
+		int16_t expected = 0;
+		uint32_t nbError = 0;
+		etk::Vector<int16_t> block;
+		block.resize(70*2, 0);
+		for (uint32_t bbb=0; bbb<50; ++bbb) {
+			for (uint32_t iii=0; iii<70; ++iii) {
+				block[iii*2] = value;
+				block[iii*2+1] = -value;
+				value++;
+			}
+			EXPECT_EQ(ringClient.write(&block[0], 70), 70);
+			EXPECT_EQ(ringServer.getFillSize(), 70);
+			// the ring is full: only 30 frames can be written
+			EXPECT_EQ(ringClient.getFreeSize(), 30);
+			EXPECT_EQ(ringServer.read(&block[0], 70), 70);
+			for (uint32_t iii=0; iii<70; ++iii) {
+				if (    block[iii*2] != expected
+				     || block[iii*2+1] != -expected) {
+					nbError++;
+				}
+				expected++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		EXPECT_EQ(ringServer.getReadPosition(), 50*70);
+		// underflow: the missing frames are silence
+		for (auto &it : block) {
+			it = 42;
+		}
+		EXPECT_EQ(ringClient.write(&block[0], 10), 10);
+		EXPECT_EQ(ringServer.read(&block[0], 20), 10);
+		EXPECT_EQ(block[10*2], 0);
+		EXPECT_EQ(block[19*2+1], 0);
+		// the time of a frame is extrapolated from the last time published
+		audio::Time time;
+		EXPECT_EQ(ringServer.getTime(0, time), false);
+		ringServer.setTime(48000, audio::Time() + audio::Duration(10, 0));
+		EXPECT_EQ(ringClient.getTime(96000, time), true);
+		EXPECT_EQ(time, audio::Time() + audio::Duration(11, 0));
+		ringServer.close();
+		ringClient.close();
+		// the creator remove the segment
+		EXPECT_EQ(ringServer.open(name), false);
+	}
+
+	TEST(TestShm, ringRejectWrongHeader) {
+		etk::String name = getRingName("header");
+		audio::river::io::ShmRing ringClient;
+		ASSERT_EQ(ringClient.create(name, audio::format_int16, 48000, getStereo(), 100, true), true);
+		int fd = shm_open(name.c_str(), O_RDWR, 0600);
+		ASSERT_NE(fd, -1);
+		void* memory = mmap(null, 64, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		ASSERT_NE(memory, MAP_FAILED);
+		// fields of the header: magic, version, format, frequency, capacity, frameSize, output, nbChannel
+		uint32_t* header = static_cast<uint32_t*>(memory);
+		audio::river::io::ShmRing ringServer;
+		const uint32_t wrongValue[][2] = {
+			{1, 2}, // version
+			{2, 0xFFFF}, // format
+			{3, 0}, // frequency
+			{4, 0}, // capacity
+			{4, 1000000}, // capacity bigger than the segment
+			{5, 3}, // frame size
+			{7, 0}, // number of channel
+			{7, 1000}, // number of channel
+		};
+		for (size_t iii=0; iii<sizeof(wrongValue)/sizeof(wrongValue[0]); ++iii) {
+			uint32_t save = header[wrongValue[iii][0]];
+			header[wrongValue[iii][0]] = wrongValue[iii][1];
+			if (ringServer.open(name) == true) {
+				TEST_ERROR("accept a wrong header: field " << wrongValue[iii][0] << " = " << wrongValue[iii][1]);
+				EXPECT_EQ(false, true);
+				ringServer.close();
+			}
+			header[wrongValue[iii][0]] = save;
+		}
+		EXPECT_EQ(ringServer.open(name), true);
+		ringServer.close();
+		// a segment smaller than the header
+		EXPECT_EQ(ftruncate(fd, 16), 0);
+		EXPECT_EQ(ringServer.open(name), false);
+		munmap(memory, 64);
+		::close(fd);
+		ringClient.close();
+	}
+
+	TEST(TestShm, ringTwoProcess) {
+		// the child produce a ramp, the parent check it: the 2 sides wait with the futex
+		etk::String name = getRingName("process");
+		const uint32_t nbFrame = 100000;
+		audio::river::io::ShmRing ring;
+		ASSERT_EQ(ring.create(name, audio::format_int32, 48000, getStereo(), 1024, true), true);
+		pid_t pid = fork();
+		ASSERT_NE(pid, -1);
+		if (pid == 0) {
+			audio::river::io::ShmRing ringChild;
+			if (ringChild.open(name) == false) {
+				_exit(1);
+			}
+			int32_t block[100*2];
+			uint32_t position = 0;
+			while (position < nbFrame) {
+				if (ringChild.waitWrite(100, 2000) == false) {
+					_exit(2);
+				}
+				for (uint32_t iii=0; iii<100; ++iii) {
+					block[iii*2] = int32_t(position+iii);
+					block[iii*2+1] = -int32_t(position+iii);
+				}
+				position += ringChild.write(block, 100);
+			}
+			_exit(0);
+		}
+		int32_t block[77*2];
+		uint32_t position = 0;
+		uint32_t nbError = 0;
+		while (position < nbFrame) {
+			uint32_t nbRead = etk::min(uint32_t(77), nbFrame-position);
+			if (ring.waitRead(nbRead, 2000) == false) {
+				TEST_ERROR("timeout at the frame " << position);
+				break;
+			}
+			EXPECT_EQ(ring.read(block, nbRead), nbRead);
+			for (uint32_t iii=0; iii<nbRead; ++iii) {
+				if (    block[iii*2] != int32_t(position+iii)
+				     || block[iii*2+1] != -int32_t(position+iii)) {
+					nbError++;
+				}
+			}
+			position += nbRead;
+		}
+		int status = -1;
+		EXPECT_EQ(waitpid(pid, &status, 0), pid);
+		EXPECT_EQ(WIFEXITED(status), true);
+		EXPECT_EQ(WEXITSTATUS(status), 0);
+		EXPECT_EQ(position, nbFrame);
+		EXPECT_EQ(nbError, 0);
+		ring.close();
+	}
+
+	static const etk::String configurationServer =
+		"{\n"
+		"	speaker:{\n"
+		"		io:'virtual-output',\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"	speaker-loop:{\n"
+		"		io:'virtual-input',\n"
+		"		map-on:{\n"
+		"			loopback:'speaker',\n"
+		"		},\n"
+		"		frequency:48000,\n"
+		"		channel-map:['front-left', 'front-right'],\n"
+		"		type:'int16',\n"
+		"		nb-chunk:256,\n"
+		"	},\n"
+		"}\n";
+
+	TEST(TestShm, server) {
+		etk::String serverName = "river-test-" + etk::toString(getpid());
+		audio::river::initString(configurationServer);
+		EXPECT_EQ(audio::river::setOfflineMode(true), true);
+		ASSERT_EQ(audio::river::startServer(serverName), true);
+		ememory::SharedPtr<audio::river::Manager> manager;
+		manager = audio::river::Manager::create("testApplication");
+		etk::Vector<int16_t> record;
+		ememory::SharedPtr<audio::river::Interface> recorder;
+		recorder = manager->createInput(48000, getStereo(), audio::format_int16, "speaker-loop");
+		ASSERT_NE(recorder, null);
+		recorder->setInputCallback([&](const void* _data,
+		                               const audio::Time& _time,
+		                               size_t _nbChunk,
+		                               enum audio::format _format,
+		                               uint32_t _frequency,
+		                               const etk::Vector<audio::channel>& _map) {
+		                               	const int16_t* data = static_cast<const int16_t*>(_data);
+		                               	for (size_t iii=0; iii<_nbChunk*_map.size(); ++iii) {
+		                               		record.pushBack(data[iii]);
+		                               	}
+		                               });
+		recorder->start();
+		// a client ring connected on the node of the server (the client is in the same process for the test)
+		etk::String ringName = getRingName("client");
+		audio::river::io::ShmRing ring;
+		ASSERT_EQ(ring.create(ringName, audio::format_int16, 48000, getStereo(), 4096, true), true);
+		int32_t serverPid = 0;
+		EXPECT_EQ(audio::river::io::ShmServer::connect(serverName, "unknown-node", ringName, serverPid), -1);
+		int32_t id = audio::river::io::ShmServer::connect(serverName, "speaker", ringName, serverPid);
+		ASSERT_NE(id, -1);
+		EXPECT_EQ(serverPid, getpid());
+		etk::Vector<int16_t> block;
+		block.resize(4096*2, 0);
+		for (uint32_t iii=0; iii<4096; ++iii) {
+			block[iii*2] = int16_t(iii);
+			block[iii*2+1] = -int16_t(iii);
+		}
+		EXPECT_EQ(ring.write(&block[0], 4096), 4096);
+		// 10 periods of the node are read in the ring
+		EXPECT_EQ(audio::river::renderOffline(audio::Duration(0,50000000)), true);
+		EXPECT_EQ(ring.getReadPosition(), 10*256);
+		ASSERT_EQ(record.size(), 10*256*2);
+		uint32_t nbError = 0;
+		for (uint32_t iii=0; iii<10*256; ++iii) {
+			if (    record[iii*2] != int16_t(iii)
+			     || record[iii*2+1] != -int16_t(iii)) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		// the server publish the time of the frames of the client
+		audio::Time time;
+		EXPECT_EQ(ring.getTime(ring.getReadPosition(), time), true);
+		audio::river::io::ShmServer::disconnect(serverName, id);
+		recorder->stop();
+		recorder.reset();
+		manager.reset();
+		// the interfaces of the clients are released by the server
+		audio::river::stopServer();
+		ring.close();
+		EXPECT_EQ(audio::river::setOfflineMode(false), true);
+		audio::river::unInit();
+	}
+};
+
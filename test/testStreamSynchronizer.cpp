@@ -0,0 +1,209 @@
+/** @file
+ * @author Edouard DUPIN 
+ * @copyright 2015, Edouard DUPIN, all right reserved
+ * @license MPL v2.0 (see license file)
+ */
+
+#include <test-debug/debug.hpp>
+#include <audio/river/io/StreamSynchronizer.hpp>
+#include <etest/etest.hpp>
+#include <etk/etk.hpp>
+
+namespace river_test_stream_synchronizer {
+	static const uint32_t frequency = 48000;
+
+	static audio::Time getTime(int64_t _frame) {
+		int64_t time = _frame*1000000000LL/int64_t(frequency);
+		return audio::Time() + audio::Duration(time/1000000000LL, time%1000000000LL);
+	}
+
+	/**
+	 * @brief Check a time of the synchronizer (the times are rounded on the nanosecond at each block).
+	 */
+	static bool isTimeOf(const audio::Time& _time, int64_t _frame) {
+		audio::Time expected = getTime(_frame);
+		if (_time < expected) {
+			return expected - _time < audio::Duration(0, 1000);
+		}
+		return _time - expected < audio::Duration(0, 1000);
+	}
+
+	/**
+	 * @brief Write a block of a source: each frame contain its position in the flow (all the channels).
+	 */
+	static void writeBlock(audio::river::io::StreamSynchronizer& _synchronizer, size_t _id, uint32_t _nbChannel, int64_t _start, uint32_t _nbFrame) {
+		etk::Vector<int32_t> block;
+		block.resize(_nbFrame*_nbChannel, 0);
+		for (uint32_t iii=0; iii<_nbFrame; ++iii) {
+			for (uint32_t ccc=0; ccc<_nbChannel; ++ccc) {
+				block[iii*_nbChannel+ccc] = int32_t(_start+iii);
+			}
+		}
+		_synchronizer.write(_id, &block[0], _nbFrame, getTime(_start));
+	}
+
+	TEST(TestStreamSynchronizer, ringMirror) {
+		// ring of 128 frames: the blocks of 50 frames and the chunks of 64 frames wrap at different places
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, 64, false);
+		EXPECT_EQ(synchronizer.addSource(audio::format_int32, 2, audio::Duration(0, 1000000)), 0);
+		int64_t position = 0;
+		int64_t expected = 0;
+		uint32_t nbError = 0;
+		uint32_t nbChunk = 0;
+		for (uint32_t bbb=0; bbb<100; ++bbb) {
+			writeBlock(synchronizer, 0, 2, position, 50);
+			position += 50;
+			audio::Time time;
+			while (synchronizer.acquire(time) == true) {
+				if (isTimeOf(time, expected) == false) {
+					TEST_ERROR("wrong time " << time << " != " << getTime(expected));
+					nbError++;
+				}
+				// the chunk is always contiguous (the start of the ring is mirrored after its end)
+				const int32_t* data = static_cast<const int32_t*>(synchronizer.getData(0));
+				for (uint32_t iii=0; iii<64; ++iii) {
+					if (    data[iii*2] != int32_t(expected+iii)
+					     || data[iii*2+1] != int32_t(expected+iii)) {
+						nbError++;
+					}
+				}
+				synchronizer.release();
+				expected += 64;
+				nbChunk++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		// one chunk stay in the ring (the next chunk need more than 64 frames)
+		EXPECT_EQ(nbChunk, (100*50-1)/64);
+	}
+
+	TEST(TestStreamSynchronizer, alignSources) {
+		// 3 sources: the second start 10 ms before the reference, the third 5 ms after
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, 256, false);
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 100000000));
+		synchronizer.addSource(audio::format_int32, 2, audio::Duration(0, 100000000));
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 100000000));
+		EXPECT_EQ(synchronizer.getNbSource(), 3);
+		int64_t position = 4800;
+		uint32_t nbError = 0;
+		uint32_t nbChunk = 0;
+		int64_t first = -1;
+		writeBlock(synchronizer, 1, 2, position-480, 480);
+		for (uint32_t bbb=0; bbb<50; ++bbb) {
+			writeBlock(synchronizer, 0, 1, position, 160);
+			writeBlock(synchronizer, 1, 2, position, 160);
+			writeBlock(synchronizer, 2, 1, position+240, 160);
+			position += 160;
+			audio::Time time;
+			while (synchronizer.acquire(time) == true) {
+				const int32_t* data0 = static_cast<const int32_t*>(synchronizer.getData(0));
+				const int32_t* data1 = static_cast<const int32_t*>(synchronizer.getData(1));
+				const int32_t* data2 = static_cast<const int32_t*>(synchronizer.getData(2));
+				if (first < 0) {
+					first = data0[0];
+				}
+				if (isTimeOf(time, data0[0]) == false) {
+					nbError++;
+				}
+				for (uint32_t iii=0; iii<256; ++iii) {
+					if (    data1[iii*2] != data0[iii]
+					     || data1[iii*2+1] != data0[iii]
+					     || data2[iii] != data0[iii]) {
+						nbError++;
+					}
+				}
+				synchronizer.release();
+				nbChunk++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		// the older frames of the reference are dropped to start with the third source
+		EXPECT_EQ(first, 4800+240);
+		EXPECT_EQ(nbChunk, (50*160-240-1)/256);
+	}
+
+	TEST(TestStreamSynchronizer, offset) {
+		// the second source is recorded 5 ms after the reference (delay of the device)
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, 128, false);
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 100000000));
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 100000000));
+		synchronizer.setOffset(1, audio::Duration(0, 5000000));
+		int64_t position = 0;
+		for (uint32_t bbb=0; bbb<20; ++bbb) {
+			writeBlock(synchronizer, 0, 1, position, 128);
+			writeBlock(synchronizer, 1, 1, position, 128);
+			position += 128;
+		}
+		uint32_t nbError = 0;
+		uint32_t nbChunk = 0;
+		audio::Time time;
+		while (synchronizer.acquire(time) == true) {
+			const int32_t* data0 = static_cast<const int32_t*>(synchronizer.getData(0));
+			const int32_t* data1 = static_cast<const int32_t*>(synchronizer.getData(1));
+			for (uint32_t iii=0; iii<128; ++iii) {
+				if (data1[iii] != data0[iii] - 240) {
+					nbError++;
+				}
+			}
+			synchronizer.release();
+			nbChunk++;
+		}
+		EXPECT_EQ(nbError, 0);
+		EXPECT_NE(nbChunk, 0);
+	}
+
+	TEST(TestStreamSynchronizer, clearIsDeferred) {
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, 64, false);
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 100000000));
+		writeBlock(synchronizer, 0, 1, 0, 640);
+		audio::Time time;
+		ASSERT_EQ(synchronizer.acquire(time), true);
+		const int32_t* data = static_cast<const int32_t*>(synchronizer.getData(0));
+		// a xrun of a source during the process: the chunk in use stay valid
+		synchronizer.clear();
+		writeBlock(synchronizer, 0, 1, 640, 64);
+		uint32_t nbError = 0;
+		for (uint32_t iii=0; iii<64; ++iii) {
+			if (data[iii] != int32_t(iii)) {
+				nbError++;
+			}
+		}
+		EXPECT_EQ(nbError, 0);
+		// a new acquire is refused until the release
+		EXPECT_EQ(synchronizer.acquire(time), false);
+		synchronizer.release();
+		// the rings are empty after the clear
+		EXPECT_EQ(synchronizer.acquire(time), false);
+		writeBlock(synchronizer, 0, 1, 1000, 128);
+		ASSERT_EQ(synchronizer.acquire(time), true);
+		data = static_cast<const int32_t*>(synchronizer.getData(0));
+		EXPECT_EQ(data[0], 1000);
+		EXPECT_EQ(isTimeOf(time, 1000), true);
+		synchronizer.release();
+	}
+
+	TEST(TestStreamSynchronizer, dropNewFrames) {
+		// ring of 144 frames
+		audio::river::io::StreamSynchronizer synchronizer;
+		synchronizer.init(frequency, 64, false);
+		synchronizer.addSource(audio::format_int32, 1, audio::Duration(0, 3000000));
+		writeBlock(synchronizer, 0, 1, 0, 100);
+		audio::Time time;
+		ASSERT_EQ(synchronizer.acquire(time), true);
+		// the chunk in use can not be dropped: only 44 of the new frames are stored
+		writeBlock(synchronizer, 0, 1, 100, 64);
+		synchronizer.release();
+		ASSERT_EQ(synchronizer.acquire(time), true);
+		const int32_t* data = static_cast<const int32_t*>(synchronizer.getData(0));
+		EXPECT_EQ(data[0], 64);
+		EXPECT_EQ(data[63], 127);
+		// the time of the ring follow the frames stored, not the frames received
+		EXPECT_EQ(isTimeOf(time, 64), true);
+		synchronizer.release();
+	}
+};
+